@@ -47,6 +47,7 @@ public class ChaosClothBrokenEXT : ModuleRules
 				"RHI",                            // 渲染硬件接口
 				"PhysicsCore",                    // 物理核心
 				"Chaos",                          // Chaos物理系统
+				"ChaosCloth",                     // Chaos布料，用于受损后放松布料的模拟交互器
 				"GeometryFramework",              // 几何框架
 				"MeshConversion",                 // 网格转换
 				"MeshDescription",                // 网格描述
@@ -56,6 +57,12 @@ public class ChaosClothBrokenEXT : ModuleRules
 			);
 
 
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache"); // 派生数据缓存，用于缓存断裂区域表
+		}
+
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
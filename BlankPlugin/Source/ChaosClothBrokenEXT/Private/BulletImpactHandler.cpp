@@ -1,6 +1,9 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "BulletImpactHandler.h"
+#include "BulletProfile.h"
+#include "ClothBreakableSettings.h"
+#include "ClothBreakConsoleVariables.h"
 #include "Components/PrimitiveComponent.h"
 #include "PhysicsEngine/BodyInstance.h"
 #include "GameFramework/ProjectileMovementComponent.h"
@@ -51,36 +54,137 @@ bool UBulletImpactHandler::ProcessBulletImpact(const FHitResult& HitResult, floa
     OutImpactForce = CalculateImpactForce(HitResult);
 
     // 调试可视化
-    if (bEnableDebugVisualization && HitComponent->GetWorld())
+    if (bEnableDebugVisualization)
     {
-        DrawDebugSphere(
-            HitComponent->GetWorld(),
-            OutImpactLocation,
-            OutBreakRadius,
-            16,
-            FColor::Red,
-            false,
-            DebugDrawDuration,
-            0,
-            1.0f
-        );
-
-        DrawDebugString(
-            HitComponent->GetWorld(),
-            OutImpactLocation + FVector(0, 0, 10.0f),
-            FString::Printf(TEXT("Force: %.1f"), OutImpactForce),
-            nullptr,
-            FColor::White,
-            DebugDrawDuration
-        );
+        DrawImpactDebug(HitComponent->GetWorld(), OutImpactLocation, OutBreakRadius, OutImpactForce);
     }
 
-    UE_LOG(LogTemp, Log, TEXT("Bullet impact processed: Location=%s, Radius=%f, Force=%f"),
+    UE_LOG(LogTemp, Verbose, TEXT("Bullet impact processed: Location=%s, Radius=%f, Force=%f"),
         *OutImpactLocation.ToString(), OutBreakRadius, OutImpactForce);
 
     return true;
 }
 
+bool UBulletImpactHandler::ResolveBulletImpact(const FHitResult& HitResult, const FClothBreakableRuntimeSettings& Settings,
+    FBulletImpactParams& OutParams)
+{
+    AActor* BulletActor = HitResult.GetActor();
+    const UBulletProfile* Profile = BulletActor ? FindBulletProfile(BulletActor->GetClass(), Settings.Source) : nullptr;
+    const float RadiusMultiplier = Settings.RadiusMultiplier;
+
+    // 没有子弹配置时回退为探测子弹的物理状态
+    if (!Profile)
+    {
+        OutParams.Profile = nullptr;
+        OutParams.ImpactEnergy = 0.0f;
+        OutParams.FragmentMultiplier = 1.0f;
+        OutParams.Normal = HitResult.ImpactNormal;
+        OutParams.BoneName = HitResult.BoneName;
+        return ProcessBulletImpact(HitResult, RadiusMultiplier, OutParams.Location, OutParams.BreakRadius, OutParams.ImpactForce);
+    }
+
+    if (!HitResult.GetComponent())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Invalid hit result"));
+        return false;
+    }
+
+    // 子弹配置已缓存，动能由命中速度计算，半径和碰撞力只需一次曲线求值
+    OutParams.Profile = Profile;
+    OutParams.Location = HitResult.ImpactPoint;
+    OutParams.Normal = HitResult.ImpactNormal;
+    OutParams.BoneName = HitResult.BoneName;
+    OutParams.ImpactEnergy = Profile->EvaluateImpactEnergy(GetBulletVelocity(BulletActor).Size());
+    OutParams.BreakRadius = Profile->EvaluateBreakRadius(OutParams.ImpactEnergy, RadiusMultiplier);
+    OutParams.ImpactForce = Profile->EvaluateImpactForce(OutParams.ImpactEnergy);
+    OutParams.FragmentMultiplier = Profile->FragmentMultiplier;
+
+    if (bEnableDebugVisualization)
+    {
+        DrawImpactDebug(HitResult.GetComponent()->GetWorld(), OutParams.Location, OutParams.BreakRadius, OutParams.ImpactForce);
+    }
+
+    return true;
+}
+
+const UBulletProfile* UBulletImpactHandler::FindBulletProfile(UClass* ProjectileClass, const UClothBreakableSettings* Settings)
+{
+    if (!ProjectileClass || !Settings)
+    {
+        return nullptr;
+    }
+
+    // 换了设置资产或资产被修改后之前的解析结果不再有效
+    if (ResolvedProfilesSettings.Get() != Settings || ResolvedProfilesRevision != Settings->GetRevision())
+    {
+        ResolvedProfiles.Reset();
+        ResolvedProfilesSettings = Settings;
+        ResolvedProfilesRevision = Settings->GetRevision();
+    }
+
+    if (const TWeakObjectPtr<const UBulletProfile>* CachedProfile = ResolvedProfiles.Find(ProjectileClass))
+    {
+        return CachedProfile->Get();
+    }
+
+    // 按继承关系选择最接近的配置
+    const UBulletProfile* BestProfile = Settings->DefaultBulletProfile;
+    int32 BestDepth = -1;
+    for (const TPair<TSoftClassPtr<AActor>, UBulletProfile*>& Entry : Settings->BulletProfiles)
+    {
+        UClass* ProfileClass = Entry.Key.Get();
+        if (!ProfileClass || !Entry.Value || !ProjectileClass->IsChildOf(ProfileClass))
+        {
+            continue;
+        }
+
+        int32 Depth = 0;
+        for (UClass* SuperClass = ProfileClass->GetSuperClass(); SuperClass; SuperClass = SuperClass->GetSuperClass())
+        {
+            ++Depth;
+        }
+
+        if (Depth > BestDepth)
+        {
+            BestDepth = Depth;
+            BestProfile = Entry.Value;
+        }
+    }
+
+    // 没有配置的子弹类同样缓存，避免重复查找
+    ResolvedProfiles.Add(ProjectileClass, BestProfile);
+    return BestProfile;
+}
+
+void UBulletImpactHandler::DrawImpactDebug(UWorld* World, const FVector& ImpactLocation, float BreakRadius, float ImpactForce) const
+{
+    if (!World)
+    {
+        return;
+    }
+
+    DrawDebugSphere(
+        World,
+        ImpactLocation,
+        BreakRadius,
+        ClothBreakCVars::GetDebugSphereSegments(),
+        FColor::Red,
+        false,
+        DebugDrawDuration,
+        0,
+        1.0f
+    );
+
+    DrawDebugString(
+        World,
+        ImpactLocation + FVector(0, 0, 10.0f),
+        FString::Printf(TEXT("Force: %.1f"), ImpactForce),
+        nullptr,
+        FColor::White,
+        DebugDrawDuration
+    );
+}
+
 float UBulletImpactHandler::CalculateBreakRadius(UPrimitiveComponent* HitComponent,
     UPrimitiveComponent* BulletComponent, float RadiusMultiplier)
 {
@@ -113,14 +217,14 @@ float UBulletImpactHandler::CalculateBreakRadius(UPrimitiveComponent* HitCompone
     // 如果无法获取大小，使用默认值
     if (BulletSize <= 0.0f)
     {
-        BulletSize = 5.0f;
+        BulletSize = UBulletProfile::DefaultBulletSize;
     }
 
     // 应用半径倍率
     float BreakRadius = BulletSize * RadiusMultiplier;
 
-    // 确保半径在合理范围内
-    BreakRadius = FMath::Clamp(BreakRadius, 1.0f, 100.0f);
+    // 确保半径在合理范围内，上限由画质档位决定
+    BreakRadius = FMath::Clamp(BreakRadius, 1.0f, ClothBreakCVars::GetMaxBreakRadius());
 
     return BreakRadius;
 }
@@ -180,6 +284,37 @@ float UBulletImpactHandler::CalculateImpactForce(const FHitResult& HitResult)
     return ImpactForce;
 }
 
+FVector UBulletImpactHandler::GetBulletVelocity(const AActor* BulletActor)
+{
+    if (!BulletActor)
+    {
+        return FVector::ZeroVector;
+    }
+
+    // 优先使用ProjectileMovementComponent的速度
+    if (const UProjectileMovementComponent* ProjectileMovement = BulletActor->FindComponentByClass<UProjectileMovementComponent>())
+    {
+        return ProjectileMovement->Velocity;
+    }
+    if (const UPrimitiveComponent* BulletComponent = Cast<UPrimitiveComponent>(BulletActor->GetRootComponent()))
+    {
+        return BulletComponent->GetPhysicsLinearVelocity();
+    }
+    return FVector::ZeroVector;
+}
+
+FVector UBulletImpactHandler::CalculateBulletDirection(const FHitResult& HitResult)
+{
+    const FVector BulletVelocity = GetBulletVelocity(HitResult.GetActor());
+    if (!BulletVelocity.IsNearlyZero())
+    {
+        return BulletVelocity.GetSafeNormal();
+    }
+
+    // 无法获取速度时沿碰撞法线反方向
+    return -HitResult.ImpactNormal.GetSafeNormal();
+}
+
 bool UBulletImpactHandler::SimulateBulletImpact(UPrimitiveComponent* TargetComponent,
     const FVector& ImpactLocation, float BulletSize, float ImpactForce,
     float RadiusMultiplier, float& OutBreakRadius,
@@ -194,8 +329,8 @@ bool UBulletImpactHandler::SimulateBulletImpact(UPrimitiveComponent* TargetCompo
     // 计算断裂半径
     OutBreakRadius = BulletSize * RadiusMultiplier;
 
-    // 确保半径在合理范围内
-    OutBreakRadius = FMath::Clamp(OutBreakRadius, 1.0f, 100.0f);
+    // 确保半径在合理范围内，上限由画质档位决定
+    OutBreakRadius = FMath::Clamp(OutBreakRadius, 1.0f, ClothBreakCVars::GetMaxBreakRadius());
 
     // 调试可视化
     if (bDebugVisualization && TargetComponent->GetWorld())
@@ -204,7 +339,7 @@ bool UBulletImpactHandler::SimulateBulletImpact(UPrimitiveComponent* TargetCompo
             TargetComponent->GetWorld(),
             ImpactLocation,
             OutBreakRadius,
-            16,
+            ClothBreakCVars::GetDebugSphereSegments(),
             FColor::Green,
             false,
             DebugDuration,
@@ -222,7 +357,7 @@ bool UBulletImpactHandler::SimulateBulletImpact(UPrimitiveComponent* TargetCompo
         );
     }
 
-    UE_LOG(LogTemp, Log, TEXT("Simulated bullet impact: Location=%s, Radius=%f, Force=%f"),
+    UE_LOG(LogTemp, Verbose, TEXT("Simulated bullet impact: Location=%s, Radius=%f, Force=%f"),
         *ImpactLocation.ToString(), OutBreakRadius, ImpactForce);
 
     return true;
@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BulletProfile.h"
+#include "ClothBreakConsoleVariables.h"
+
+UBulletProfile::UBulletProfile()
+{
+	// 默认值对应常见的步枪弹
+	Caliber = 0.762f;
+	Mass = 0.0095f;
+	MuzzleEnergy = 3500.0f;
+	ImpactForceScale = 0.5f;
+	FragmentMultiplier = 1.0f;
+}
+
+float UBulletProfile::EvaluateImpactEnergy(float ImpactSpeed) const
+{
+	if (ImpactSpeed <= 0.0f)
+	{
+		return MuzzleEnergy;
+	}
+
+	// 速度从厘米/秒换算为米/秒
+	const float SpeedMetersPerSecond = ImpactSpeed * 0.01f;
+	return 0.5f * Mass * SpeedMetersPerSecond * SpeedMetersPerSecond;
+}
+
+float UBulletProfile::EvaluateBreakRadius(float ImpactEnergy, float RadiusMultiplier) const
+{
+	const FRichCurve* Curve = RadiusCurve.GetRichCurveConst();
+	const float BreakRadius = (Curve && Curve->GetNumKeys() > 0)
+		? Curve->Eval(ImpactEnergy)
+		: DefaultBulletSize * RadiusMultiplier;
+
+	// 破洞不小于弹头，上限由画质档位决定
+	return FMath::Clamp(FMath::Max(BreakRadius, Caliber * 0.5f), 1.0f, ClothBreakCVars::GetMaxBreakRadius());
+}
+
+float UBulletProfile::EvaluateImpactForce(float ImpactEnergy) const
+{
+	const float ImpactForce = FMath::Max(ImpactEnergy, 0.0f) * ImpactForceScale;
+
+	// 确保力在合理范围内
+	return FMath::Clamp(ImpactForce, 100.0f, 10000.0f);
+}
@@ -3,19 +3,42 @@
 #include "ChaosClothBrokenEXT.h"
 #include "ClothBreakableComponent.h"
 #include "ClothFragmentGenerator.h"
+#include "ClothBreakFrameArena.h"
 #include "Modules/ModuleManager.h"
 
+#if WITH_EDITOR
+#include "ClothHoleMask.h"
+#include "Engine/SkeletalMesh.h"
+#include "UObject/UObjectGlobals.h"
+#endif
+
 #define LOCTEXT_NAMESPACE "FChaosClothBrokenEXTModule"
 
 void FChaosClothBrokenEXTModule::StartupModule()
 {
 	// 模块加载时的初始化代码
+	FClothBreakFrameArena::Startup();
+	FClothBreakAllocationCounter::Startup();
+#if WITH_EDITOR
+	// 网格体修改或重新导入后，已登记的表面查找表和失败记录作废
+	MeshChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([](UObject* Object, FPropertyChangedEvent&)
+	{
+		if (const USkeletalMesh* Mesh = Cast<USkeletalMesh>(Object))
+		{
+			FClothSurfaceUVTable::Invalidate(Mesh);
+		}
+	});
+#endif
 	UE_LOG(LogTemp, Log, TEXT("ChaosClothBrokenEXT module has been loaded"));
 }
 
 void FChaosClothBrokenEXTModule::ShutdownModule()
 {
 	// 模块卸载时的清理代码
+	FClothBreakFrameArena::Shutdown();
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(MeshChangedHandle);
+#endif
 	UE_LOG(LogTemp, Log, TEXT("ChaosClothBrokenEXT module has been unloaded"));
 }
 
@@ -0,0 +1,227 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakConsoleVariables.h"
+#include "ClothBreakableSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "Scalability.h"
+
+namespace ClothBreakCVars
+{
+	/** 影响运行时设置的变量修改后，通知所有组件重建运行时设置 */
+	static void HandleRuntimeSettingsVariableChanged(IConsoleVariable* Variable)
+	{
+		UClothBreakableSettings::OnSettingsChanged.Broadcast(nullptr);
+	}
+
+	// 低、中、高、极高四档，极高档与引入档位之前的行为一致
+	// 不模拟物理的档位不生成碎片，否则碎片会静止悬停在命中点
+	static const FClothBreakQualityTier QualityTiers[NumQualityLevels] =
+	{
+		// MaxLiveFragments, MaxFragmentsPerBreak, MaxBreakRadius, FrameBudgetMs, DebugSphereSegments, bEnableFragmentPhysics, bAllowAdvancedStrategies, bHoleMaskOnly
+		{ 0, 0, 40.0f, 0.5f, 8, false, false, true },
+		{ 0, 0, 60.0f, 1.0f, 12, false, false, false },
+		{ 30, 10, 80.0f, 1.5f, 16, true, true, false },
+		{ 50, 20, 100.0f, 2.0f, 16, true, true, false },
+	};
+
+	static TAutoConsoleVariable<int32> CVarQuality(
+		TEXT("ClothBreak.Quality"),
+		-1,
+		TEXT("Cloth breaking quality tier: 0 low (hole mask only), 1 medium (holes and tearing, no fragments), 2 high, 3 epic. ")
+		TEXT("Negative follows sg.EffectsQuality. Can be set per scalability level or device profile."),
+		ECVF_Scalability);
+
+	static TAutoConsoleVariable<int32> CVarMaxFragments(
+		TEXT("ClothBreak.MaxFragments"),
+		-1,
+		TEXT("Maximum number of live fragments per component. The oldest fragments are destroyed beyond this. Negative uses the quality tier."),
+		ECVF_Scalability);
+
+	static TAutoConsoleVariable<float> CVarMaxBreakRadius(
+		TEXT("ClothBreak.MaxBreakRadius"),
+		-1.0f,
+		TEXT("Maximum break radius of a single impact. Negative uses the quality tier."),
+		ECVF_Scalability);
+
+	static TAutoConsoleVariable<float> CVarFrameBudgetMs(
+		TEXT("ClothBreak.FrameBudgetMs"),
+		-1.0f,
+		TEXT("Per-frame time budget of the cloth breaking subsystem in ms. 0 means unlimited, negative uses the budget set on the subsystem, or the quality tier's."),
+		ECVF_Scalability);
+
+	/** 最近一次应用到运行时设置的档位 */
+	static int32 AppliedQualityLevel = INDEX_NONE;
+
+	/**
+	 * 画质分组或设备配置切换后，档位变化时通知所有组件重建运行时设置
+	 * 控制台变量的回调只在ClothBreak.Quality本身变化时触发，跟随sg.EffectsQuality时需要在这里检查
+	 */
+	static void HandleConsoleVariablesChanged()
+	{
+		const int32 QualityLevel = GetQualityLevel();
+		if (AppliedQualityLevel != INDEX_NONE && QualityLevel != AppliedQualityLevel)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Cloth breaking quality changed from %d to %d"), AppliedQualityLevel, QualityLevel);
+			UClothBreakableSettings::OnSettingsChanged.Broadcast(nullptr);
+		}
+		AppliedQualityLevel = QualityLevel;
+	}
+
+	static FAutoConsoleVariableSink QualitySink(FConsoleCommandDelegate::CreateStatic(&HandleConsoleVariablesChanged));
+
+	static TAutoConsoleVariable<bool> CVarAutoPrewarm(
+		TEXT("ClothBreak.AutoPrewarm"),
+		true,
+		TEXT("Prewarm fragment meshes, materials, surface tables and the fragment spawn path when a breakable component initializes."),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarFullBreakCameraDistance(
+		TEXT("ClothBreak.FullBreakCameraDistance"),
+		-1.0f,
+		TEXT("Overrides the camera distance within which hits spawn fragments when the hole mask is enabled. Negative uses the settings."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarMaxFullBreakLOD(
+		TEXT("ClothBreak.MaxFullBreakLOD"),
+		-1,
+		TEXT("Overrides the highest rendered LOD that still gets fragments and tearing. Negative uses the settings."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarSphereDebris(
+		TEXT("ClothBreak.Fragments.SphereDebris"),
+		true,
+		TEXT("Enable the SphereDebris fragment strategy."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarBakedCells(
+		TEXT("ClothBreak.Fragments.BakedCells"),
+		true,
+		TEXT("Enable the spiral cell fragment strategy (BakedCells), laid out at runtime on a golden-angle spiral."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarLocalVoronoi(
+		TEXT("ClothBreak.Fragments.LocalVoronoi"),
+		true,
+		TEXT("Enable the LocalVoronoi fragment strategy."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarStripTear(
+		TEXT("ClothBreak.Fragments.StripTear"),
+		true,
+		TEXT("Enable the StripTear fragment strategy."),
+		FConsoleVariableDelegate::CreateStatic(&HandleRuntimeSettingsVariableChanged),
+		ECVF_Default);
+}
+
+int32 ClothBreakCVars::GetQualityLevel()
+{
+	const int32 QualityLevel = CVarQuality.GetValueOnGameThread();
+	if (QualityLevel >= 0)
+	{
+		return FMath::Min(QualityLevel, NumQualityLevels - 1);
+	}
+
+	// 引擎画质分组的电影级（4）按极高档处理
+	return FMath::Clamp(Scalability::GetQualityLevels().EffectsQuality, 0, NumQualityLevels - 1);
+}
+
+const FClothBreakQualityTier& ClothBreakCVars::GetQualityTier()
+{
+	return QualityTiers[GetQualityLevel()];
+}
+
+float ClothBreakCVars::GetMaxBreakRadius()
+{
+	const float MaxBreakRadius = CVarMaxBreakRadius.GetValueOnGameThread();
+	return MaxBreakRadius >= 0.0f ? FMath::Max(MaxBreakRadius, 1.0f) : GetQualityTier().MaxBreakRadius;
+}
+
+int32 ClothBreakCVars::GetDebugSphereSegments()
+{
+	return GetQualityTier().DebugSphereSegments;
+}
+
+int32 ClothBreakCVars::GetMaxLiveFragments()
+{
+	const int32 MaxFragments = CVarMaxFragments.GetValueOnGameThread();
+	return MaxFragments >= 0 ? MaxFragments : GetQualityTier().MaxLiveFragments;
+}
+
+float ClothBreakCVars::GetFrameBudgetMs(float ExplicitBudgetMs)
+{
+	// 控制台变量用于调试，优先于代码设置的预算；档位只作为默认值
+	const float BudgetMs = CVarFrameBudgetMs.GetValueOnGameThread();
+	if (BudgetMs >= 0.0f)
+	{
+		return BudgetMs;
+	}
+
+	return ExplicitBudgetMs >= 0.0f ? ExplicitBudgetMs : GetQualityTier().FrameBudgetMs;
+}
+
+bool ClothBreakCVars::IsAutoPrewarmEnabled()
+{
+	return CVarAutoPrewarm.GetValueOnGameThread();
+}
+
+bool ClothBreakCVars::IsFragmentStrategyEnabled(EClothFragmentStrategy Strategy)
+{
+	switch (Strategy)
+	{
+	case EClothFragmentStrategy::SphereDebris:
+		return CVarSphereDebris.GetValueOnGameThread();
+	case EClothFragmentStrategy::BakedCells:
+		return CVarBakedCells.GetValueOnGameThread();
+	case EClothFragmentStrategy::LocalVoronoi:
+		return CVarLocalVoronoi.GetValueOnGameThread();
+	case EClothFragmentStrategy::StripTear:
+		return CVarStripTear.GetValueOnGameThread();
+	default:
+		return true;
+	}
+}
+
+void ClothBreakCVars::ApplyOverrides(FClothBreakableRuntimeSettings& Settings)
+{
+	// 画质档位只收紧设置，不放宽设置资产中关闭的功能
+	const FClothBreakQualityTier& Tier = GetQualityTier();
+	Settings.MaxFragmentCount = FMath::Min(Settings.MaxFragmentCount, Tier.MaxFragmentsPerBreak);
+	Settings.MinFragmentCount = FMath::Min(Settings.MinFragmentCount, Settings.MaxFragmentCount);
+	Settings.bEnableFragmentPhysics &= Tier.bEnableFragmentPhysics;
+	if (!Tier.bAllowAdvancedStrategies)
+	{
+		Settings.FragmentStrategy = EClothFragmentStrategy::SphereDebris;
+	}
+	if (Tier.bHoleMaskOnly || Tier.MaxFragmentsPerBreak <= 0 || !Tier.bEnableFragmentPhysics)
+	{
+		Settings.bEnableFragments = false;
+	}
+	if (Tier.bHoleMaskOnly)
+	{
+		Settings.bEnableTearPropagation = false;
+	}
+
+	const float FullBreakCameraDistance = CVarFullBreakCameraDistance.GetValueOnGameThread();
+	if (FullBreakCameraDistance >= 0.0f)
+	{
+		Settings.FullBreakCameraDistance = FullBreakCameraDistance;
+	}
+
+	const int32 MaxFullBreakLOD = CVarMaxFullBreakLOD.GetValueOnGameThread();
+	if (MaxFullBreakLOD >= 0)
+	{
+		Settings.MaxFullBreakLOD = MaxFullBreakLOD;
+	}
+
+	// 配置的策略被禁用时退回SphereDebris，两者都禁用时只保留破洞
+	if (!IsFragmentStrategyEnabled(Settings.FragmentStrategy))
+	{
+		Settings.FragmentStrategy = EClothFragmentStrategy::SphereDebris;
+		Settings.bEnableFragments &= IsFragmentStrategyEnabled(EClothFragmentStrategy::SphereDebris);
+	}
+}
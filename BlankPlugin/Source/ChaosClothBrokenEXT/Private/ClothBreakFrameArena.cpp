@@ -0,0 +1,293 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakFrameArena.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+FDelegateHandle FClothBreakFrameArena::EndFrameHandle;
+
+FClothBreakFrameArena& FClothBreakFrameArena::Get()
+{
+	check(IsInGameThread());
+	static FClothBreakFrameArena Arena;
+	return Arena;
+}
+
+void FClothBreakFrameArena::Startup()
+{
+	if (!EndFrameHandle.IsValid())
+	{
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddLambda([]()
+		{
+			FClothBreakFrameArena::Get().Reset();
+		});
+	}
+}
+
+void FClothBreakFrameArena::Shutdown()
+{
+	if (EndFrameHandle.IsValid())
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		EndFrameHandle.Reset();
+	}
+
+	Get().Reset();
+}
+
+void* FClothBreakFrameArena::Allocate(SIZE_T Size, uint32 Alignment)
+{
+	// 本帧第一次分配时打上帧起点标记
+	if (!FrameMark.IsSet())
+	{
+		FrameMark.Emplace(Stack);
+	}
+
+	FrameBytes += Size;
+	PeakFrameBytes = FMath::Max(PeakFrameBytes, FrameBytes);
+
+	return Stack.PushBytes(Size, Alignment);
+}
+
+void FClothBreakFrameArena::Reset()
+{
+	// 弹出帧起点标记即可释放本帧全部分配，页会回到FPageAllocator的缓存中
+	FrameMark.Reset();
+	FrameBytes = 0;
+}
+
+namespace ClothBreakAllocationCounter
+{
+	// 当前线程的统计作用域嵌套深度
+	static thread_local int32 ScopeDepth = 0;
+
+	// 当前线程的保留分配作用域嵌套深度
+	static thread_local int32 KeptScopeDepth = 0;
+
+	// 当前线程在统计作用域内的堆分配次数
+	static thread_local int32 NumAllocations = 0;
+
+	// 当前线程在保留分配作用域内的堆分配次数
+	static thread_local int32 NumKeptAllocations = 0;
+
+	// 是否已包装GMalloc
+	static bool bEnabled = false;
+
+	FORCEINLINE void RecordAllocation()
+	{
+		if (ScopeDepth > 0)
+		{
+			++NumAllocations;
+			if (KeptScopeDepth > 0)
+			{
+				++NumKeptAllocations;
+			}
+		}
+	}
+
+	/**
+	 * 统计分配次数的GMalloc包装
+	 * 只在统计作用域内计数，其余调用原样转发，包装之前分配的内存可以直接经过包装释放
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInnerMalloc)
+			: InnerMalloc(InInnerMalloc)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			RecordAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			RecordAllocation();
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* MallocZeroed(SIZE_T Count, uint32 Alignment) override
+		{
+			RecordAllocation();
+			return InnerMalloc->MallocZeroed(Count, Alignment);
+		}
+
+		virtual void* TryMallocZeroed(SIZE_T Count, uint32 Alignment) override
+		{
+			RecordAllocation();
+			return InnerMalloc->TryMallocZeroed(Count, Alignment);
+		}
+
+		// 大小为0的重新分配等同于释放，不计数
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				RecordAllocation();
+			}
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				RecordAllocation();
+			}
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return InnerMalloc->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return InnerMalloc->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			InnerMalloc->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override
+		{
+			InnerMalloc->MarkTLSCachesAsUsedOnCurrentThread();
+		}
+
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override
+		{
+			InnerMalloc->MarkTLSCachesAsUnusedOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual void InitializeStatsMetadata() override
+		{
+			InnerMalloc->InitializeStatsMetadata();
+		}
+
+		virtual void UpdateStats() override
+		{
+			InnerMalloc->UpdateStats();
+		}
+
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+		{
+			InnerMalloc->GetAllocatorStats(OutStats);
+		}
+
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+		{
+			InnerMalloc->DumpAllocatorStats(Ar);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return InnerMalloc->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return InnerMalloc->ValidateHeap();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return InnerMalloc->GetDescriptiveName();
+		}
+
+		virtual void OnMallocInitialized() override
+		{
+			InnerMalloc->OnMallocInitialized();
+		}
+
+		virtual void OnPreFork() override
+		{
+			InnerMalloc->OnPreFork();
+		}
+
+		virtual void OnPostFork() override
+		{
+			InnerMalloc->OnPostFork();
+		}
+
+	private:
+		FMalloc* InnerMalloc;
+	};
+}
+
+bool FClothBreakAllocationCounter::IsEnabled()
+{
+	return ClothBreakAllocationCounter::bEnabled;
+}
+
+void FClothBreakAllocationCounter::Startup()
+{
+#if !UE_BUILD_SHIPPING
+	check(IsInGameThread());
+	if (ClothBreakAllocationCounter::bEnabled || !GMalloc || !FParse::Param(FCommandLine::Get(), TEXT("ClothBreakTrackAllocations")))
+	{
+		return;
+	}
+
+	// 只在模块加载时包装一次，此时还没有断裂流程在运行。包装器原样转发全部调用，
+	// 其他线程在替换前后拿到的分配器都能正确释放对方分配的内存，替换用原子写入发布
+	FMalloc* CountingMalloc = new ClothBreakAllocationCounter::FCountingMalloc(GMalloc);
+	FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, CountingMalloc);
+	ClothBreakAllocationCounter::bEnabled = true;
+	UE_LOG(LogTemp, Log, TEXT("Cloth break allocation tracking enabled"));
+#endif
+}
+
+FClothBreakAllocationCounter::FScope::FScope()
+	: StartAllocations(ClothBreakAllocationCounter::NumAllocations)
+	, StartKeptAllocations(ClothBreakAllocationCounter::NumKeptAllocations)
+{
+	++ClothBreakAllocationCounter::ScopeDepth;
+}
+
+FClothBreakAllocationCounter::FScope::~FScope()
+{
+	--ClothBreakAllocationCounter::ScopeDepth;
+}
+
+int32 FClothBreakAllocationCounter::FScope::GetNumAllocations() const
+{
+	return ClothBreakAllocationCounter::NumAllocations - StartAllocations;
+}
+
+int32 FClothBreakAllocationCounter::FScope::GetNumKeptAllocations() const
+{
+	return ClothBreakAllocationCounter::NumKeptAllocations - StartKeptAllocations;
+}
+
+FClothBreakAllocationCounter::FKeptScope::FKeptScope()
+{
+	++ClothBreakAllocationCounter::KeptScopeDepth;
+}
+
+FClothBreakAllocationCounter::FKeptScope::~FKeptScope()
+{
+	--ClothBreakAllocationCounter::KeptScopeDepth;
+}
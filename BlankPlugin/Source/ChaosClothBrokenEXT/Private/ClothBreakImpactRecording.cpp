@@ -0,0 +1,150 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakImpactRecording.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace ClothBreakImpactRecording
+{
+	// 文件标识 "CBIR"
+	constexpr uint32 Magic = 0x52494243;
+
+	// 文件格式版本，格式变化时递增
+	constexpr uint16 Version = 2;
+
+	// 一次冲击在文件中占用的字节数，与SerializeImpact写入的字段一致
+	constexpr int64 ImpactSize = sizeof(uint32) + sizeof(float) + sizeof(uint16) + sizeof(FVector3f) + sizeof(FVector3f) + sizeof(int32)
+		+ sizeof(float) * 3 + sizeof(int32) + sizeof(int16);
+
+	void SerializeImpact(FArchive& Ar, FClothBreakRecordedImpact& Impact)
+	{
+		int16 MaterialID = (int16)Impact.MaterialID;
+		Ar << Impact.Frame << Impact.Time << Impact.ComponentIndex << Impact.LocalLocation << Impact.LocalNormal << Impact.HitBone
+			<< Impact.Radius << Impact.Force << Impact.FragmentMultiplier << Impact.Seed << MaterialID;
+		Impact.MaterialID = MaterialID;
+	}
+}
+
+bool FClothBreakImpactRecording::SaveToFile(const FString& Filename) const
+{
+	using namespace ClothBreakImpactRecording;
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 FileMagic = Magic;
+	uint16 FileVersion = Version;
+	Writer << FileMagic << FileVersion;
+
+	int32 NumComponents = ComponentNames.Num();
+	Writer << NumComponents;
+	for (const FString& Name : ComponentNames)
+	{
+		FString NameCopy = Name;
+		Writer << NameCopy;
+	}
+
+	int32 NumImpacts = Impacts.Num();
+	Writer << NumImpacts;
+	for (const FClothBreakRecordedImpact& Impact : Impacts)
+	{
+		FClothBreakRecordedImpact ImpactCopy = Impact;
+		SerializeImpact(Writer, ImpactCopy);
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Data, *Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to save cloth impact recording to %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Saved %d cloth impacts on %d components to %s (%d bytes)"),
+		Impacts.Num(), ComponentNames.Num(), *Filename, Data.Num());
+	return true;
+}
+
+bool FClothBreakImpactRecording::LoadFromFile(const FString& Filename)
+{
+	using namespace ClothBreakImpactRecording;
+
+	ComponentNames.Reset();
+	Impacts.Reset();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to load cloth impact recording from %s"), *Filename);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 FileMagic = 0;
+	uint16 FileVersion = 0;
+	Reader << FileMagic << FileVersion;
+	if (FileMagic != Magic || FileVersion != Version)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Unsupported cloth impact recording %s (version %d)"), *Filename, FileVersion);
+		return false;
+	}
+
+	int32 NumComponents = 0;
+	Reader << NumComponents;
+	if (NumComponents < 0 || NumComponents > MAX_uint16 + 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Corrupted cloth impact recording %s"), *Filename);
+		return false;
+	}
+
+	ComponentNames.SetNum(NumComponents);
+	for (FString& Name : ComponentNames)
+	{
+		Reader << Name;
+	}
+
+	// 数量来自文件，按剩余字节限制，损坏的文件不会请求过大的分配
+	int32 NumImpacts = 0;
+	Reader << NumImpacts;
+	if (NumImpacts < 0 || Reader.IsError() || NumImpacts * ImpactSize > Reader.TotalSize() - Reader.Tell())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Corrupted cloth impact recording %s"), *Filename);
+		return false;
+	}
+
+	Impacts.SetNum(NumImpacts);
+	for (FClothBreakRecordedImpact& Impact : Impacts)
+	{
+		SerializeImpact(Reader, Impact);
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Corrupted cloth impact recording %s"), *Filename);
+		ComponentNames.Reset();
+		Impacts.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+FString FClothBreakImpactRecording::GetDefaultFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("ClothBreak") / TEXT("Impacts.cbir");
+}
+
+FString FClothBreakImpactRecording::GetComponentName(const UActorComponent* Component)
+{
+	if (!Component)
+	{
+		return FString();
+	}
+
+	// 不使用完整路径，PIE和打包后的关卡路径不同
+	const AActor* Owner = Component->GetOwner();
+	return Owner ? FString::Printf(TEXT("%s.%s"), *Owner->GetName(), *Component->GetName()) : Component->GetName();
+}
@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakMemory.h"
+#include "HAL/IConsoleManager.h"
+
+LLM_DEFINE_TAG(ClothBreak);
+LLM_DEFINE_TAG(ClothBreak_Components, TEXT("Components"), TEXT("ClothBreak"));
+LLM_DEFINE_TAG(ClothBreak_Fragments, TEXT("Fragments"), TEXT("ClothBreak"));
+LLM_DEFINE_TAG(ClothBreak_HoleMask, TEXT("HoleMask"), TEXT("ClothBreak"));
+LLM_DEFINE_TAG(ClothBreak_Tables, TEXT("Tables"), TEXT("ClothBreak"));
+LLM_DEFINE_TAG(ClothBreak_Tearing, TEXT("Tearing"), TEXT("ClothBreak"));
+LLM_DEFINE_TAG(ClothBreak_Subsystem, TEXT("Subsystem"), TEXT("ClothBreak"));
+
+static TAutoConsoleVariable<float> CVarClothBreakMemoryBudgetMB(
+	TEXT("ClothBreak.MemoryBudgetMB"),
+	64.0f,
+	TEXT("Memory budget of the cloth break plugin in MB. A warning is logged when the estimated total exceeds it. 0 disables the check."),
+	ECVF_Default);
+
+int64 ClothBreakMemory::GetBudgetBytes()
+{
+	return (int64)(FMath::Max(CVarClothBreakMemoryBudgetMB.GetValueOnGameThread(), 0.0f) * 1024.0f * 1024.0f);
+}
+
+int64 ClothBreakMemory::GetObjectSize(UObject* Object)
+{
+	if (!Object)
+	{
+		return 0;
+	}
+
+	return Object->GetClass()->GetStructureSize() + (int64)Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
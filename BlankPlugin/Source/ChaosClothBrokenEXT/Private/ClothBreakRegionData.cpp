@@ -0,0 +1,150 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakRegionData.h"
+#include "ClothHoleMask.h"
+#include "Engine/SkeletalMesh.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_EDITOR
+#include "Interfaces/ITargetPlatform.h"
+#include "Engine/SkinnedAssetAsyncCompileUtils.h"
+#endif
+
+const FClothBreakRegionLODData* UClothBreakRegionUserData::FindLOD(int32 LODIndex) const
+{
+	return LODs.FindByPredicate([LODIndex](const FClothBreakRegionLODData& Entry)
+	{
+		return Entry.LODIndex == LODIndex;
+	});
+}
+
+TSharedPtr<FClothSurfaceUVTable> UClothBreakRegionUserData::LoadTable(int32 LODIndex) const
+{
+	const FClothBreakRegionLODData* LODData = FindLOD(LODIndex);
+	return LODData ? FClothSurfaceUVTable::LoadFromBytes(LODData->Data) : nullptr;
+}
+
+bool UClothBreakRegionUserData::IsUpToDate(const USkeletalMesh* Mesh, int32 LODIndex) const
+{
+	const FSkeletalMeshRenderData* RenderData = Mesh ? Mesh->GetResourceForRendering() : nullptr;
+	const FClothBreakRegionLODData* LODData = FindLOD(LODIndex);
+	if (!LODData || !RenderData || !RenderData->LODRenderData.IsValidIndex(LODIndex))
+	{
+		return false;
+	}
+
+#if WITH_EDITORONLY_DATA
+	// 重新导入或修改构建设置后派生数据键变化
+	if (SourceMeshKey != const_cast<USkeletalMesh*>(Mesh)->GetDerivedDataKey())
+	{
+		return false;
+	}
+#endif
+
+	return LODData->NumVertices == (int32)RenderData->LODRenderData[LODIndex].GetNumVertices();
+}
+
+const UClothBreakRegionUserData* UClothBreakRegionUserData::Find(const USkeletalMesh* Mesh)
+{
+	const TArray<UAssetUserData*>* UserDataArray = Mesh ? Mesh->GetAssetUserDataArray() : nullptr;
+	if (!UserDataArray)
+	{
+		return nullptr;
+	}
+
+	for (const UAssetUserData* UserData : *UserDataArray)
+	{
+		if (const UClothBreakRegionUserData* RegionData = Cast<UClothBreakRegionUserData>(UserData))
+		{
+			return RegionData;
+		}
+	}
+
+	return nullptr;
+}
+
+#if WITH_EDITOR
+int32 UClothBreakRegionUserData::Bake(const ITargetPlatform* TargetPlatform)
+{
+	USkeletalMesh* Mesh = Cast<USkeletalMesh>(GetOuter());
+	if (!Mesh)
+	{
+		return 0;
+	}
+
+	// 其他平台的LOD设置和顶点可能与编辑器不同，按目标平台的渲染数据构建，此时不经过编辑器的派生数据缓存键
+	const bool bPlatformData = TargetPlatform && !TargetPlatform->IsRunningPlatform();
+	const FSkeletalMeshRenderData* RenderData = Mesh->GetResourceForRendering();
+	TUniquePtr<FSkeletalMeshRenderData> PlatformRenderData;
+	if (bPlatformData)
+	{
+		FSkinnedAssetCompilationContext Context;
+		PlatformRenderData = MakeUnique<FSkeletalMeshRenderData>();
+		PlatformRenderData->Cache(TargetPlatform, Mesh, &Context);
+		RenderData = PlatformRenderData.Get();
+	}
+
+	if (!RenderData)
+	{
+		return 0;
+	}
+
+	LODs.Reset();
+	for (int32 LODIndex = 0; LODIndex < RenderData->LODRenderData.Num(); ++LODIndex)
+	{
+		// 派生数据缓存命中时不需要重新构建
+		TSharedPtr<FClothSurfaceUVTable> Table = bPlatformData
+			? FClothSurfaceUVTable::Build(Mesh, *RenderData, LODIndex)
+			: FClothSurfaceUVTable::BuildCached(Mesh, LODIndex, FClothSurfaceUVTable::GetCacheKey(Mesh, LODIndex));
+		if (Table)
+		{
+			FClothBreakRegionLODData& LODData = LODs.AddDefaulted_GetRef();
+			LODData.LODIndex = LODIndex;
+			LODData.NumVertices = RenderData->LODRenderData[LODIndex].GetNumVertices();
+			Table->SaveToBytes(LODData.Data);
+		}
+	}
+
+	// 为其他平台烘焙的数据留在编辑器内存中时，键不匹配，编辑器改用派生数据缓存
+	SourceMeshKey = Mesh->GetDerivedDataKey();
+	if (bPlatformData)
+	{
+		SourceMeshKey += TEXT("_") + TargetPlatform->PlatformName();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Baked cloth region tables for %s (%s): %d of %d LODs"),
+		*Mesh->GetName(), bPlatformData ? *TargetPlatform->PlatformName() : TEXT("editor"), LODs.Num(), RenderData->LODRenderData.Num());
+
+	return LODs.Num();
+}
+
+int32 UClothBreakRegionUserData::BakeMesh(USkeletalMesh* Mesh)
+{
+	if (!Mesh)
+	{
+		return 0;
+	}
+
+	UClothBreakRegionUserData* RegionData = const_cast<UClothBreakRegionUserData*>(Find(Mesh));
+	if (!RegionData)
+	{
+		RegionData = NewObject<UClothBreakRegionUserData>(Mesh, NAME_None, RF_Transactional);
+		Mesh->AddAssetUserData(RegionData);
+	}
+
+	Mesh->Modify();
+	return RegionData->Bake();
+}
+
+void UClothBreakRegionUserData::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	// 烘焙时按目标平台最新的渲染数据重建，保证与烘焙出的网格体一致
+	if (SaveContext.IsCooking())
+	{
+		Bake(SaveContext.GetTargetPlatform());
+	}
+}
+#endif
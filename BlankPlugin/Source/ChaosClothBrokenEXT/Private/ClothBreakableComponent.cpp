@@ -3,56 +3,237 @@
 #include "ClothBreakableComponent.h"
 #include "ClothingSimulationInteractor.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
 #include "BulletImpactHandler.h"
 #include "ClothFragmentGenerator.h"
+#include "ClothBreakingSubsystem.h"
+#include "ClothBreakFrameArena.h"
+#include "ClothBreakMemory.h"
+#include "GameFramework/PlayerController.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Misc/ScopeExit.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace ClothBreakState
+{
+	// 数据格式版本，格式变化时递增
+	constexpr uint8 Version = 4;
+
+	// 位置量化精度为0.1厘米，范围约为±32米，超出范围时保存失败
+	constexpr float PositionScale = 10.0f;
+
+	// 半径量化精度为0.1厘米，最大约65米
+	constexpr float RadiusScale = 10.0f;
+
+	// 无效材质ID的编码
+	constexpr uint16 NoMaterialID = MAX_uint16;
+
+	// 版本(1) + 网格体版本(4) + 破洞数量(4)
+	constexpr int32 HeaderSize = 9;
+
+	// 撕裂范围的标记位
+	constexpr uint8 TearFlag = 1 << 0;
+
+	// 位置(6) + 半径(2) + 材质ID(2) + 标记(1)
+	constexpr int32 HoleSize = 11;
+
+	/** 量化一个坐标分量，超出int16范围时返回false */
+	bool QuantizePosition(float Value, int16& OutValue)
+	{
+		const int32 Quantized = FMath::RoundToInt(Value * PositionScale);
+		if (Quantized < MIN_int16 || Quantized > MAX_int16)
+		{
+			return false;
+		}
+		OutValue = (int16)Quantized;
+		return true;
+	}
+}
+
+namespace
+{
+	// 表面查找表加载失败后重新请求前的等待时间（秒）
+	constexpr double SurfaceTableRetrySeconds = 30.0;
+}
 
 UClothBreakableComponent::UClothBreakableComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	// 由UClothBreakingSubsystem统一驱动，组件本身不需要Tick，布料模拟位置在需要时读取
+	PrimaryComponentTick.bCanEverTick = false;
 	bIsInitialized = false;
+	RuntimeStateIndex = INDEX_NONE;
+	SurfaceTableLOD = INDEX_NONE;
+	PendingSurfaceTableLOD = INDEX_NONE;
+	SurfaceTableRetryTime = 0.0;
+	Readiness = EClothBreakableReadiness::Uninitialized;
 
-	// 创建默认设置对象
-	BreakableSettings = CreateDefaultSubobject<UClothBreakableSettings>(TEXT("BreakableSettings"));
+	// 默认不创建设置对象，引用共享资产，未指定时使用默认设置
+	BreakableSettings = nullptr;
+}
+
+void UClothBreakableComponent::PostLoad()
+{
+	Super::PostLoad();
+
+	// 旧版本的设置是组件自己的子对象，实例上的值迁移到覆盖中
+	if (BreakableSettings && BreakableSettings->GetOuter() == this)
+	{
+		const UClothBreakableSettings* Legacy = BreakableSettings;
+		const UClothBreakableSettings* Defaults = GetDefault<UClothBreakableSettings>();
+
+		// 已勾选的覆盖以用户的设置为准
+		if (!SettingsOverrides.bOverride_BreakableMaterialIDs && Legacy->BreakableMaterialIDs != Defaults->BreakableMaterialIDs)
+		{
+			SettingsOverrides.bOverride_BreakableMaterialIDs = true;
+			SettingsOverrides.BreakableMaterialIDs = Legacy->BreakableMaterialIDs;
+		}
+
+		if (!SettingsOverrides.bOverride_BreakForceThreshold && Legacy->BreakForceThreshold != Defaults->BreakForceThreshold)
+		{
+			SettingsOverrides.bOverride_BreakForceThreshold = true;
+			SettingsOverrides.BreakForceThreshold = Legacy->BreakForceThreshold;
+		}
+
+		if (!SettingsOverrides.bOverride_RadiusMultiplier && Legacy->RadiusMultiplier != Defaults->RadiusMultiplier)
+		{
+			SettingsOverrides.bOverride_RadiusMultiplier = true;
+			SettingsOverrides.RadiusMultiplier = Legacy->RadiusMultiplier;
+		}
+
+		if (!SettingsOverrides.bOverride_FragmentCount
+			&& (Legacy->MinFragmentCount != Defaults->MinFragmentCount || Legacy->MaxFragmentCount != Defaults->MaxFragmentCount))
+		{
+			SettingsOverrides.bOverride_FragmentCount = true;
+			SettingsOverrides.MinFragmentCount = Legacy->MinFragmentCount;
+			SettingsOverrides.MaxFragmentCount = Legacy->MaxFragmentCount;
+		}
+
+		if (!SettingsOverrides.bOverride_FragmentSize
+			&& (Legacy->MinFragmentSize != Defaults->MinFragmentSize || Legacy->MaxFragmentSize != Defaults->MaxFragmentSize))
+		{
+			SettingsOverrides.bOverride_FragmentSize = true;
+			SettingsOverrides.MinFragmentSize = Legacy->MinFragmentSize;
+			SettingsOverrides.MaxFragmentSize = Legacy->MaxFragmentSize;
+		}
+
+		if (!SettingsOverrides.bOverride_FragmentPhysics
+			&& (Legacy->bEnableFragmentPhysics != Defaults->bEnableFragmentPhysics || Legacy->FragmentMass != Defaults->FragmentMass
+				|| Legacy->FragmentLifetime != Defaults->FragmentLifetime))
+		{
+			SettingsOverrides.bOverride_FragmentPhysics = true;
+			SettingsOverrides.bEnableFragmentPhysics = Legacy->bEnableFragmentPhysics;
+			SettingsOverrides.FragmentMass = Legacy->FragmentMass;
+			SettingsOverrides.FragmentLifetime = Legacy->FragmentLifetime;
+		}
+
+		// 子弹配置和穿透设置没有对应的覆盖，改动过时继续引用旧对象，否则使用默认设置
+		const bool bHasUnmappedValues = Legacy->BulletProfiles.Num() > 0
+			|| Legacy->DefaultBulletProfile != Defaults->DefaultBulletProfile
+			|| Legacy->bEnablePenetration != Defaults->bEnablePenetration
+			|| Legacy->MaxPenetrationDepth != Defaults->MaxPenetrationDepth
+			|| Legacy->MaxPenetrationLayers != Defaults->MaxPenetrationLayers
+			|| Legacy->PenetrationEnergyRetention != Defaults->PenetrationEnergyRetention;
+		if (!bHasUnmappedValues)
+		{
+			BreakableSettings = nullptr;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("%s: migrated legacy per-component cloth break settings to overrides%s"),
+			*GetPathName(), bHasUnmappedValues ? TEXT(", keeping the legacy settings object for bullet profiles and penetration") : TEXT(""));
+	}
 }
 
 void UClothBreakableComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// 在BeginPlay中初始化布料断裂系统
-	InitializeBreakableCloth();
+	RefreshRuntimeSettings();
 
-	// 注册碰撞事件
-	RegisterHitEvents();
+	// 注册到子系统，目标骨骼网格体尚未设置时由子系统稍后重试初始化
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		Subsystem->RegisterComponent(this);
+	}
+	else if (!TryInitialize())
+	{
+		// 没有子系统的世界不会自动重试，第一次使用时再尝试
+		UE_LOG(LogTemp, Verbose, TEXT("Cloth breakable component has no target mesh yet; initialization will be retried on first use"));
+	}
 }
 
 void UClothBreakableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	// 从子系统注销，关卡流送移除时暂存断裂状态
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		if (EndPlayReason == EEndPlayReason::RemovedFromWorld)
+		{
+			Subsystem->StashBreakState(this);
+		}
+
+		Subsystem->UnregisterComponent(this);
+	}
+
 	// 清理资源
+	DamageLoosening.Reset(TargetSkeletalMesh);
 	if (TargetSkeletalMesh)
 	{
 		// 移除碰撞事件监听
 		TargetSkeletalMesh->OnComponentHit.RemoveDynamic(this, &UClothBreakableComponent::OnComponentHit);
 	}
 
+	SimSnapshot.Reset();
+
+	// 释放共享的表面查找表引用，尚未完成的加载结果会被忽略
+	SurfaceTable.Reset();
+	SurfaceTableLOD = INDEX_NONE;
+	PendingSurfaceTableLOD = INDEX_NONE;
+	SurfaceTableRetryTime = 0.0;
+	Readiness = EClothBreakableReadiness::Uninitialized;
+	bIsInitialized = false;
+
 	Super::EndPlay(EndPlayReason);
 }
 
-void UClothBreakableComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+bool UClothBreakableComponent::TryInitialize()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
 	// 如果尚未初始化且目标骨骼网格体有效，则尝试初始化
 	if (!bIsInitialized && TargetSkeletalMesh && TargetSkeletalMesh->IsValidLowLevel())
 	{
+		LLM_SCOPE_BYTAG(ClothBreak_Components);
 		InitializeBreakableCloth();
 		RegisterHitEvents();
+
+		// 区域数据在后台加载，加载完成前冲击走简化路径
+		Readiness = EClothBreakableReadiness::Building;
+		RequestSurfaceTable(GetRenderedLOD());
+
+		// 关卡流送回来时恢复之前的断裂状态
+		if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+		{
+			Subsystem->RestoreStashedBreakState(this);
+		}
 	}
+
+	return bIsInitialized;
+}
+
+bool UClothBreakableComponent::EnsureInitialized()
+{
+	if (!bIsInitialized && !UClothBreakingSubsystem::Get(this))
+	{
+		TryInitialize();
+	}
+
+	return bIsInitialized;
 }
 
 void UClothBreakableComponent::InitializeBreakableCloth()
 {
-	if (!TargetSkeletalMesh || !BreakableSettings)
+	if (!TargetSkeletalMesh)
 	{
 		return;
 	}
@@ -114,109 +295,727 @@ void UClothBreakableComponent::OnComponentHit(UPrimitiveComponent* HitComponent,
 
 bool UClothBreakableComponent::HandleBulletHit(const FHitResult& HitResult)
 {
-	if (!bIsInitialized || !TargetSkeletalMesh || !BulletImpactHandler || !BreakableSettings)
+	FClothBreakAllocationCounter::FScope AllocationScope;
+	ON_SCOPE_EXIT { ReportBreakAllocations(AllocationScope, TEXT("HandleBulletHit")); };
+
+	if (!EnsureInitialized() || !TargetSkeletalMesh || !BulletImpactHandler)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Cannot handle bullet hit: component not properly initialized"));
 		return false;
 	}
 
-	// 处理子弹碰撞
-	FVector ImpactLocation;
-	float BreakRadius;
-	float ImpactForce;
-
-	if (!BulletImpactHandler->ProcessBulletImpact(HitResult, BreakableSettings->RadiusMultiplier,
-		ImpactLocation, BreakRadius, ImpactForce))
+	// 外层的穿透扫描已经处理过这一层
+	UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this);
+	if (Subsystem && Subsystem->WasPenetratedBy(this, HitResult.GetActor()))
 	{
 		return false;
 	}
 
-	// 检查碰撞力是否超过阈值
-	if (ImpactForce < BreakableSettings->BreakForceThreshold)
+	// 处理子弹碰撞，有子弹配置时直接查表
+	FBulletImpactParams ImpactParams;
+	if (!BulletImpactHandler->ResolveBulletImpact(HitResult, RuntimeSettings, ImpactParams))
 	{
-		UE_LOG(LogTemp, Log, TEXT("Bullet impact force (%f) below threshold (%f)"),
-			ImpactForce, BreakableSettings->BreakForceThreshold);
 		return false;
 	}
 
-	// 检查位置是否在可断裂区域内
-	int32 MaterialID = INDEX_NONE;
-	if (!IsLocationInBreakableRegion(ImpactLocation, MaterialID))
+	// 多层穿透：一次扫描找出弹道上的所有布料层，阈值在每层分别检查
+	if (RuntimeSettings.bEnablePenetration && Subsystem)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Bullet impact location not in breakable region"));
-		return false;
+		return Subsystem->QueuePenetratingImpact(this, HitResult, ImpactParams) > 0;
 	}
 
-	// 生成碎片
-	GenerateFragmentsAtLocation(ImpactLocation, BreakRadius, ImpactForce);
+	const FVector ImpactLocation = ImpactParams.Location;
+	const float BreakRadius = ImpactParams.BreakRadius;
+	const float ImpactForce = ImpactParams.ImpactForce;
 
-	// 触发事件
-	OnClothBreak.Broadcast(TargetSkeletalMesh, ImpactLocation, BreakRadius, ImpactForce, MaterialID);
+	// 检查碰撞力是否超过阈值
+	if (ImpactForce < RuntimeSettings.BreakForceThreshold)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Bullet impact force (%f) below threshold (%f)"),
+			ImpactForce, RuntimeSettings.BreakForceThreshold);
+		return false;
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("Bullet hit processed: Location=%s, Radius=%f, Force=%f"),
+	UE_LOG(LogTemp, Verbose, TEXT("Bullet hit processed: Location=%s, Radius=%f, Force=%f"),
 		*ImpactLocation.ToString(), BreakRadius, ImpactForce);
 
-	return true;
+	return DispatchBreak(ImpactLocation, BreakRadius, ImpactForce, ImpactParams.FragmentMultiplier, ImpactParams.Normal,
+		FindHitBone(ImpactParams.BoneName));
 }
 
 bool UClothBreakableComponent::SimulateBulletImpact(FVector ImpactLocation, float BulletSize, float ImpactForce)
 {
-	if (!bIsInitialized || !TargetSkeletalMesh || !BreakableSettings)
+	FClothBreakAllocationCounter::FScope AllocationScope;
+	ON_SCOPE_EXIT { ReportBreakAllocations(AllocationScope, TEXT("SimulateBulletImpact")); };
+
+	if (!EnsureInitialized() || !TargetSkeletalMesh)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Cannot simulate bullet impact: component not properly initialized"));
 		return false;
 	}
 
 	// 计算断裂半径
-	float BreakRadius = BulletSize * BreakableSettings->RadiusMultiplier;
+	float BreakRadius = BulletSize * RuntimeSettings.RadiusMultiplier;
 
 	// 检查碰撞力是否超过阈值
-	if (ImpactForce < BreakableSettings->BreakForceThreshold)
+	if (ImpactForce < RuntimeSettings.BreakForceThreshold)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Simulated impact force (%f) below threshold (%f)"),
-			ImpactForce, BreakableSettings->BreakForceThreshold);
+		UE_LOG(LogTemp, Verbose, TEXT("Simulated impact force (%f) below threshold (%f)"),
+			ImpactForce, RuntimeSettings.BreakForceThreshold);
 		return false;
 	}
 
-	// 检查位置是否在可断裂区域内
+	UE_LOG(LogTemp, Verbose, TEXT("Simulated bullet impact: Location=%s, Radius=%f, Force=%f"),
+		*ImpactLocation.ToString(), BreakRadius, ImpactForce);
+
+	return DispatchBreak(ImpactLocation, BreakRadius, ImpactForce);
+}
+
+bool UClothBreakableComponent::DispatchBreak(const FVector& Location, float Radius, float ImpactForce, float FragmentMultiplier,
+	const FVector& Normal, int32 HitBone)
+{
+	// 交给子系统，与本帧其他角色的冲击一起处理
+	UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this);
+	if (Subsystem && Subsystem->QueueImpact(this, Location, Radius, ImpactForce, FragmentMultiplier, Normal, HitBone))
+	{
+		return true;
+	}
+
+	// 没有子系统时（例如编辑器世界）立即处理
 	int32 MaterialID = INDEX_NONE;
-	if (!IsLocationInBreakableRegion(ImpactLocation, MaterialID))
+	if (!IsLocationInBreakableRegion(Location, MaterialID, HitBone))
 	{
-		UE_LOG(LogTemp, Log, TEXT("Simulated impact location not in breakable region"));
+		UE_LOG(LogTemp, Verbose, TEXT("Impact location not in breakable region"));
 		return false;
 	}
 
-	// 生成碎片
-	GenerateFragmentsAtLocation(ImpactLocation, BreakRadius, ImpactForce);
+	// 记录破洞，距离相机较近时生成碎片
+	ApplyBreakCut(Location, Radius, MaterialID, HitBone);
+	if (ShouldSpawnFragments(Location))
+	{
+		GenerateFragmentsAtLocation(Location, Radius, ImpactForce, MaterialID, FragmentMultiplier, Normal);
+	}
 
 	// 触发事件
-	OnClothBreak.Broadcast(TargetSkeletalMesh, ImpactLocation, BreakRadius, ImpactForce, MaterialID);
+	BroadcastBreak(Location, Radius, ImpactForce, MaterialID);
 
-	UE_LOG(LogTemp, Log, TEXT("Simulated bullet impact: Location=%s, Radius=%f, Force=%f"),
-		*ImpactLocation.ToString(), BreakRadius, ImpactForce);
+	return true;
+}
 
+void UClothBreakableComponent::ApplyBreakCut(const FVector& Location, float Radius, int32 MaterialID, int32 HitBone)
+{
+	if (!TargetSkeletalMesh)
+	{
+		return;
+	}
+
+	// 记录在参考姿势的组件空间中，角色移动和播放动画后破洞位置仍然有效
+	LLM_SCOPE_BYTAG(ClothBreak_Components);
+	const FVector3f LocalLocation(TargetSkeletalMesh->GetComponentTransform().InverseTransformPosition(Location));
+	FClothBreakHole& Hole = BreakHoles.AddDefaulted_GetRef();
+	Hole.LocalCenter = ToBindPose(LocalLocation, HitBone);
+	Hole.Radius = Radius;
+	Hole.MaterialID = MaterialID;
+
+	if (RuntimeSettings.bEnableHoleMask)
+	{
+		WriteHoleMask(Hole);
+	}
+
+	// 破洞覆盖的模拟粒子计入损伤，交给子系统在帧末统一放松布料约束
+	const FClothSimSnapshot* Snapshot = RuntimeSettings.bLoosenClothOnDamage ? GetSimSnapshot() : nullptr;
+	if (Snapshot && DamageLoosening.AddHoleDamage(*Snapshot, LocalLocation, Radius) > 0)
+	{
+		if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+		{
+			Subsystem->QueueDamageLoosening(this);
+		}
+		else
+		{
+			ApplyDamageLoosening();
+		}
+	}
+}
+
+void UClothBreakableComponent::AddTearDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumTornParticles)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+	if (DamageLoosening.AddTearDamage(ClothingAssetIndex, NumParticles, NumTornParticles) > 0)
+	{
+		if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+		{
+			Subsystem->QueueDamageLoosening(this);
+		}
+		else
+		{
+			ApplyDamageLoosening();
+		}
+	}
+}
+
+void UClothBreakableComponent::ApplyDamageLoosening()
+{
+	if (TargetSkeletalMesh && DamageLoosening.HasPendingUpdate())
+	{
+		DamageLoosening.ApplyPendingUpdate(*TargetSkeletalMesh, RuntimeSettings.DamageLooseness);
+	}
+}
+
+int32 UClothBreakableComponent::GetRenderedLOD() const
+{
+	return TargetSkeletalMesh ? TargetSkeletalMesh->GetPredictedLODLevel() : 0;
+}
+
+TSharedPtr<const FClothSurfaceUVTable> UClothBreakableComponent::GetSurfaceTable()
+{
+	const int32 LODIndex = GetRenderedLOD();
+	if (bIsInitialized && LODIndex != SurfaceTableLOD && LODIndex != PendingSurfaceTableLOD && FPlatformTime::Seconds() >= SurfaceTableRetryTime)
+	{
+		RequestSurfaceTable(LODIndex);
+	}
+
+	return SurfaceTable;
+}
+
+const FClothSimSnapshot* UClothBreakableComponent::GetSimSnapshot()
+{
+	if (!TargetSkeletalMesh)
+	{
+		return nullptr;
+	}
+
+	// 只有发生冲击或正在撕裂的组件会走到这里，同一帧内只读取一次
+	if (SimSnapshot.FrameNumber != GFrameCounter)
+	{
+		SimSnapshot.Capture(*TargetSkeletalMesh, GetRenderedLOD());
+	}
+
+	return SimSnapshot.Sections.Num() > 0 ? &SimSnapshot : nullptr;
+}
+
+const FClothBindPoseMapping* UClothBreakableComponent::GetBindPoseMapping()
+{
+	const TSharedPtr<const FClothSurfaceUVTable> Table = GetSurfaceTable();
+	if (!Table || !TargetSkeletalMesh)
+	{
+		return nullptr;
+	}
+
+	// 同一帧内姿势不变，查找表切换时重新更新
+	if (BindPoseMappingFrame != GFrameCounter || BindPoseMappingTable != Table.Get())
+	{
+		BindPoseMappingFrame = GFrameCounter;
+		BindPoseMappingTable = Table.Get();
+		bBindPoseMappingValid = BindPoseMapping.Update(*Table, *TargetSkeletalMesh);
+	}
+
+	return bBindPoseMappingValid ? &BindPoseMapping : nullptr;
+}
+
+FVector3f UClothBreakableComponent::ToBindPose(const FVector3f& LocalLocation, int32 HitBone)
+{
+	const FClothBindPoseMapping* Mapping = GetBindPoseMapping();
+	return Mapping ? SurfaceTable->ToBindPose(LocalLocation, *Mapping, HitBone) : LocalLocation;
+}
+
+int32 UClothBreakableComponent::FindHitBone(FName BoneName) const
+{
+	return TargetSkeletalMesh && !BoneName.IsNone() ? TargetSkeletalMesh->GetBoneIndex(BoneName) : INDEX_NONE;
+}
+
+void UClothBreakableComponent::RequestSurfaceTable(int32 LODIndex)
+{
+	if (!TargetSkeletalMesh)
+	{
+		return;
+	}
+
+	PendingSurfaceTableLOD = LODIndex;
+
+	TWeakObjectPtr<UClothBreakableComponent> WeakThis(this);
+	FClothSurfaceUVTable::GetAsync(TargetSkeletalMesh->GetSkeletalMeshAsset(), LODIndex,
+		[WeakThis, LODIndex](TSharedPtr<const FClothSurfaceUVTable> Table)
+		{
+			if (UClothBreakableComponent* This = WeakThis.Get())
+			{
+				This->HandleSurfaceTableLoaded(LODIndex, MoveTemp(Table));
+			}
+		});
+}
+
+void UClothBreakableComponent::HandleSurfaceTableLoaded(int32 LODIndex, TSharedPtr<const FClothSurfaceUVTable> Table)
+{
+	// 组件已结束或已改为请求其他LOD
+	if (LODIndex != PendingSurfaceTableLOD)
+	{
+		return;
+	}
+
+	// 加载失败时保留之前LOD的表，等待一段时间后重试
+	PendingSurfaceTableLOD = INDEX_NONE;
+	if (Table)
+	{
+		SurfaceTable = MoveTemp(Table);
+		SurfaceTableLOD = LODIndex;
+	}
+	else
+	{
+		SurfaceTableRetryTime = FPlatformTime::Seconds() + SurfaceTableRetrySeconds;
+	}
+
+	// 首次加载完成，或者之前失败、重试后成功
+	const bool bRecovered = Readiness == EClothBreakableReadiness::Failed && SurfaceTable;
+	if (Readiness != EClothBreakableReadiness::Building && !bRecovered)
+	{
+		return;
+	}
+
+	Readiness = SurfaceTable ? EClothBreakableReadiness::Ready : EClothBreakableReadiness::Failed;
+	if (Readiness == EClothBreakableReadiness::Ready)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("%s cloth region data ready"), *GetName());
+	}
+	else
+	{
+		// 简化路径无法区分材质，限定了可断裂材质时会拒绝冲击
+		UE_LOG(LogTemp, Warning, TEXT("%s cloth region data unavailable for LOD%d, using fallback path and retrying in %.0f s%s"),
+			*GetName(), LODIndex, SurfaceTableRetrySeconds,
+			RuntimeSettings.BreakableMaterialIDs.Num() > 0 ? TEXT(" (hits are rejected until then because breakable materials are restricted)") : TEXT(""));
+	}
+
+	// 加载期间恢复的破洞此时才能写入遮罩
+	if (Readiness == EClothBreakableReadiness::Ready && BreakHoles.Num() > 0)
+	{
+		RefreshHoleMask();
+	}
+
+	OnBreakableReady.Broadcast(this, Readiness);
+}
+
+bool UClothBreakableComponent::ShouldSpawnFragments(const FVector& Location) const
+{
+	// 远处角色的低精度LOD上碎片看不清，只保留破洞
+	if (!IsFullBreakLOD() || !RuntimeSettings.bEnableFragments)
+	{
+		return false;
+	}
+
+	if (!RuntimeSettings.bEnableHoleMask || RuntimeSettings.FullBreakCameraDistance <= 0.0f)
+	{
+		return true;
+	}
+
+	// 分屏时取最近的本地玩家视点，没有本地玩家时（例如专用服务器）保持完整断裂
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return true;
+	}
+
+	bool bHasLocalView = false;
+	float NearestDistanceSquared = UE_BIG_NUMBER;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		NearestDistanceSquared = FMath::Min(NearestDistanceSquared, (float)FVector::DistSquared(ViewLocation, Location));
+		bHasLocalView = true;
+	}
+
+	return !bHasLocalView || NearestDistanceSquared <= FMath::Square(RuntimeSettings.FullBreakCameraDistance);
+}
+
+void UClothBreakableComponent::GetMemoryStats(FClothBreakableMemoryStats& OutStats)
+{
+	OutStats = FClothBreakableMemoryStats();
+
+	OutStats.ComponentBytes = ClothBreakMemory::GetObjectSize(this) + BreakHoles.GetAllocatedSize()
+		+ RuntimeSettings.BreakableMaterialIDs.GetAllocatedSize() + BindPoseMapping.GetAllocatedSize() + DamageLoosening.GetAllocatedSize()
+		+ ClothBreakMemory::GetObjectSize(BulletImpactHandler) + ClothBreakMemory::GetObjectSize(FragmentGenerator);
+
+	// 只统计本组件拥有的设置对象，共享的设置资产不计入
+	if (BreakableSettings && BreakableSettings->GetOuter() == this)
+	{
+		OutStats.ComponentBytes += ClothBreakMemory::GetObjectSize(BreakableSettings);
+	}
+
+	OutStats.HoleMaskBytes = HoleMaskSlots.GetAllocatedSize();
+	for (const TPair<int32, FClothHoleMaskSlot>& Pair : HoleMaskSlots)
+	{
+		OutStats.HoleMaskBytes += ClothBreakMemory::GetObjectSize(Pair.Value.Material);
+	}
+
+	OutStats.SnapshotBytes = SimSnapshot.GetAllocatedSize();
+
+	if (FragmentGenerator)
+	{
+		OutStats.FragmentBytes = FragmentGenerator->GetFragmentMemorySize();
+		OutStats.NumFragments = FragmentGenerator->GetNumLiveFragments();
+	}
+}
+
+bool UClothBreakableComponent::WriteHoleMask(const FClothBreakHole& Hole)
+{
+	// 撕裂记录的是整条撕裂的包围球，写入遮罩会遮住没有撕开的布料，撕裂通过放松布料约束表现，遮罩只显示冲击破洞
+	if (!TargetSkeletalMesh || Hole.bTear)
+	{
+		return false;
+	}
+
+	const TSharedPtr<const FClothSurfaceUVTable> UVTable = GetSurfaceTable();
+	if (!UVTable)
+	{
+		return false;
+	}
+
+	// 破洞中心与查找表都在参考姿势下，直接按最近顶点定位，只在命中的材质上查找，避免写到相邻的其他布料
+	const int32 Vertex = UVTable->FindNearestVertex(Hole.LocalCenter, Hole.MaterialID);
+	if (Vertex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("No cloth surface near hole at %s, hole mask not written"), *Hole.LocalCenter.ToString());
+		return false;
+	}
+
+	// 写入顶点实际所在的材质槽位
+	LLM_SCOPE_BYTAG(ClothBreak_HoleMask);
+	const int32 MaterialIndex = UVTable->MaterialIndices[Vertex];
+	FClothHoleMaskSlot& Slot = HoleMaskSlots.FindOrAdd(MaterialIndex);
+	if (!Slot.Material)
+	{
+		Slot.Material = TargetSkeletalMesh->CreateDynamicMaterialInstance(MaterialIndex);
+		if (!Slot.Material)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Cannot create hole mask material for slot %d"), MaterialIndex);
+			return false;
+		}
+	}
+
+	const FVector2f& UV = UVTable->UVs[Vertex];
+	Slot.Material->SetVectorParameterValue(ClothHoleMask::GetParameterName(Slot.NextHole),
+		FLinearColor(UV.X, UV.Y, Hole.Radius * UVTable->GetUVPerUnit(Vertex), 0.0f));
+	Slot.NextHole = (Slot.NextHole + 1) % ClothHoleMask::MaxHoles;
+
+	return true;
+}
+
+void UClothBreakableComponent::RefreshHoleMask()
+{
+	// 清空所有槽位，半径为0表示未使用
+	for (TPair<int32, FClothHoleMaskSlot>& SlotPair : HoleMaskSlots)
+	{
+		FClothHoleMaskSlot& Slot = SlotPair.Value;
+		if (Slot.Material)
+		{
+			for (int32 HoleIndex = 0; HoleIndex < ClothHoleMask::MaxHoles; ++HoleIndex)
+			{
+				Slot.Material->SetVectorParameterValue(ClothHoleMask::GetParameterName(HoleIndex), FLinearColor::Transparent);
+			}
+		}
+		Slot.NextHole = 0;
+	}
+
+	if (!RuntimeSettings.bEnableHoleMask)
+	{
+		return;
+	}
+
+	// 按记录顺序重新写入冲击破洞，环形覆盖后保留的是最近的破洞，与断裂时的写入一致
+	for (const FClothBreakHole& Hole : BreakHoles)
+	{
+		if (!Hole.bTear)
+		{
+			WriteHoleMask(Hole);
+		}
+	}
+}
+
+int32 UClothBreakableComponent::ExtendTearHole(int32 HoleIndex, TConstArrayView<FVector3f> LocalPoints, int32 MaterialID)
+{
+	if (LocalPoints.Num() == 0)
+	{
+		return HoleIndex;
+	}
+
+	// 状态被清除或恢复后原有的索引不再指向这条撕裂
+	if (!BreakHoles.IsValidIndex(HoleIndex) || !BreakHoles[HoleIndex].bTear)
+	{
+		HoleIndex = BreakHoles.AddDefaulted();
+		FClothBreakHole& NewHole = BreakHoles[HoleIndex];
+		NewHole.LocalCenter = ToBindPose(LocalPoints[0]);
+		NewHole.Radius = 0.5f;
+		NewHole.MaterialID = MaterialID;
+		NewHole.bTear = true;
+	}
+
+	// 逐点扩大包围球，中心向新点移动
+	FClothBreakHole& Hole = BreakHoles[HoleIndex];
+	for (const FVector3f& LocalPoint : LocalPoints)
+	{
+		const FVector3f Point = ToBindPose(LocalPoint);
+		const float Distance = FVector3f::Dist(Point, Hole.LocalCenter);
+		if (Distance > Hole.Radius)
+		{
+			const float NewRadius = (Hole.Radius + Distance) * 0.5f;
+			Hole.LocalCenter += (Point - Hole.LocalCenter) * ((NewRadius - Hole.Radius) / Distance);
+			Hole.Radius = NewRadius;
+		}
+	}
+
+	return HoleIndex;
+}
+
+bool UClothBreakableComponent::SaveBreakState(TArray<uint8>& OutData) const
+{
+	using namespace ClothBreakState;
+
+	OutData.Reset();
+
+	if (!TargetSkeletalMesh)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot save break state: target mesh invalid"));
+		return false;
+	}
+
+	int32 NumHoles = BreakHoles.Num();
+	OutData.Reserve(HeaderSize + NumHoles * HoleSize);
+
+	FMemoryWriter Writer(OutData);
+	uint8 DataVersion = Version;
+	uint32 MeshKey = GetBreakStateMeshKey();
+	Writer << DataVersion << MeshKey << NumHoles;
+
+	for (int32 HoleIndex = 0; HoleIndex < NumHoles; ++HoleIndex)
+	{
+		const FClothBreakHole& Hole = BreakHoles[HoleIndex];
+		int16 X, Y, Z;
+		const int32 QuantizedRadius = FMath::RoundToInt(Hole.Radius * RadiusScale);
+
+		// 量化范围外的值无法还原，整份数据作废，不静默截断
+		if (!QuantizePosition(Hole.LocalCenter.X, X) || !QuantizePosition(Hole.LocalCenter.Y, Y) || !QuantizePosition(Hole.LocalCenter.Z, Z))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot save break state: hole %d at %s is outside the quantized range of +-%.0f cm"),
+				HoleIndex, *Hole.LocalCenter.ToString(), MAX_int16 / PositionScale);
+			OutData.Reset();
+			return false;
+		}
+
+		if (QuantizedRadius < 0 || QuantizedRadius > MAX_uint16)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot save break state: hole %d radius %f is outside the quantized range"), HoleIndex, Hole.Radius);
+			OutData.Reset();
+			return false;
+		}
+
+		if (Hole.MaterialID >= NoMaterialID)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Cannot save break state: hole %d material ID %d is too large"), HoleIndex, Hole.MaterialID);
+			OutData.Reset();
+			return false;
+		}
+
+		uint16 Radius = (uint16)QuantizedRadius;
+		uint16 MaterialID = Hole.MaterialID >= 0 ? (uint16)Hole.MaterialID : NoMaterialID;
+		uint8 Flags = Hole.bTear ? TearFlag : 0;
+		Writer << X << Y << Z << Radius << MaterialID << Flags;
+	}
+
+	// 破洞之后是各布料资产的损伤
+	DamageLoosening.Save(Writer);
+
+	return true;
+}
+
+bool UClothBreakableComponent::RestoreBreakState(const TArray<uint8>& Data)
+{
+	using namespace ClothBreakState;
+
+	if (Data.Num() < HeaderSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot restore break state: data too small"));
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint8 DataVersion = 0;
+	uint32 MeshKey = 0;
+	int32 NumHoles = 0;
+	Reader << DataVersion;
+
+	if (DataVersion != Version)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot restore break state: version %d, expected %d"), DataVersion, Version);
+		return false;
+	}
+
+	Reader << MeshKey << NumHoles;
+
+	if (MeshKey != GetBreakStateMeshKey())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot restore break state: saved for a different mesh"));
+		return false;
+	}
+
+	if (NumHoles < 0 || Data.Num() < HeaderSize + (int64)NumHoles * HoleSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot restore break state: corrupted data"));
+		return false;
+	}
+
+	// 先解码到临时数据，数据损坏时组件保持原状
+	TArray<FClothBreakHole> RestoredHoles;
+	RestoredHoles.SetNumUninitialized(NumHoles);
+	for (FClothBreakHole& Hole : RestoredHoles)
+	{
+		int16 X, Y, Z;
+		uint16 Radius;
+		uint16 MaterialID;
+		uint8 Flags;
+		Reader << X << Y << Z << Radius << MaterialID << Flags;
+
+		Hole.LocalCenter = FVector3f(X, Y, Z) / PositionScale;
+		Hole.Radius = Radius / RadiusScale;
+		Hole.MaterialID = MaterialID == NoMaterialID ? INDEX_NONE : MaterialID;
+		Hole.bTear = (Flags & TearFlag) != 0;
+	}
+
+	FClothDamageLooseningState RestoredDamage;
+	if (!RestoredDamage.Load(Reader) || Reader.Tell() != Data.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot restore break state: corrupted damage data"));
+		return false;
+	}
+
+	// 恢复前放松过的布料资产先回到资产配置，存档中没有损伤的布料资产因此也回到完整刚度
+	DamageLoosening.Reset(TargetSkeletalMesh);
+	DamageLoosening = MoveTemp(RestoredDamage);
+	BreakHoles = MoveTemp(RestoredHoles);
+
+	// 撕裂的边状态不保存，恢复的撕裂范围只作为破洞记录
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		Subsystem->ResetTearState(this);
+	}
+
+	RefreshHoleMask();
+
+	// 恢复的损伤与新断裂一样在帧末应用到布料模拟
+	if (DamageLoosening.HasPendingUpdate())
+	{
+		if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+		{
+			Subsystem->QueueDamageLoosening(this);
+		}
+		else
+		{
+			ApplyDamageLoosening();
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("Restored %d cloth break holes"), BreakHoles.Num());
 	return true;
 }
 
-void UClothBreakableComponent::GenerateFragmentsAtLocation(const FVector& Location, float Radius, float ImpactForce)
+void UClothBreakableComponent::ClearBreakState()
+{
+	BreakHoles.Reset();
+	RefreshHoleMask();
+	DamageLoosening.Reset(TargetSkeletalMesh);
+
+	// 已断开的边随之恢复，正在扩展的撕裂不再继续
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		Subsystem->ResetTearState(this);
+	}
+}
+
+uint32 UClothBreakableComponent::GetBreakStateMeshKey() const
 {
-	if (!FragmentGenerator || !BreakableSettings)
+	const USkeletalMesh* Mesh = TargetSkeletalMesh ? TargetSkeletalMesh->GetSkeletalMeshAsset() : nullptr;
+	if (!Mesh)
+	{
+		return 0;
+	}
+
+	// 网格体路径加顶点数，重新导入后顶点数变化时旧状态失效
+	uint32 MeshKey = GetTypeHash(Mesh->GetPathName());
+	if (const FSkeletalMeshRenderData* RenderData = Mesh->GetResourceForRendering())
+	{
+		if (RenderData->LODRenderData.Num() > 0)
+		{
+			MeshKey = HashCombine(MeshKey, RenderData->LODRenderData[0].GetNumVertices());
+		}
+	}
+
+	return MeshKey;
+}
+
+void UClothBreakableComponent::SpawnBreakFragments(TConstArrayView<FClothFragmentSpawnParams> Fragments, int32 MaterialID)
+{
+	if (FragmentGenerator && Fragments.Num() > 0)
+	{
+		FragmentGenerator->SpawnFragments(Fragments,
+			UClothFragmentGenerator::ResolveFragmentMaterial(TargetSkeletalMesh, MaterialID), RuntimeSettings.bEnableFragmentPhysics, false,
+			RuntimeSettings.FragmentMass, RuntimeSettings.FragmentLifetime);
+	}
+}
+
+void UClothBreakableComponent::BroadcastBreak(const FVector& Location, float Radius, float ImpactForce, int32 MaterialID)
+{
+	FClothBreakRecord Record;
+	Record.Component = this;
+	Record.SkeletalMeshComponent = TargetSkeletalMesh;
+	Record.Location = Location;
+	Record.Radius = Radius;
+	Record.ImpactForce = ImpactForce;
+	Record.MaterialID = MaterialID;
+
+	OnClothBreakNative.Broadcast(Record);
+
+	// 没有蓝图监听者时不经过反射系统
+	if (OnClothBreak.IsBound())
+	{
+		OnClothBreak.Broadcast(TargetSkeletalMesh, Location, Radius, ImpactForce, MaterialID);
+	}
+
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		Subsystem->AddBreakRecord(Record);
+	}
+}
+
+void UClothBreakableComponent::GenerateFragmentsAtLocation(const FVector& Location, float Radius, float ImpactForce, int32 MaterialID, float FragmentMultiplier,
+	const FVector& Normal)
+{
+	if (!FragmentGenerator)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Cannot generate fragments: fragment generator not initialized"));
 		return;
 	}
 
 	// 确定碎片数量
-	int32 FragmentCount = FMath::RandRange(BreakableSettings->MinFragmentCount, BreakableSettings->MaxFragmentCount);
+	int32 FragmentCount = FMath::RandRange(RuntimeSettings.MinFragmentCount, RuntimeSettings.MaxFragmentCount);
+	FragmentCount = FMath::RoundToInt(FragmentCount * FragmentMultiplier);
+	if (FragmentCount <= 0)
+	{
+		return;
+	}
 
 	// 生成碎片
 	bool bSuccess = FragmentGenerator->GenerateFragmentsFromCloth(TargetSkeletalMesh,
-		Location, Radius, INDEX_NONE, FragmentCount,
-		BreakableSettings->MinFragmentSize, BreakableSettings->MaxFragmentSize);
+		Location, Radius, MaterialID, FragmentCount,
+		RuntimeSettings.MinFragmentSize, RuntimeSettings.MaxFragmentSize, RuntimeSettings.FragmentStrategy, RuntimeSettings.bEnableFragmentPhysics, Normal,
+		RuntimeSettings.FragmentMass, RuntimeSettings.FragmentLifetime);
 
 	if (bSuccess)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Generated %d fragments at location: %s with radius: %f"),
+		UE_LOG(LogTemp, Verbose, TEXT("Generated %d fragments at location: %s with radius: %f"),
 			FragmentCount, *Location.ToString(), Radius);
 	}
 	else
@@ -225,85 +1024,113 @@ void UClothBreakableComponent::GenerateFragmentsAtLocation(const FVector& Locati
 	}
 }
 
-bool UClothBreakableComponent::IsLocationInBreakableRegion(const FVector& Location, int32& OutMaterialID)
+bool UClothBreakableComponent::IsLocationInBreakableRegion(const FVector& Location, int32& OutMaterialID, int32 HitBone)
 {
-	if (!TargetSkeletalMesh || !BreakableSettings)
+	if (!TargetSkeletalMesh)
 	{
 		return false;
 	}
 
-	// 简化实现，实际上需要根据材质ID检查位置是否在可断裂区域内
-	// 这里仅作为占位符
+	// 与子系统使用同一套区域判断，按当前渲染LOD的表面查找
+	const TSharedPtr<const FClothSurfaceUVTable> SurfaceTable = GetSurfaceTable();
+	const FVector3f LocalLocation(TargetSkeletalMesh->GetComponentTransform().InverseTransformPosition(Location));
+	FVector3f SurfaceLocation;
+	return UClothBreakingSubsystem::IsLocationInBreakableRegion(RuntimeSettings, GetSimSnapshot(), SurfaceTable.Get(), GetBindPoseMapping(), LocalLocation,
+		OutMaterialID, SurfaceLocation, HitBone);
+}
 
-	// 在实际实现中，需要:
-	// 1. 将世界空间位置转换为布料空间
-	// 2. 找到最近的布料顶点
-	// 3. 获取该顶点的材质ID
-	// 4. 检查该材质ID是否在可断裂列表中
+bool UClothBreakableComponent::ForceBreakClothAtLocation(FVector WorldLocation, float Radius)
+{
+	FClothBreakAllocationCounter::FScope AllocationScope;
+	ON_SCOPE_EXIT { ReportBreakAllocations(AllocationScope, TEXT("ForceBreakClothAtLocation")); };
 
-	// 临时返回第一个可断裂材质ID（如果有）
-	if (BreakableSettings->BreakableMaterialIDs.Num() > 0)
+	if (!EnsureInitialized() || !TargetSkeletalMesh)
 	{
-		OutMaterialID = BreakableSettings->BreakableMaterialIDs[0];
-		return true;
+		UE_LOG(LogTemp, Warning, TEXT("Cannot break cloth: component not initialized or target mesh invalid"));
+		return false;
 	}
 
-	// 如果没有指定可断裂材质ID，则所有区域都可断裂
-	if (BreakableSettings->BreakableMaterialIDs.Num() == 0)
+	// 使用默认力度
+	float DefaultForce = RuntimeSettings.BreakForceThreshold * 1.5f;
+
+	if (!DispatchBreak(WorldLocation, Radius, DefaultForce))
 	{
-		OutMaterialID = 0;
-		return true;
+		UE_LOG(LogTemp, Warning, TEXT("Cloth break at %s was rejected"), *WorldLocation.ToString());
+		return false;
 	}
 
-	return false;
+	return true;
 }
 
-void UClothBreakableComponent::ForceBreakClothAtLocation(FVector WorldLocation, float Radius)
+void UClothBreakableComponent::ReportBreakAllocations(const FClothBreakAllocationCounter::FScope& Scope, const TCHAR* Context) const
 {
-	if (!bIsInitialized || !TargetSkeletalMesh)
+	if (!FClothBreakAllocationCounter::IsEnabled())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot break cloth: component not initialized or target mesh invalid"));
 		return;
 	}
 
-	int32 MaterialID = INDEX_NONE;
-	if (IsLocationInBreakableRegion(WorldLocation, MaterialID))
+	// 稳定状态下，除保留下来的碎片外，断裂流程不应产生通用堆分配
+	const int32 TransientAllocations = Scope.GetNumTransientAllocations();
+	if (TransientAllocations > 0)
 	{
-		// 使用默认力度
-		float DefaultForce = BreakableSettings ? BreakableSettings->BreakForceThreshold * 1.5f : 1500.0f;
-
-		// 生成碎片
-		GenerateFragmentsAtLocation(WorldLocation, Radius, DefaultForce);
-
-		// 触发事件
-		OnClothBreak.Broadcast(TargetSkeletalMesh, WorldLocation, Radius, DefaultForce, MaterialID);
+		UE_LOG(LogTemp, Warning, TEXT("%s: %d transient heap allocations (kept=%d, arena=%lld bytes)"),
+			Context, TransientAllocations, Scope.GetNumKeptAllocations(), FClothBreakFrameArena::Get().GetFrameBytes());
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Location is not in a breakable region"));
+		UE_LOG(LogTemp, Verbose, TEXT("%s: no transient heap allocations (kept=%d, arena=%lld bytes)"),
+			Context, Scope.GetNumKeptAllocations(), FClothBreakFrameArena::Get().GetFrameBytes());
 	}
 }
 
 void UClothBreakableComponent::SetBreakableMaterialID(int32 MaterialID, bool bBreakable)
 {
-	if (!BreakableSettings)
+	// 在当前生效的列表基础上修改，结果作为本组件的覆盖，不影响共享设置
+	FClothBreakableSettingsOverrides NewOverrides = SettingsOverrides;
+	if (!NewOverrides.bOverride_BreakableMaterialIDs)
 	{
-		return;
+		NewOverrides.bOverride_BreakableMaterialIDs = true;
+		NewOverrides.BreakableMaterialIDs = TArray<int32>(RuntimeSettings.BreakableMaterialIDs);
 	}
 
 	if (bBreakable)
 	{
 		// 添加到可断裂材质ID列表（如果不存在）
-		if (!BreakableSettings->BreakableMaterialIDs.Contains(MaterialID))
+		if (!NewOverrides.BreakableMaterialIDs.Contains(MaterialID))
 		{
-			BreakableSettings->BreakableMaterialIDs.Add(MaterialID);
+			NewOverrides.BreakableMaterialIDs.Add(MaterialID);
 			UE_LOG(LogTemp, Log, TEXT("Added material ID %d to breakable list"), MaterialID);
 		}
 	}
 	else
 	{
 		// 从可断裂材质ID列表中移除
-		BreakableSettings->BreakableMaterialIDs.Remove(MaterialID);
+		NewOverrides.BreakableMaterialIDs.Remove(MaterialID);
 		UE_LOG(LogTemp, Log, TEXT("Removed material ID %d from breakable list"), MaterialID);
 	}
+
+	SetSettingsOverrides(NewOverrides);
+}
+
+void UClothBreakableComponent::SetBreakableSettings(UClothBreakableSettings* NewSettings)
+{
+	BreakableSettings = NewSettings;
+	RefreshRuntimeSettings();
+}
+
+void UClothBreakableComponent::SetSettingsOverrides(const FClothBreakableSettingsOverrides& NewOverrides)
+{
+	SettingsOverrides = NewOverrides;
+	RefreshRuntimeSettings();
+}
+
+void UClothBreakableComponent::RefreshRuntimeSettings()
+{
+	RuntimeSettings.Resolve(BreakableSettings, SettingsOverrides);
+
+	// 子系统中的副本供工作线程读取
+	if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(this))
+	{
+		Subsystem->RefreshComponentSettings(this);
+	}
 }
@@ -6,6 +6,7 @@
 #include "BulletImpactHandler.h"
 #include "ClothingAsset.h"
 #include "ClothingSimulationInteractor.h"
+#include "ClothBreakRegionData.h"
 
 UClothBreakableComponent* UClothBreakableFunctionLibrary::AddClothBreakableToSkeletalMesh(USkeletalMeshComponent* SkeletalMeshComponent)
 {
@@ -72,18 +73,20 @@ bool UClothBreakableFunctionLibrary::SetAllMaterialsBreakable(USkeletalMeshCompo
 
     // 获取布料断裂组件
     UClothBreakableComponent* BreakableComponent = SkeletalMeshComponent->GetOwner()->FindComponentByClass<UClothBreakableComponent>();
-    if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+    if (!BreakableComponent)
     {
         // 如果不存在，则创建一个
         BreakableComponent = AddClothBreakableToSkeletalMesh(SkeletalMeshComponent);
-        if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+        if (!BreakableComponent)
         {
             return false;
         }
     }
 
-    // 清空现有的可断裂材质ID列表
-    BreakableComponent->BreakableSettings->BreakableMaterialIDs.Empty();
+    // 清空现有的可断裂材质ID列表，只覆盖本组件，不修改共享设置
+    FClothBreakableSettingsOverrides Overrides = BreakableComponent->GetSettingsOverrides();
+    Overrides.bOverride_BreakableMaterialIDs = true;
+    Overrides.BreakableMaterialIDs.Empty();
 
     // 获取骨骼网格体的材质数量
     int32 MaterialCount = SkeletalMeshComponent->GetNumMaterials();
@@ -91,9 +94,11 @@ bool UClothBreakableFunctionLibrary::SetAllMaterialsBreakable(USkeletalMeshCompo
     // 将所有材质ID添加到可断裂列表
     for (int32 i = 0; i < MaterialCount; ++i)
     {
-        BreakableComponent->BreakableSettings->BreakableMaterialIDs.Add(i);
+        Overrides.BreakableMaterialIDs.Add(i);
     }
 
+    BreakableComponent->SetSettingsOverrides(Overrides);
+
     UE_LOG(LogTemp, Log, TEXT("Set all %d materials as breakable"), MaterialCount);
 
     return true;
@@ -116,8 +121,7 @@ bool UClothBreakableFunctionLibrary::ForceBreakClothAtLocation(USkeletalMeshComp
     }
 
     // 触发断裂
-    BreakableComponent->ForceBreakClothAtLocation(WorldLocation, Radius);
-    return true;
+    return BreakableComponent->ForceBreakClothAtLocation(WorldLocation, Radius);
 }
 
 bool UClothBreakableFunctionLibrary::SetClothBreakParameters(USkeletalMeshComponent* SkeletalMeshComponent,
@@ -132,22 +136,27 @@ bool UClothBreakableFunctionLibrary::SetClothBreakParameters(USkeletalMeshCompon
 
     // 获取布料断裂组件
     UClothBreakableComponent* BreakableComponent = SkeletalMeshComponent->GetOwner()->FindComponentByClass<UClothBreakableComponent>();
-    if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+    if (!BreakableComponent)
     {
         // 如果不存在，则创建一个
         BreakableComponent = AddClothBreakableToSkeletalMesh(SkeletalMeshComponent);
-        if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+        if (!BreakableComponent)
         {
             return false;
         }
     }
 
-    // 设置参数
-    BreakableComponent->BreakableSettings->BreakForceThreshold = BreakForceThreshold;
-    BreakableComponent->BreakableSettings->MinFragmentCount = FMath::Clamp(MinFragmentCount, 1, 10);
-    BreakableComponent->BreakableSettings->MaxFragmentCount = FMath::Clamp(MaxFragmentCount, MinFragmentCount, 20);
-    BreakableComponent->BreakableSettings->MinFragmentSize = MinFragmentSize;
-    BreakableComponent->BreakableSettings->MaxFragmentSize = MaxFragmentSize;
+    // 设置参数，只覆盖本组件，不修改共享设置
+    FClothBreakableSettingsOverrides Overrides = BreakableComponent->GetSettingsOverrides();
+    Overrides.bOverride_BreakForceThreshold = true;
+    Overrides.BreakForceThreshold = BreakForceThreshold;
+    Overrides.bOverride_FragmentCount = true;
+    Overrides.MinFragmentCount = FMath::Clamp(MinFragmentCount, 1, 10);
+    Overrides.MaxFragmentCount = FMath::Clamp(MaxFragmentCount, MinFragmentCount, 20);
+    Overrides.bOverride_FragmentSize = true;
+    Overrides.MinFragmentSize = MinFragmentSize;
+    Overrides.MaxFragmentSize = MaxFragmentSize;
+    BreakableComponent->SetSettingsOverrides(Overrides);
 
     UE_LOG(LogTemp, Log, TEXT("Set cloth break parameters: Force=%f, Count=[%d, %d], Size=[%f, %f]"),
         BreakForceThreshold, MinFragmentCount, MaxFragmentCount, MinFragmentSize, MaxFragmentSize);
@@ -166,18 +175,21 @@ bool UClothBreakableFunctionLibrary::SetBulletBreakParameters(USkeletalMeshCompo
 
     // 获取布料断裂组件
     UClothBreakableComponent* BreakableComponent = SkeletalMeshComponent->GetOwner()->FindComponentByClass<UClothBreakableComponent>();
-    if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+    if (!BreakableComponent)
     {
         // 如果不存在，则创建一个
         BreakableComponent = AddClothBreakableToSkeletalMesh(SkeletalMeshComponent);
-        if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+        if (!BreakableComponent)
         {
             return false;
         }
     }
 
-    // 设置子弹参数
-    BreakableComponent->BreakableSettings->RadiusMultiplier = FMath::Max(RadiusMultiplier, 0.1f);
+    // 设置子弹参数，只覆盖本组件，不修改共享设置
+    FClothBreakableSettingsOverrides Overrides = BreakableComponent->GetSettingsOverrides();
+    Overrides.bOverride_RadiusMultiplier = true;
+    Overrides.RadiusMultiplier = FMath::Max(RadiusMultiplier, 0.1f);
+    BreakableComponent->SetSettingsOverrides(Overrides);
 
     UE_LOG(LogTemp, Log, TEXT("Set bullet break parameters: RadiusMultiplier=%f"),
         RadiusMultiplier);
@@ -238,20 +250,23 @@ bool UClothBreakableFunctionLibrary::SetFragmentPhysicsParameters(USkeletalMeshC
 
     // 获取布料断裂组件
     UClothBreakableComponent* BreakableComponent = SkeletalMeshComponent->GetOwner()->FindComponentByClass<UClothBreakableComponent>();
-    if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+    if (!BreakableComponent)
     {
         // 如果不存在，则创建一个
         BreakableComponent = AddClothBreakableToSkeletalMesh(SkeletalMeshComponent);
-        if (!BreakableComponent || !BreakableComponent->BreakableSettings)
+        if (!BreakableComponent)
         {
             return false;
         }
     }
 
-    // 设置物理参数
-    BreakableComponent->BreakableSettings->bEnableFragmentPhysics = bEnablePhysics;
-    BreakableComponent->BreakableSettings->FragmentMass = FMath::Max(FragmentMass, 0.1f);
-    BreakableComponent->BreakableSettings->FragmentLifetime = FMath::Max(FragmentLifetime, 0.1f);
+    // 设置物理参数，只覆盖本组件，不修改共享设置
+    FClothBreakableSettingsOverrides Overrides = BreakableComponent->GetSettingsOverrides();
+    Overrides.bOverride_FragmentPhysics = true;
+    Overrides.bEnableFragmentPhysics = bEnablePhysics;
+    Overrides.FragmentMass = FMath::Max(FragmentMass, 0.1f);
+    Overrides.FragmentLifetime = FMath::Max(FragmentLifetime, 0.1f);
+    BreakableComponent->SetSettingsOverrides(Overrides);
 
     UE_LOG(LogTemp, Log, TEXT("Set fragment physics parameters: Enable=%d, Mass=%f, Lifetime=%f"),
         bEnablePhysics, FragmentMass, FragmentLifetime);
@@ -334,3 +349,13 @@ bool UClothBreakableFunctionLibrary::HasCloth(USkeletalMeshComponent* SkeletalMe
 
     return false;
 }
+
+int32 UClothBreakableFunctionLibrary::BakeClothBreakRegionTables(USkeletalMesh* SkeletalMesh)
+{
+#if WITH_EDITOR
+    return UClothBreakRegionUserData::BakeMesh(SkeletalMesh);
+#else
+    UE_LOG(LogTemp, Warning, TEXT("Cloth break region tables can only be baked in the editor"));
+    return 0;
+#endif
+}
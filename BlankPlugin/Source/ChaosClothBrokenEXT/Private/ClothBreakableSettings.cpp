@@ -1,6 +1,9 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ClothBreakableSettings.h"
+#include "ClothBreakConsoleVariables.h"
+
+FOnClothBreakableSettingsChanged UClothBreakableSettings::OnSettingsChanged;
 
 UClothBreakableSettings::UClothBreakableSettings()
 {
@@ -9,10 +12,33 @@ UClothBreakableSettings::UClothBreakableSettings()
 
 	// 子弹相关默认值
 	RadiusMultiplier = 2.0f;
+	DefaultBulletProfile = nullptr;
+
+	// 穿透相关默认值
+	bEnablePenetration = false;
+	MaxPenetrationDepth = 60.0f;
+	MaxPenetrationLayers = 4;
+	PenetrationEnergyRetention = 0.6f;
+
+	// 撕裂相关默认值
+	bEnableTearPropagation = false;
+	TearStrainThreshold = 0.15f;
+	MaxTearStepsPerFrame = 8;
+	MaxTearLength = 256;
+	bLoosenClothOnDamage = false;
+	DamageLooseness = 1.0f;
+
+	// 破洞遮罩默认值
+	bEnableHoleMask = false;
+	FullBreakCameraDistance = 1500.0f;
+
+	// LOD相关默认值
+	MaxFullBreakLOD = 1;
 
 	// 碎片相关默认值
 	MinFragmentCount = 3;
 	MaxFragmentCount = 7;
+	FragmentStrategy = EClothFragmentStrategy::SphereDebris;
 	MinFragmentSize = 5.0f;
 	MaxFragmentSize = 20.0f;
 	FragmentLifetime = 5.0f;
@@ -21,3 +47,95 @@ UClothBreakableSettings::UClothBreakableSettings()
 	bEnableFragmentPhysics = true;
 	FragmentMass = 1.0f;
 }
+
+void UClothBreakableSettings::NotifySettingsChanged()
+{
+	++Revision;
+	OnSettingsChanged.Broadcast(this);
+}
+
+#if WITH_EDITOR
+void UClothBreakableSettings::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// 通知运行中的组件重建运行时设置，所有引用该资产的角色一起生效
+	++Revision;
+	OnSettingsChanged.Broadcast(this);
+}
+#endif
+
+void FClothBreakableRuntimeSettings::Resolve(const UClothBreakableSettings* Settings, const FClothBreakableSettingsOverrides& Overrides)
+{
+	if (!Settings)
+	{
+		Settings = GetDefault<UClothBreakableSettings>();
+	}
+
+	Source = Settings;
+
+	BreakForceThreshold = Overrides.bOverride_BreakForceThreshold ? Overrides.BreakForceThreshold : Settings->BreakForceThreshold;
+	RadiusMultiplier = Overrides.bOverride_RadiusMultiplier ? Overrides.RadiusMultiplier : Settings->RadiusMultiplier;
+	BreakableMaterialIDs.Reset();
+	BreakableMaterialIDs.Append(Overrides.bOverride_BreakableMaterialIDs ? Overrides.BreakableMaterialIDs : Settings->BreakableMaterialIDs);
+
+	if (Overrides.bOverride_FragmentCount)
+	{
+		MinFragmentCount = Overrides.MinFragmentCount;
+		MaxFragmentCount = Overrides.MaxFragmentCount;
+	}
+	else
+	{
+		MinFragmentCount = Settings->MinFragmentCount;
+		MaxFragmentCount = Settings->MaxFragmentCount;
+	}
+
+	if (Overrides.bOverride_FragmentSize)
+	{
+		MinFragmentSize = Overrides.MinFragmentSize;
+		MaxFragmentSize = Overrides.MaxFragmentSize;
+	}
+	else
+	{
+		MinFragmentSize = Settings->MinFragmentSize;
+		MaxFragmentSize = Settings->MaxFragmentSize;
+	}
+
+	if (Overrides.bOverride_FragmentPhysics)
+	{
+		bEnableFragmentPhysics = Overrides.bEnableFragmentPhysics;
+		FragmentMass = Overrides.FragmentMass;
+		FragmentLifetime = Overrides.FragmentLifetime;
+	}
+	else
+	{
+		bEnableFragmentPhysics = Settings->bEnableFragmentPhysics;
+		FragmentMass = Settings->FragmentMass;
+		FragmentLifetime = Settings->FragmentLifetime;
+	}
+
+	FragmentStrategy = Settings->FragmentStrategy;
+	bEnablePenetration = Settings->bEnablePenetration;
+	MaxPenetrationDepth = Settings->MaxPenetrationDepth;
+	MaxPenetrationLayers = Settings->MaxPenetrationLayers;
+	PenetrationEnergyRetention = Settings->PenetrationEnergyRetention;
+
+	bEnableTearPropagation = Settings->bEnableTearPropagation;
+	TearStrainThreshold = Settings->TearStrainThreshold;
+	MaxTearStepsPerFrame = FMath::Max(Settings->MaxTearStepsPerFrame, 1);
+	MaxTearLength = FMath::Max(Settings->MaxTearLength, 1);
+	bLoosenClothOnDamage = Settings->bLoosenClothOnDamage;
+	DamageLooseness = FMath::Clamp(Settings->DamageLooseness, 0.0f, 1.0f);
+
+	bEnableHoleMask = Settings->bEnableHoleMask;
+	FullBreakCameraDistance = Settings->FullBreakCameraDistance;
+	MaxFullBreakLOD = FMath::Max(Settings->MaxFullBreakLOD, 0);
+
+	// 保证区间有效，之后的读取无需再检查
+	MaxFragmentCount = FMath::Max(MaxFragmentCount, MinFragmentCount);
+	MaxFragmentSize = FMath::Max(MaxFragmentSize, MinFragmentSize);
+
+	// 全局控制台变量优先于设置资产和实例覆盖
+	bEnableFragments = true;
+	ClothBreakCVars::ApplyOverrides(*this);
+}
@@ -0,0 +1,1985 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothBreakingSubsystem.h"
+#include "ClothBreakableComponent.h"
+#include "ClothBreakableSettings.h"
+#include "BulletImpactHandler.h"
+#include "ClothBreakFrameArena.h"
+#include "ClothBreakMemory.h"
+#include "ClothBreakConsoleVariables.h"
+#include "ClothFragmentAssetCache.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/SkinnedAssetCommon.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "ClothingAsset.h"
+#include "ClothingSystemRuntimeTypes.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace
+{
+	// 命中点与模拟粒子的最大距离，超出时认为没有命中布料，与表面查找表的网格单元一致
+	constexpr float SimSurfaceTolerance = 10.0f;
+
+	// 内存预算的检查间隔（秒）
+	constexpr float MemoryCheckInterval = 1.0f;
+
+	// 每次预算检查重新统计的组件数量，其余组件沿用上次的统计，完整遍历只在ClothBreak.MemReport中进行
+	constexpr int32 MemoryCheckComponentsPerPass = 32;
+
+	// 每帧预热的时间预算（毫秒），超出后顺延到下一帧，每帧至少执行一步
+	constexpr float PrewarmBudgetMs = 1.0f;
+
+	// 每个组件最多排队的碎片工作项，超出时丢弃最早的碎片
+	constexpr int32 MaxQueuedDebrisPerComponent = 4;
+
+	// 最多暂存的断裂状态数量，永久卸载的关卡不会再取回暂存的状态
+	constexpr int32 MaxStashedBreakStates = 512;
+
+	// 所有组件同时扩展的撕裂数量上限，超出后新的破洞不再撕裂
+	constexpr int32 MaxActiveTears = 32;
+
+	// 每批并行推进撕裂的组件数量，每批之后检查帧预算
+	constexpr int32 TearBatchSize = 8;
+
+	/**
+	 * 布料资产在某个渲染LOD上对应的材质槽位，与表面查找表一样按LOD的材质映射换算
+	 * 一个布料资产在每个LOD只绑定一个渲染片段，它的所有边都属于这个材质
+	 * @return 材质槽位，该LOD没有绑定这个布料资产时返回INDEX_NONE
+	 */
+	int32 GetClothingAssetMaterialID(const USkeletalMesh& Mesh, int32 MeshLOD, int32 ClothingAssetIndex)
+	{
+		const FSkeletalMeshRenderData* RenderData = Mesh.GetResourceForRendering();
+		if (!RenderData || !RenderData->LODRenderData.IsValidIndex(MeshLOD))
+		{
+			return INDEX_NONE;
+		}
+
+		const FSkeletalMeshLODInfo* LODInfo = Mesh.GetLODInfo(MeshLOD);
+		const FSkeletalMeshLODRenderData& LODData = RenderData->LODRenderData[MeshLOD];
+		for (int32 SectionIndex = 0; SectionIndex < LODData.RenderSections.Num(); ++SectionIndex)
+		{
+			const FSkelMeshRenderSection& RenderSection = LODData.RenderSections[SectionIndex];
+			if (!RenderSection.HasClothingData() || RenderSection.CorrespondClothAssetIndex != ClothingAssetIndex)
+			{
+				continue;
+			}
+
+			if (LODInfo && LODInfo->LODMaterialMap.IsValidIndex(SectionIndex) && LODInfo->LODMaterialMap[SectionIndex] != INDEX_NONE)
+			{
+				return LODInfo->LODMaterialMap[SectionIndex];
+			}
+			return RenderSection.MaterialIndex;
+		}
+
+		return INDEX_NONE;
+	}
+
+	// 穿透记录的有效帧数，子弹在这段时间内穿过扫描深度内的各层，之后同一子弹（例如对象池复用）可以再次击穿
+	constexpr uint64 PenetrationRecordFrames = 4;
+}
+
+namespace ClothBreakMemoryCommands
+{
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice MemReportCommand(
+		TEXT("ClothBreak.MemReport"),
+		TEXT("Dump estimated cloth break memory per mesh and per component, with live fragment counts."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(World))
+			{
+				Subsystem->ReportMemory(&Ar);
+			}
+		}));
+}
+
+namespace ClothBreakStress
+{
+	static FAutoConsoleCommandWithWorldAndArgs StressCommand(
+		TEXT("ClothBreak.Stress"),
+		TEXT("Fire randomized SimulateBulletImpact calls at every registered component and log throughput and frame times. ")
+		TEXT("Usage: ClothBreak.Stress <ImpactsPerSecond> <Seconds>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(World);
+			if (!Subsystem)
+			{
+				return;
+			}
+
+			if (Args.Num() < 2)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Usage: ClothBreak.Stress <ImpactsPerSecond> <Seconds>"));
+				return;
+			}
+
+			Subsystem->StartStressTest(FCString::Atof(*Args[0]), FCString::Atof(*Args[1]));
+		}));
+}
+
+namespace ClothBreakReplay
+{
+	static FString GetFilenameArg(const TArray<FString>& Args)
+	{
+		return Args.Num() > 0 ? Args[0] : FString();
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs StartRecordingCommand(
+		TEXT("ClothBreak.Record.Start"),
+		TEXT("Start recording every impact entering the cloth break pipeline."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(World))
+			{
+				Subsystem->StartImpactRecording();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StopRecordingCommand(
+		TEXT("ClothBreak.Record.Stop"),
+		TEXT("Stop recording and save the impacts. Usage: ClothBreak.Record.Stop [Filename]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(World))
+			{
+				Subsystem->StopImpactRecording(GetFilenameArg(Args));
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs ReplayCommand(
+		TEXT("ClothBreak.Replay"),
+		TEXT("Replay recorded impacts and log frame time, fragment and allocation totals. ")
+		TEXT("Usage: ClothBreak.Replay [Filename] [max]. Runs headless with -nullrhi -ExecCmds."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UClothBreakingSubsystem* Subsystem = UClothBreakingSubsystem::Get(World))
+			{
+				const bool bMaxSpeed = Args.Num() > 1 && Args[1].Equals(TEXT("max"), ESearchCase::IgnoreCase);
+				Subsystem->StartImpactReplay(GetFilenameArg(Args), bMaxSpeed);
+			}
+		}));
+}
+
+UClothBreakingSubsystem* UClothBreakingSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UClothBreakingSubsystem>() : nullptr;
+}
+
+bool UClothBreakingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UClothBreakingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SettingsChangedHandle = UClothBreakableSettings::OnSettingsChanged.AddUObject(this, &UClothBreakingSubsystem::HandleSettingsChanged);
+}
+
+void UClothBreakingSubsystem::Deinitialize()
+{
+	UClothBreakableSettings::OnSettingsChanged.Remove(SettingsChangedHandle);
+
+	for (const FClothBreakableRuntimeState& State : States)
+	{
+		if (UClothBreakableComponent* Component = State.Component.Get())
+		{
+			Component->RuntimeStateIndex = INDEX_NONE;
+		}
+	}
+
+	States.Empty();
+	TrackedComponentBytes = 0;
+	MemoryCheckCursor = 0;
+	PendingImpacts.Empty();
+	UninitializedComponents.Empty();
+	PenetratedLayers.Empty();
+	StashedBreakStates.Empty();
+	TearGraphs.Empty();
+	TearingComponents.Empty();
+	NumActiveTears = 0;
+	TearCursor = 0;
+	LooseningComponents.Empty();
+	RecordingComponentIndices.Empty();
+	ReplayComponents.Empty();
+	Recording.Reset();
+	Replay.Reset();
+	FragmentPool.Empty();
+	BreakRecords.Empty();
+	PrewarmSteps.Empty();
+	PrewarmStepHead = 0;
+	PrewarmedMeshes.Empty();
+	RequestedPrewarmPaths.Empty();
+	PrewarmedTables.Empty();
+	NumPendingPrewarmLoads = 0;
+	bPhysicsSpawnPrewarmQueued = false;
+	bStaticSpawnPrewarmQueued = false;
+	for (const TSharedPtr<FStreamableHandle>& Handle : PrewarmLoadHandles)
+	{
+		Handle->CancelHandle();
+	}
+	PrewarmLoadHandles.Empty();
+	if (PrewarmGenerator)
+	{
+		PrewarmGenerator->DestroyAllFragments();
+		PrewarmGenerator = nullptr;
+	}
+	for (int32 TypeIndex = 0; TypeIndex < (int32)EClothBreakWorkType::Count; ++TypeIndex)
+	{
+		WorkQueues[TypeIndex].Empty();
+		WorkQueueHeads[TypeIndex] = 0;
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UClothBreakingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClothBreakingSubsystem, STATGROUP_Tickables);
+}
+
+void UClothBreakingSubsystem::RegisterComponent(UClothBreakableComponent* Component)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Subsystem);
+
+	if (!Component || Component->RuntimeStateIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	Component->RuntimeStateIndex = States.Num();
+	FClothBreakableRuntimeState& State = States.AddDefaulted_GetRef();
+	State.Component = Component;
+	State.Settings = Component->GetRuntimeSettings();
+
+	if (Component->TryInitialize())
+	{
+		HandleComponentInitialized(Component);
+	}
+	else
+	{
+		UninitializedComponents.Add(Component);
+	}
+}
+
+void UClothBreakingSubsystem::UnregisterComponent(UClothBreakableComponent* Component)
+{
+	if (!Component || !States.IsValidIndex(Component->RuntimeStateIndex))
+	{
+		return;
+	}
+
+	const int32 RemovedIndex = Component->RuntimeStateIndex;
+	const int32 LastIndex = States.Num() - 1;
+
+	// 丢弃该组件排队的冲击，并修正被移动状态的索引
+	PendingImpacts.RemoveAllSwap([RemovedIndex](const FClothBreakImpact& Impact)
+	{
+		return Impact.StateIndex == RemovedIndex;
+	});
+
+	if (RemovedIndex != LastIndex)
+	{
+		for (FClothBreakImpact& Impact : PendingImpacts)
+		{
+			if (Impact.StateIndex == LastIndex)
+			{
+				Impact.StateIndex = RemovedIndex;
+			}
+		}
+
+		if (UClothBreakableComponent* MovedComponent = States[LastIndex].Component.Get())
+		{
+			MovedComponent->RuntimeStateIndex = RemovedIndex;
+		}
+	}
+
+	TrackedComponentBytes -= States[RemovedIndex].MemoryBytes;
+	States.RemoveAtSwap(RemovedIndex);
+	UninitializedComponents.RemoveSwap(Component);
+	Component->RuntimeStateIndex = INDEX_NONE;
+}
+
+void UClothBreakingSubsystem::StashBreakState(const UClothBreakableComponent* Component)
+{
+	if (!Component || Component->GetNumBreakHoles() == 0)
+	{
+		return;
+	}
+
+	FClothBreakStashedState Stashed;
+	if (!Component->SaveBreakState(Stashed.Data))
+	{
+		return;
+	}
+
+	// 超出上限时丢弃最早暂存的状态，只在满时遍历一次
+	FString PathName = Component->GetPathName();
+	if (StashedBreakStates.Num() >= MaxStashedBreakStates && !StashedBreakStates.Contains(PathName))
+	{
+		const FString* OldestPath = nullptr;
+		double OldestTime = TNumericLimits<double>::Max();
+		for (const TPair<FString, FClothBreakStashedState>& Pair : StashedBreakStates)
+		{
+			if (Pair.Value.StashTime < OldestTime)
+			{
+				OldestTime = Pair.Value.StashTime;
+				OldestPath = &Pair.Key;
+			}
+		}
+
+		if (OldestPath)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Too many stashed cloth break states, dropping %s"), **OldestPath);
+			StashedBreakStates.Remove(FString(*OldestPath));
+		}
+	}
+
+	Stashed.StashTime = FPlatformTime::Seconds();
+	StashedBreakStates.Add(MoveTemp(PathName), MoveTemp(Stashed));
+}
+
+bool UClothBreakingSubsystem::RestoreStashedBreakState(UClothBreakableComponent* Component)
+{
+	if (!Component || StashedBreakStates.Num() == 0)
+	{
+		return false;
+	}
+
+	FClothBreakStashedState Stashed;
+	if (!StashedBreakStates.RemoveAndCopyValue(Component->GetPathName(), Stashed))
+	{
+		return false;
+	}
+
+	return Component->RestoreBreakState(Stashed.Data);
+}
+
+void UClothBreakingSubsystem::RefreshComponentSettings(UClothBreakableComponent* Component)
+{
+	if (Component && States.IsValidIndex(Component->RuntimeStateIndex))
+	{
+		States[Component->RuntimeStateIndex].Settings = Component->GetRuntimeSettings();
+	}
+}
+
+void UClothBreakingSubsystem::HandleSettingsChanged(const UClothBreakableSettings* Settings)
+{
+	for (const FClothBreakableRuntimeState& State : States)
+	{
+		UClothBreakableComponent* Component = State.Component.Get();
+		if (Component && (!Settings || Component->GetRuntimeSettings().Source == Settings))
+		{
+			// 组件重建后会回调RefreshComponentSettings
+			Component->RefreshRuntimeSettings();
+		}
+	}
+}
+
+bool UClothBreakingSubsystem::QueueImpact(UClothBreakableComponent* Component, const FVector& Location, float Radius, float Force,
+	float FragmentMultiplier, const FVector& Normal, int32 HitBone)
+{
+	return QueueImpactWithSeed(Component, Location, Radius, Force, FragmentMultiplier, FMath::Rand(), Normal, HitBone);
+}
+
+bool UClothBreakingSubsystem::QueueImpactWithSeed(UClothBreakableComponent* Component, const FVector& Location, float Radius, float Force,
+	float FragmentMultiplier, int32 Seed, const FVector& Normal, int32 HitBone)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Subsystem);
+
+	if (!Component || !Component->IsBreakableInitialized() || !States.IsValidIndex(Component->RuntimeStateIndex))
+	{
+		return false;
+	}
+
+	FClothBreakImpact& Impact = PendingImpacts.AddDefaulted_GetRef();
+	Impact.StateIndex = Component->RuntimeStateIndex;
+	Impact.Location = Location;
+	Impact.Normal = Normal;
+	Impact.Radius = Radius;
+	Impact.Force = Force;
+	Impact.HitBone = HitBone;
+	Impact.FragmentMultiplier = FragmentMultiplier;
+	Impact.Seed = Seed;
+
+	return true;
+}
+
+int32 UClothBreakingSubsystem::QueuePenetratingImpact(UClothBreakableComponent* EntryComponent, const FHitResult& HitResult,
+	const FBulletImpactParams& Params)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Subsystem);
+
+	if (!EntryComponent || !EntryComponent->TargetSkeletalMesh)
+	{
+		return 0;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::QueuePenetratingImpact);
+
+	UWorld* World = GetWorld();
+	const AActor* Projectile = HitResult.GetActor();
+	const FClothBreakableRuntimeSettings& EntrySettings = EntryComponent->GetRuntimeSettings();
+	const FVector Direction = UBulletImpactHandler::CalculateBulletDirection(HitResult);
+
+	// 入口层始终是第一层，之后按弹道上的距离排列
+	TArray<TPair<UClothBreakableComponent*, FVector>, TInlineAllocator<8>> Layers;
+	Layers.Emplace(EntryComponent, Params.Location);
+
+	if (World && !Direction.IsNearlyZero())
+	{
+		// 按对象类型扫描会返回弹道上所有的命中，不会在第一个阻挡处停止
+		FCollisionObjectQueryParams ObjectParams(EntryComponent->TargetSkeletalMesh->GetCollisionObjectType());
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClothBreakPenetration), false, Projectile);
+
+		const FVector SweepStart = Params.Location - Direction;
+		const FVector SweepEnd = Params.Location + Direction * EntrySettings.MaxPenetrationDepth;
+
+		TArray<FHitResult, TInlineAllocator<16>> Hits;
+		World->SweepMultiByObjectType(Hits, SweepStart, SweepEnd, FQuat::Identity, ObjectParams,
+			FCollisionShape::MakeSphere(1.0f), QueryParams);
+		Hits.Sort([](const FHitResult& A, const FHitResult& B) { return A.Distance < B.Distance; });
+
+		for (const FHitResult& Hit : Hits)
+		{
+			if (Layers.Num() >= EntrySettings.MaxPenetrationLayers)
+			{
+				break;
+			}
+
+			// 同一布料层可能有多个物理体被命中，只取最近的一个
+			AActor* HitActor = Hit.GetActor();
+			UPrimitiveComponent* HitComponent = Hit.GetComponent();
+			if (!HitActor || !HitComponent)
+			{
+				continue;
+			}
+
+			TInlineComponentArray<UClothBreakableComponent*> BreakableComponents(HitActor);
+			for (UClothBreakableComponent* Layer : BreakableComponents)
+			{
+				if (Layer->TargetSkeletalMesh == HitComponent
+					&& !Layers.ContainsByPredicate([Layer](const TPair<UClothBreakableComponent*, FVector>& Entry) { return Entry.Key == Layer; }))
+				{
+					Layers.Emplace(Layer, Hit.ImpactPoint);
+				}
+			}
+		}
+	}
+
+	// 沿弹道衰减能量，所有层在同一帧内一起处理
+	float RemainingForce = Params.ImpactForce;
+	int32 NumQueued = 0;
+	// 每次扫描都是新的一枪，覆盖该子弹之前的记录
+	FClothBreakPenetrationRecord& Record = PenetratedLayers.FindOrAdd(Projectile);
+	Record.FrameNumber = GFrameCounter;
+	Record.Layers.Reset();
+	TArray<TWeakObjectPtr<const UClothBreakableComponent>, TInlineAllocator<4>>& HandledLayers = Record.Layers;
+
+	for (const TPair<UClothBreakableComponent*, FVector>& Layer : Layers)
+	{
+		UClothBreakableComponent* LayerComponent = Layer.Key;
+		const FClothBreakableRuntimeSettings& LayerSettings = LayerComponent->GetRuntimeSettings();
+		HandledLayers.AddUnique(LayerComponent);
+
+		if (RemainingForce < LayerSettings.BreakForceThreshold)
+		{
+			// 子弹停在这一层
+			UE_LOG(LogTemp, Verbose, TEXT("Bullet stopped at cloth layer %s (force %f below threshold %f)"),
+				*LayerComponent->GetName(), RemainingForce, LayerSettings.BreakForceThreshold);
+			break;
+		}
+
+		// 剩余能量越少，破洞越小
+		const float EnergyRatio = Params.ImpactForce > 0.0f ? RemainingForce / Params.ImpactForce : 1.0f;
+		const float LayerRadius = FMath::Max(Params.BreakRadius * FMath::Sqrt(EnergyRatio), 1.0f);
+
+		// 入口层使用命中法线和命中骨骼，内层近似为迎着弹道，按关节距离确定骨骼
+		const bool bEntryLayer = LayerComponent == Layers[0].Key;
+		const FVector LayerNormal = bEntryLayer ? Params.Normal : -Direction;
+		const int32 LayerHitBone = bEntryLayer ? LayerComponent->FindHitBone(Params.BoneName) : INDEX_NONE;
+		if (QueueImpact(LayerComponent, Layer.Value, LayerRadius, RemainingForce, Params.FragmentMultiplier, LayerNormal, LayerHitBone))
+		{
+			++NumQueued;
+		}
+
+		RemainingForce *= LayerSettings.PenetrationEnergyRetention;
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("Penetrating impact queued %d of %d cloth layers"), NumQueued, Layers.Num());
+
+	return NumQueued;
+}
+
+bool UClothBreakingSubsystem::WasPenetratedBy(const UClothBreakableComponent* Component, const AActor* Projectile) const
+{
+	const FClothBreakPenetrationRecord* Record = Projectile ? PenetratedLayers.Find(Projectile) : nullptr;
+	return Record && GFrameCounter - Record->FrameNumber <= PenetrationRecordFrames && Record->Layers.Contains(Component);
+}
+
+bool UClothBreakingSubsystem::IsLocationInBreakableRegion(const FClothBreakableRuntimeSettings& Settings, const FClothSimSnapshot* SimSnapshot,
+	const FClothSurfaceUVTable* SurfaceTable, const FClothBindPoseMapping* BindPose, const FVector3f& LocalLocation,
+	int32& OutMaterialID, FVector3f& OutSurfaceLocation, int32 HitBone)
+{
+	OutSurfaceLocation = LocalLocation;
+
+	// 命中点靠近模拟中的布料时，按实际的布料形状确定区域和表面位置
+	int32 Particle = INDEX_NONE;
+	const FClothSimSnapshotSection* Section = SimSnapshot ? SimSnapshot->FindNearestParticle(LocalLocation, SimSurfaceTolerance, Particle) : nullptr;
+	if (Section && Section->MaterialID != INDEX_NONE)
+	{
+		OutMaterialID = Section->MaterialID;
+		OutSurfaceLocation = FVector3f(Section->ComponentRelativeTransform.TransformPosition(FVector(Section->Positions[Particle])));
+		return Settings.BreakableMaterialIDs.Num() == 0 || Settings.BreakableMaterialIDs.Contains(OutMaterialID);
+	}
+
+	// 查找表为参考姿势，先通过骨骼和蒙皮权重把命中点映射回参考姿势，再按最近的顶点确定命中的材质区域
+	const FVector3f BindPoseLocation = SurfaceTable && BindPose ? SurfaceTable->ToBindPose(LocalLocation, *BindPose, HitBone) : LocalLocation;
+	const int32 Vertex = SurfaceTable ? SurfaceTable->FindNearestVertex(BindPoseLocation, INDEX_NONE) : INDEX_NONE;
+	if (Vertex != INDEX_NONE)
+	{
+		OutMaterialID = SurfaceTable->MaterialIndices[Vertex];
+		return Settings.BreakableMaterialIDs.Num() == 0 || Settings.BreakableMaterialIDs.Contains(OutMaterialID);
+	}
+
+	// 模拟粒子和表面顶点都不在附近，命中点不在布料上
+	OutMaterialID = INDEX_NONE;
+	if (SurfaceTable)
+	{
+		return false;
+	}
+
+	// 没有任何表面数据时无法确定命中的材质：限定了可断裂材质时拒绝，未限定时所有区域都可断裂
+	return Settings.BreakableMaterialIDs.Num() == 0;
+}
+
+void UClothBreakingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LLM_SCOPE_BYTAG(ClothBreak_Subsystem);
+
+	// 回放和压力测试统计整个Tick，包括没有冲击而提前返回的帧
+	const double TickStartSeconds = FPlatformTime::Seconds();
+	FClothBreakAllocationCounter::FScope AllocationScope;
+	ON_SCOPE_EXIT
+	{
+		const double TickMs = (FPlatformTime::Seconds() - TickStartSeconds) * 1000.0;
+		if (Replay)
+		{
+			ReplayStats.TotalTickMs += TickMs;
+			ReplayStats.MaxTickMs = FMath::Max(ReplayStats.MaxTickMs, TickMs);
+			ReplayStats.NumAllocations += AllocationScope.GetNumAllocations();
+		}
+		if (IsStressTesting())
+		{
+			StressStats.TotalTickMs += TickMs;
+			StressStats.MaxTickMs = FMath::Max(StressStats.MaxTickMs, TickMs);
+		}
+	};
+
+	MemoryCheckElapsed += DeltaTime;
+	if (MemoryCheckElapsed >= MemoryCheckInterval)
+	{
+		MemoryCheckElapsed = 0.0f;
+		CheckMemoryBudget();
+	}
+
+	if (UninitializedComponents.Num() > 0)
+	{
+		InitializePendingComponents();
+	}
+
+	if (PrewarmStepHead < PrewarmSteps.Num())
+	{
+		ProcessPrewarmSteps(FPlatformTime::Seconds() + PrewarmBudgetMs * 0.001);
+	}
+
+	if (Replay)
+	{
+		FeedReplayImpacts();
+	}
+
+	if (IsStressTesting())
+	{
+		FeedStressImpacts(DeltaTime);
+	}
+
+	// 子弹销毁后不会再触发碰撞回调，失效的记录也不再需要
+	for (auto It = PenetratedLayers.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || GFrameCounter - It.Value().FrameNumber > PenetrationRecordFrames)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (PendingImpacts.Num() == 0 && GetNumPendingWorkItems() == 0 && TearingComponents.Num() == 0)
+	{
+		if (Replay && ReplayCursor >= Replay->Impacts.Num())
+		{
+			FinishImpactReplay();
+		}
+		// 同步路径（未经过工作队列）产生的断裂也在这里派发
+		if (BreakRecords.Num() > 0)
+		{
+			FlushBreakRecords();
+		}
+		if (LooseningComponents.Num() > 0)
+		{
+			FlushDamageLoosening();
+		}
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::Tick);
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	if (PendingImpacts.Num() > 0)
+	{
+		// 取出本帧的冲击，应用阶段中新产生的冲击留到下一帧处理
+		TClothFrameArray<FClothBreakImpact> Impacts;
+		Impacts.Append(PendingImpacts);
+		PendingImpacts.Reset();
+
+		// 按角色分组，同一角色的冲击保持原有顺序
+		Algo::StableSortBy(Impacts, &FClothBreakImpact::StateIndex);
+
+		TClothFrameArray<FClothBreakResult> Results;
+		Results.SetNum(Impacts.Num());
+
+		TClothFrameArray<FClothFragmentSpawnParams> Fragments;
+		Fragments.SetNum(Impacts.Num() * UClothFragmentGenerator::MaxFragmentsPerBreak);
+
+		PrepareStatesForResolve(Impacts);
+		ResolveImpacts(Impacts, Results, Fragments);
+		EnqueueResults(Impacts, Results, Fragments);
+
+		// 快照和骨骼映射归组件所有，只在本帧解析期间引用
+		for (const FClothBreakImpact& Impact : Impacts)
+		{
+			States[Impact.StateIndex].SimSnapshot = nullptr;
+			States[Impact.StateIndex].BindPose = nullptr;
+		}
+	}
+
+	const float BudgetMs = GetFrameBudgetMs();
+	const double DeadlineSeconds = BudgetMs > 0.0f ? StartSeconds + BudgetMs * 0.001 : DBL_MAX;
+	ProcessWorkItems(DeadlineSeconds);
+
+	// 撕裂与工作项共用本帧预算
+	if (TearingComponents.Num() > 0)
+	{
+		AdvanceTears(DeadlineSeconds);
+	}
+
+	// 本帧所有破洞处理完后再更新布料模拟，多个破洞合并为一次
+	if (LooseningComponents.Num() > 0)
+	{
+		FlushDamageLoosening();
+	}
+
+	if (BreakRecords.Num() > 0)
+	{
+		FlushBreakRecords();
+	}
+}
+
+void UClothBreakingSubsystem::StartImpactRecording()
+{
+	Recording = MakeUnique<FClothBreakImpactRecording>();
+	RecordingComponentIndices.Reset();
+	RecordingStartFrame = GFrameCounter;
+	RecordingStartTime = GetWorld()->GetTimeSeconds();
+
+	UE_LOG(LogTemp, Log, TEXT("Started recording cloth impacts"));
+}
+
+bool UClothBreakingSubsystem::StopImpactRecording(const FString& Filename)
+{
+	if (!Recording)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cloth impact recording is not running"));
+		return false;
+	}
+
+	const TUniquePtr<FClothBreakImpactRecording> FinishedRecording = MoveTemp(Recording);
+	RecordingComponentIndices.Reset();
+
+	return FinishedRecording->SaveToFile(Filename.IsEmpty() ? FClothBreakImpactRecording::GetDefaultFilename() : Filename);
+}
+
+bool UClothBreakingSubsystem::StartImpactReplay(const FString& Filename, bool bMaxSpeed)
+{
+	TUniquePtr<FClothBreakImpactRecording> NewReplay = MakeUnique<FClothBreakImpactRecording>();
+	if (!NewReplay->LoadFromFile(Filename.IsEmpty() ? FClothBreakImpactRecording::GetDefaultFilename() : Filename))
+	{
+		return false;
+	}
+
+	// 按名称找到当前世界中对应的组件
+	TMap<FString, UClothBreakableComponent*> ComponentsByName;
+	for (const FClothBreakableRuntimeState& State : States)
+	{
+		if (UClothBreakableComponent* Component = State.Component.Get())
+		{
+			ComponentsByName.Add(FClothBreakImpactRecording::GetComponentName(Component), Component);
+		}
+	}
+
+	ReplayComponents.Reset(NewReplay->ComponentNames.Num());
+	int32 NumMissing = 0;
+	for (const FString& Name : NewReplay->ComponentNames)
+	{
+		UClothBreakableComponent* const* Component = ComponentsByName.Find(Name);
+		ReplayComponents.Add(Component ? *Component : nullptr);
+		NumMissing += Component ? 0 : 1;
+	}
+
+	if (NumMissing > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cloth impact replay: %d of %d recorded components not found, their impacts are skipped"),
+			NumMissing, NewReplay->ComponentNames.Num());
+	}
+
+	Replay = MoveTemp(NewReplay);
+	ReplayCursor = 0;
+	ReplayStartTime = GetWorld()->GetTimeSeconds();
+	bReplayMaxSpeed = bMaxSpeed;
+	ReplayStats = FClothBreakReplayStats();
+
+	UE_LOG(LogTemp, Log, TEXT("Started replaying %d cloth impacts (%s)"),
+		Replay->Impacts.Num(), bMaxSpeed ? TEXT("max speed") : TEXT("recorded speed"));
+	return true;
+}
+
+void UClothBreakingSubsystem::RecordImpact(const FClothBreakImpact& Impact, const FClothBreakResult& Result)
+{
+	UClothBreakableComponent* Component = States.IsValidIndex(Impact.StateIndex) ? States[Impact.StateIndex].Component.Get() : nullptr;
+	if (!Component || !Component->TargetSkeletalMesh)
+	{
+		return;
+	}
+
+	const uint16* ComponentIndex = RecordingComponentIndices.Find(Component);
+	if (!ComponentIndex)
+	{
+		if (Recording->ComponentNames.Num() > MAX_uint16)
+		{
+			return;
+		}
+
+		const uint16 NewIndex = (uint16)Recording->ComponentNames.Add(FClothBreakImpactRecording::GetComponentName(Component));
+		ComponentIndex = &RecordingComponentIndices.Add(Component, NewIndex);
+	}
+
+	FClothBreakRecordedImpact& Recorded = Recording->Impacts.AddDefaulted_GetRef();
+	Recorded.Frame = (uint32)(GFrameCounter - RecordingStartFrame);
+	Recorded.Time = (float)(GetWorld()->GetTimeSeconds() - RecordingStartTime);
+	Recorded.ComponentIndex = *ComponentIndex;
+	const FTransform& ComponentTransform = Component->TargetSkeletalMesh->GetComponentTransform();
+	Recorded.LocalLocation = FVector3f(ComponentTransform.InverseTransformPosition(Impact.Location));
+	Recorded.LocalNormal = FVector3f(ComponentTransform.InverseTransformVectorNoScale(Impact.Normal));
+	Recorded.HitBone = Impact.HitBone;
+	Recorded.Radius = Impact.Radius;
+	Recorded.Force = Impact.Force;
+	Recorded.FragmentMultiplier = Impact.FragmentMultiplier;
+	Recorded.Seed = Impact.Seed;
+	Recorded.MaterialID = Result.bBroken ? Result.MaterialID : INDEX_NONE;
+}
+
+void UClothBreakingSubsystem::FeedReplayImpacts()
+{
+	const TArray<FClothBreakRecordedImpact>& Impacts = Replay->Impacts;
+	if (ReplayCursor >= Impacts.Num())
+	{
+		return;
+	}
+
+	// 最大速度时每帧回放录制中的一帧，否则回放所有已到时间的冲击
+	const uint32 MaxSpeedFrame = Impacts[ReplayCursor].Frame;
+	const double ReplayTime = GetWorld()->GetTimeSeconds() - ReplayStartTime;
+	bool bFedAny = false;
+
+	while (ReplayCursor < Impacts.Num())
+	{
+		const FClothBreakRecordedImpact& Recorded = Impacts[ReplayCursor];
+		if (bReplayMaxSpeed ? Recorded.Frame != MaxSpeedFrame : Recorded.Time > ReplayTime)
+		{
+			break;
+		}
+
+		++ReplayCursor;
+		bFedAny = true;
+
+		UClothBreakableComponent* Component = ReplayComponents.IsValidIndex(Recorded.ComponentIndex) ? ReplayComponents[Recorded.ComponentIndex].Get() : nullptr;
+		if (!Component || !Component->TargetSkeletalMesh)
+		{
+			++ReplayStats.NumSkippedImpacts;
+			continue;
+		}
+
+		// 法线和命中骨骼与录制时一致，碎片朝向和参考姿势映射才能复现
+		const FTransform& ComponentTransform = Component->TargetSkeletalMesh->GetComponentTransform();
+		const FVector Location = ComponentTransform.TransformPosition(FVector(Recorded.LocalLocation));
+		const FVector Normal = ComponentTransform.TransformVectorNoScale(FVector(Recorded.LocalNormal));
+		if (QueueImpactWithSeed(Component, Location, Recorded.Radius, Recorded.Force, Recorded.FragmentMultiplier, Recorded.Seed,
+			Normal, Recorded.HitBone))
+		{
+			++ReplayStats.NumImpacts;
+		}
+		else
+		{
+			++ReplayStats.NumSkippedImpacts;
+		}
+	}
+
+	if (bFedAny)
+	{
+		++ReplayStats.NumFrames;
+	}
+}
+
+void UClothBreakingSubsystem::FinishImpactReplay()
+{
+	UE_LOG(LogTemp, Log, TEXT("Cloth impact replay finished: frames=%d impacts=%d skipped=%d fragments=%d tick total=%.3fms avg=%.3fms max=%.3fms allocations=%lld"),
+		ReplayStats.NumFrames, ReplayStats.NumImpacts, ReplayStats.NumSkippedImpacts, ReplayStats.NumFragments,
+		ReplayStats.TotalTickMs, ReplayStats.NumFrames > 0 ? ReplayStats.TotalTickMs / ReplayStats.NumFrames : 0.0,
+		ReplayStats.MaxTickMs, ReplayStats.NumAllocations);
+
+	if (!FClothBreakAllocationCounter::IsEnabled())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Start with -ClothBreakTrackAllocations to count allocations"));
+	}
+
+	Replay.Reset();
+	ReplayComponents.Reset();
+}
+
+bool UClothBreakingSubsystem::StartStressTest(float ImpactsPerSecond, float DurationSeconds)
+{
+	if (ImpactsPerSecond <= 0.0f || DurationSeconds <= 0.0f)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cloth break stress test needs a positive impact rate and duration"));
+		return false;
+	}
+
+	if (States.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cloth break stress test skipped: no registered components"));
+		return false;
+	}
+
+	StressImpactsPerSecond = ImpactsPerSecond;
+	StressRemainingSeconds = DurationSeconds;
+	StressImpactAccumulator = 0.0f;
+	StressCursor = INDEX_NONE;
+	StressStartSeconds = FPlatformTime::Seconds();
+	StressStats = FClothBreakStressStats();
+
+	UE_LOG(LogTemp, Log, TEXT("Started cloth break stress test: %.1f impacts/s for %.1fs across %d components"),
+		ImpactsPerSecond, DurationSeconds, States.Num());
+	return true;
+}
+
+void UClothBreakingSubsystem::FeedStressImpacts(float DeltaTime)
+{
+	const double FrameMs = DeltaTime * 1000.0;
+	++StressStats.NumFrames;
+	StressStats.TotalFrameMs += FrameMs;
+	StressStats.MaxFrameMs = FMath::Max(StressStats.MaxFrameMs, FrameMs);
+
+	StressRemainingSeconds -= DeltaTime;
+	if (StressRemainingSeconds <= 0.0f || States.Num() == 0)
+	{
+		FinishStressTest();
+		return;
+	}
+
+	// 按速率累计，帧率低于冲击速率时一帧发出多个冲击
+	StressImpactAccumulator += StressImpactsPerSecond * DeltaTime;
+	const int32 NumToFire = FMath::FloorToInt(StressImpactAccumulator);
+	StressImpactAccumulator -= NumToFire;
+
+	for (int32 i = 0; i < NumToFire; ++i)
+	{
+		// 轮流选择组件，保证每个已注册组件都受到冲击
+		StressCursor = (StressCursor + 1) % States.Num();
+		UClothBreakableComponent* Component = States[StressCursor].Component.Get();
+		if (!Component || !Component->TargetSkeletalMesh)
+		{
+			++StressStats.NumRejectedImpacts;
+			continue;
+		}
+
+		// 优先命中表面上的随机顶点，区域数据尚未加载时在网格体包围盒内取点
+		FVector Location;
+		const TSharedPtr<const FClothSurfaceUVTable> SurfaceTable = Component->GetSurfaceTable();
+		if (SurfaceTable && SurfaceTable->Positions.Num() > 0)
+		{
+			const FVector3f& Position = SurfaceTable->Positions[FMath::RandHelper(SurfaceTable->Positions.Num())];
+			Location = Component->TargetSkeletalMesh->GetComponentTransform().TransformPosition(FVector(Position));
+		}
+		else
+		{
+			Location = FMath::RandPointInBox(Component->TargetSkeletalMesh->Bounds.GetBox());
+		}
+
+		const float BulletSize = FMath::FRandRange(0.5f, 2.0f);
+		const float Force = Component->GetRuntimeSettings().BreakForceThreshold * FMath::FRandRange(1.0f, 2.0f);
+		// 排队成功的冲击在解析后按结果计入，未能排队的直接计为拒绝
+		if (Component->SimulateBulletImpact(Location, BulletSize, Force))
+		{
+			++StressStats.NumQueuedImpacts;
+		}
+		else
+		{
+			++StressStats.NumRejectedImpacts;
+		}
+	}
+}
+
+void UClothBreakingSubsystem::FinishStressTest()
+{
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StressStartSeconds;
+	const int32 NumFrames = FMath::Max(StressStats.NumFrames, 1);
+
+	UE_LOG(LogTemp, Log, TEXT("Cloth break stress test finished: components=%d time=%.2fs frames=%d queued=%d impacts=%d (%.1f/s) rejected=%d breaks=%d fragments=%d ")
+		TEXT("frame avg=%.2fms max=%.2fms tick avg=%.3fms max=%.3fms"),
+		States.Num(), ElapsedSeconds, StressStats.NumFrames, StressStats.NumQueuedImpacts, StressStats.NumImpacts,
+		ElapsedSeconds > 0.0 ? StressStats.NumImpacts / ElapsedSeconds : 0.0, StressStats.NumRejectedImpacts,
+		StressStats.NumBreaks, StressStats.NumFragments,
+		StressStats.TotalFrameMs / NumFrames, StressStats.MaxFrameMs,
+		StressStats.TotalTickMs / NumFrames, StressStats.MaxTickMs);
+
+	StressImpactsPerSecond = 0.0f;
+}
+
+float UClothBreakingSubsystem::GetFrameBudgetMs() const
+{
+	return ClothBreakCVars::GetFrameBudgetMs(FrameBudgetMs);
+}
+
+int32 UClothBreakingSubsystem::GetNumPendingWorkItems() const
+{
+	int32 NumItems = 0;
+	for (int32 TypeIndex = 0; TypeIndex < (int32)EClothBreakWorkType::Count; ++TypeIndex)
+	{
+		NumItems += WorkQueues[TypeIndex].Num() - WorkQueueHeads[TypeIndex];
+	}
+	return NumItems;
+}
+
+void UClothBreakingSubsystem::InitializePendingComponents()
+{
+	for (int32 i = UninitializedComponents.Num() - 1; i >= 0; --i)
+	{
+		UClothBreakableComponent* Component = UninitializedComponents[i].Get();
+		if (!Component)
+		{
+			UninitializedComponents.RemoveAtSwap(i);
+		}
+		else if (Component->TryInitialize())
+		{
+			UninitializedComponents.RemoveAtSwap(i);
+			HandleComponentInitialized(Component);
+		}
+	}
+}
+
+void UClothBreakingSubsystem::HandleComponentInitialized(UClothBreakableComponent* Component)
+{
+	if (ClothBreakCVars::IsAutoPrewarmEnabled())
+	{
+		PrewarmComponent(Component);
+	}
+}
+
+void UClothBreakingSubsystem::PrewarmComponent(UClothBreakableComponent* Component)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	if (Component->TargetSkeletalMesh)
+	{
+		PrewarmMesh(Component->TargetSkeletalMesh->GetSkeletalMeshAsset(), Component->GetRuntimeSettings());
+	}
+
+	// 之后才会生成的角色使用的网格体
+	if (Component->BreakableSettings && Component->BreakableSettings->PrewarmMeshes.Num() > 0)
+	{
+		PrewarmMeshes(Component->BreakableSettings->PrewarmMeshes, Component->BreakableSettings);
+	}
+}
+
+void UClothBreakingSubsystem::PrewarmMeshes(const TArray<TSoftObjectPtr<USkeletalMesh>>& Meshes, const UClothBreakableSettings* Settings)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Subsystem);
+
+	FClothBreakableRuntimeSettings RuntimeSettings;
+	RuntimeSettings.Resolve(Settings, FClothBreakableSettingsOverrides());
+
+	TArray<FSoftObjectPath> PathsToLoad;
+	for (const TSoftObjectPtr<USkeletalMesh>& Mesh : Meshes)
+	{
+		if (Mesh.IsNull())
+		{
+			continue;
+		}
+
+		if (USkeletalMesh* LoadedMesh = Mesh.Get())
+		{
+			PrewarmMesh(LoadedMesh, RuntimeSettings);
+		}
+		else if (!RequestedPrewarmPaths.Contains(Mesh.ToSoftObjectPath()))
+		{
+			RequestedPrewarmPaths.Add(Mesh.ToSoftObjectPath());
+			PathsToLoad.Add(Mesh.ToSoftObjectPath());
+		}
+	}
+
+	if (PathsToLoad.Num() == 0)
+	{
+		return;
+	}
+
+	// 后台加载，完成后在游戏线程继续预热
+	++NumPendingPrewarmLoads;
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(PathsToLoad,
+		FStreamableDelegate::CreateWeakLambda(this, [this, PathsToLoad, RuntimeSettings]()
+		{
+			--NumPendingPrewarmLoads;
+			for (const FSoftObjectPath& Path : PathsToLoad)
+			{
+				PrewarmMesh(Cast<USkeletalMesh>(Path.ResolveObject()), RuntimeSettings);
+			}
+		}), FStreamableManager::AsyncLoadHighPriority);
+
+	if (Handle)
+	{
+		PrewarmLoadHandles.Add(MoveTemp(Handle));
+	}
+	else
+	{
+		--NumPendingPrewarmLoads;
+	}
+}
+
+void UClothBreakingSubsystem::PrewarmMesh(USkeletalMesh* Mesh, const FClothBreakableRuntimeSettings& Settings)
+{
+	if (!Mesh || PrewarmedMeshes.Contains(Mesh))
+	{
+		return;
+	}
+	PrewarmedMeshes.Add(Mesh);
+
+	// 表面查找表在后台加载，持有引用使之后初始化的组件直接命中
+	FClothSurfaceUVTable::GetAsync(Mesh, 0, [WeakThis = TWeakObjectPtr<UClothBreakingSubsystem>(this)](TSharedPtr<const FClothSurfaceUVTable> Table)
+	{
+		if (WeakThis.IsValid() && Table)
+		{
+			WeakThis->PrewarmedTables.Add(MoveTemp(Table));
+		}
+	});
+
+	// 完整断裂的各LOD上的边图在后台构建，第一次撕裂时不再在游戏线程构建
+	if (Settings.bEnableTearPropagation)
+	{
+		for (UClothingAssetBase* ClothingAssetBase : Mesh->GetMeshClothingAssets())
+		{
+			const UClothingAssetCommon* ClothingAsset = Cast<UClothingAssetCommon>(ClothingAssetBase);
+			if (!ClothingAsset)
+			{
+				continue;
+			}
+
+			for (int32 MeshLOD = 0; MeshLOD <= Settings.MaxFullBreakLOD && ClothingAsset->LodMap.IsValidIndex(MeshLOD); ++MeshLOD)
+			{
+				RequestTearGraph(ClothingAsset, ClothingAsset->LodMap[MeshLOD]);
+			}
+		}
+	}
+
+	if (!Settings.bEnableFragments)
+	{
+		return;
+	}
+
+	// 设置的尺寸范围内每个形状和尺寸档位各构建一次，已缓存的档位在执行时直接跳过
+	const int32 MinBucket = UClothFragmentAssetCache::QuantizeSize(Settings.MinFragmentSize);
+	const int32 MaxBucket = UClothFragmentAssetCache::QuantizeSize(FMath::Max(Settings.MaxFragmentSize, Settings.MinFragmentSize));
+	for (int32 ShapeIndex = 0; ShapeIndex < (int32)EClothFragmentShape::Count; ++ShapeIndex)
+	{
+		for (int32 Bucket = MinBucket; Bucket <= MaxBucket; ++Bucket)
+		{
+			FClothBreakPrewarmStep& MeshStep = PrewarmSteps.AddDefaulted_GetRef();
+			MeshStep.Type = EClothBreakPrewarmStepType::FragmentMesh;
+			MeshStep.Shape = (EClothFragmentShape)ShapeIndex;
+			MeshStep.SizeBucket = Bucket;
+		}
+	}
+
+	// 每个世界按运行时的物理设置各生成一次即可预热Actor生成和物理体创建
+	bool& bSpawnPrewarmQueued = Settings.bEnableFragmentPhysics ? bPhysicsSpawnPrewarmQueued : bStaticSpawnPrewarmQueued;
+	if (!bSpawnPrewarmQueued)
+	{
+		bSpawnPrewarmQueued = true;
+		FClothBreakPrewarmStep& SpawnStep = PrewarmSteps.AddDefaulted_GetRef();
+		SpawnStep.Type = EClothBreakPrewarmStepType::SpawnFragment;
+		SpawnStep.Mesh = Mesh;
+		SpawnStep.SizeBucket = MinBucket;
+		SpawnStep.bSimulatePhysics = Settings.bEnableFragmentPhysics;
+	}
+}
+
+void UClothBreakingSubsystem::ProcessPrewarmSteps(double DeadlineSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::ProcessPrewarmSteps);
+	LLM_SCOPE_BYTAG(ClothBreak_Fragments);
+
+	UClothFragmentAssetCache* AssetCache = UClothFragmentAssetCache::Get();
+	if (!AssetCache)
+	{
+		return;
+	}
+
+	do
+	{
+		const FClothBreakPrewarmStep Step = PrewarmSteps[PrewarmStepHead++];
+		USkeletalMesh* Mesh = Step.Mesh.Get();
+
+		switch (Step.Type)
+		{
+		case EClothBreakPrewarmStepType::FragmentMesh:
+		{
+			float QuantizedSize = 0.0f;
+			AssetCache->GetFragmentMesh(Step.Shape, UClothFragmentAssetCache::GetBucketSize(Step.SizeBucket), QuantizedSize);
+			break;
+		}
+
+		case EClothBreakPrewarmStepType::SpawnFragment:
+		{
+			if (!PrewarmGenerator)
+			{
+				PrewarmGenerator = NewObject<UClothFragmentGenerator>(this);
+			}
+
+			// 在世界原点隐藏生成并在同一帧销毁，不经过物理步进也不渲染；远离原点的位置可能超出世界边界或物理场景的范围
+			FClothFragmentSpawnParams SpawnParams;
+			SpawnParams.Location = FVector::ZeroVector;
+			SpawnParams.Size = UClothFragmentAssetCache::GetBucketSize(Step.SizeBucket);
+			UMaterialInterface* Material = Mesh && Mesh->GetMaterials().Num() > 0 ? Mesh->GetMaterials()[0].MaterialInterface.Get() : nullptr;
+			PrewarmGenerator->SpawnFragments(MakeArrayView(&SpawnParams, 1), Material, Step.bSimulatePhysics, true);
+			PrewarmGenerator->DestroyAllFragments();
+			break;
+		}
+		}
+	}
+	while (PrewarmStepHead < PrewarmSteps.Num() && FPlatformTime::Seconds() < DeadlineSeconds);
+
+	if (PrewarmStepHead >= PrewarmSteps.Num())
+	{
+		PrewarmSteps.Reset();
+		PrewarmStepHead = 0;
+		UE_LOG(LogTemp, Verbose, TEXT("Cloth break prewarm finished: %d meshes, %d cached fragment meshes"),
+			PrewarmedMeshes.Num(), AssetCache->GetNumCachedMeshes());
+	}
+}
+
+void UClothBreakingSubsystem::PrepareStatesForResolve(TConstArrayView<FClothBreakImpact> Impacts)
+{
+	// 冲击已按角色分组，每个角色只更新一次
+	for (int32 i = 0; i < Impacts.Num(); ++i)
+	{
+		if (i > 0 && Impacts[i].StateIndex == Impacts[i - 1].StateIndex)
+		{
+			continue;
+		}
+
+		FClothBreakableRuntimeState& State = States[Impacts[i].StateIndex];
+		UClothBreakableComponent* Component = State.Component.Get();
+		if (!Component || !Component->TargetSkeletalMesh)
+		{
+			continue;
+		}
+
+		// 区域判断和碎片规划针对当前实际渲染的LOD，区域数据尚未加载时为空，走简化路径
+		const int32 LODIndex = Component->GetRenderedLOD();
+		State.LODIndex = LODIndex;
+		State.SurfaceTable = Component->GetSurfaceTable();
+		State.ComponentTransform = Component->TargetSkeletalMesh->GetComponentTransform();
+		State.BoundsOrigin = Component->TargetSkeletalMesh->Bounds.Origin;
+		// 只有本帧有冲击的组件才读取布料模拟位置
+		State.SimSnapshot = Component->GetSimSnapshot();
+		State.BindPose = Component->GetBindPoseMapping();
+	}
+}
+
+void UClothBreakingSubsystem::ResolveImpacts(TConstArrayView<FClothBreakImpact> Impacts, TArrayView<FClothBreakResult> OutResults,
+	TArrayView<FClothFragmentSpawnParams> OutFragments) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::ResolveImpacts);
+
+	// 记录每个角色分组的起点，不同角色之间互不依赖，可以并行处理
+	TClothFrameArray<int32> GroupStarts;
+	GroupStarts.Reserve(Impacts.Num() + 1);
+	for (int32 i = 0; i < Impacts.Num(); ++i)
+	{
+		if (i == 0 || Impacts[i].StateIndex != Impacts[i - 1].StateIndex)
+		{
+			GroupStarts.Add(i);
+		}
+	}
+	GroupStarts.Add(Impacts.Num());
+
+	const int32 NumGroups = GroupStarts.Num() - 1;
+	ParallelFor(NumGroups, [&](int32 GroupIndex)
+	{
+		const FClothBreakableRuntimeState& State = States[Impacts[GroupStarts[GroupIndex]].StateIndex];
+
+		for (int32 ImpactIndex = GroupStarts[GroupIndex]; ImpactIndex < GroupStarts[GroupIndex + 1]; ++ImpactIndex)
+		{
+			const FClothBreakImpact& Impact = Impacts[ImpactIndex];
+			FClothBreakResult& Result = OutResults[ImpactIndex];
+
+			// 检查碰撞力是否超过阈值
+			if (Impact.Force < State.Settings.BreakForceThreshold)
+			{
+				continue;
+			}
+
+			// 检查位置是否在可断裂区域内
+			const FVector3f LocalLocation(State.ComponentTransform.InverseTransformPosition(Impact.Location));
+			FVector3f SurfaceLocation;
+			if (!IsLocationInBreakableRegion(State.Settings, State.SimSnapshot, State.SurfaceTable.Get(), State.BindPose, LocalLocation,
+				Result.MaterialID, SurfaceLocation, Impact.HitBone))
+			{
+				continue;
+			}
+
+			Result.bBroken = true;
+
+			// 低精度LOD上或碎片被禁用时只记录破洞，不规划碎片
+			if (State.LODIndex > State.Settings.MaxFullBreakLOD || !State.Settings.bEnableFragments)
+			{
+				continue;
+			}
+
+			// 每个冲击写入自己的碎片槽位，无需加锁
+			FRandomStream RandomStream(Impact.Seed);
+			const int32 FragmentCount = FMath::RoundToInt(
+				RandomStream.RandRange(State.Settings.MinFragmentCount, State.Settings.MaxFragmentCount) * Impact.FragmentMultiplier);
+			if (FragmentCount <= 0)
+			{
+				continue;
+			}
+			// 碎片围绕布料当前的表面位置，在表面的切平面内生成
+			const FVector FragmentCenter = State.ComponentTransform.TransformPosition(FVector(SurfaceLocation));
+			const FVector FragmentNormal = UClothFragmentGenerator::ResolveImpactNormal(Impact.Normal, FragmentCenter, State.BoundsOrigin);
+			Result.NumFragments = UClothFragmentGenerator::PlanFragments(State.Settings.FragmentStrategy, RandomStream, FragmentCenter, FragmentNormal,
+				Impact.Radius, FragmentCount, State.Settings.MinFragmentSize, State.Settings.MaxFragmentSize,
+				OutFragments.Slice(ImpactIndex * UClothFragmentGenerator::MaxFragmentsPerBreak, UClothFragmentGenerator::MaxFragmentsPerBreak));
+		}
+	});
+}
+
+void UClothBreakingSubsystem::EnqueueResults(TConstArrayView<FClothBreakImpact> Impacts, TConstArrayView<FClothBreakResult> Results,
+	TConstArrayView<FClothFragmentSpawnParams> Fragments)
+{
+	for (int32 i = 0; i < Impacts.Num(); ++i)
+	{
+		const FClothBreakResult& Result = Results[i];
+		if (Recording)
+		{
+			RecordImpact(Impacts[i], Result);
+		}
+
+		// 解析后才知道冲击是否落在可断裂区域内
+		if (IsStressTesting() && Result.bBroken)
+		{
+			++StressStats.NumImpacts;
+		}
+		else if (IsStressTesting())
+		{
+			++StressStats.NumRejectedImpacts;
+		}
+
+		if (!Result.bBroken || !States.IsValidIndex(Impacts[i].StateIndex))
+		{
+			continue;
+		}
+
+		const FClothBreakImpact& Impact = Impacts[i];
+		FClothBreakWorkItem Item;
+		Item.Component = States[Impact.StateIndex].Component;
+		Item.Location = Impact.Location;
+		Item.Radius = Impact.Radius;
+		Item.Force = Impact.Force;
+		Item.MaterialID = Result.MaterialID;
+		Item.HitBone = Impact.HitBone;
+
+		// 破洞顺延到之后的帧时角色可能已经移动，转换到组件空间保存
+		FClothBreakWorkItem& CutItem = WorkQueues[(int32)EClothBreakWorkType::Cut].Add_GetRef(Item);
+		CutItem.Location = States[Impact.StateIndex].ComponentTransform.InverseTransformPosition(Item.Location);
+		WorkQueues[(int32)EClothBreakWorkType::Event].Add(Item);
+
+		// 远处的命中只写入破洞遮罩，不生成碎片
+		if (Result.NumFragments > 0 && Item.Component.IsValid() && Item.Component->ShouldSpawnFragments(Item.Location))
+		{
+			// 持续超出预算时同一组件的碎片会堆积，丢弃最早还没生成完的碎片
+			TArray<FClothBreakWorkItem>& DebrisQueue = WorkQueues[(int32)EClothBreakWorkType::Debris];
+			int32 OldestDebris = INDEX_NONE;
+			int32 NumQueuedDebris = 0;
+			for (int32 QueueIndex = WorkQueueHeads[(int32)EClothBreakWorkType::Debris]; QueueIndex < DebrisQueue.Num(); ++QueueIndex)
+			{
+				const FClothBreakWorkItem& Queued = DebrisQueue[QueueIndex];
+				if (Queued.Component == Item.Component && Queued.NextFragment < Queued.NumFragments)
+				{
+					OldestDebris = OldestDebris == INDEX_NONE ? QueueIndex : OldestDebris;
+					++NumQueuedDebris;
+				}
+			}
+			if (NumQueuedDebris >= MaxQueuedDebrisPerComponent)
+			{
+				DebrisQueue[OldestDebris].NumFragments = DebrisQueue[OldestDebris].NextFragment;
+			}
+
+			// 碎片跟随角色，转换到组件空间保存，顺延到之后的帧时仍在角色身上生成
+			const FTransform& ComponentTransform = States[Impact.StateIndex].ComponentTransform;
+			Item.FirstFragment = FragmentPool.Num();
+			Item.NumFragments = Result.NumFragments;
+			FragmentPool.Append(Fragments.Slice(i * UClothFragmentGenerator::MaxFragmentsPerBreak, Result.NumFragments));
+			for (int32 FragmentIndex = Item.FirstFragment; FragmentIndex < FragmentPool.Num(); ++FragmentIndex)
+			{
+				FClothFragmentSpawnParams& Params = FragmentPool[FragmentIndex];
+				Params.Location = ComponentTransform.InverseTransformPosition(Params.Location);
+				Params.Rotation = ComponentTransform.InverseTransformRotation(Params.Rotation.Quaternion()).Rotator();
+			}
+			DebrisQueue.Add(Item);
+		}
+	}
+}
+
+void UClothBreakingSubsystem::ProcessWorkItems(double DeadlineSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::ProcessWorkItems);
+
+	// 每帧至少推进一步，避免预算过小时工作项永远无法完成
+	bool bMadeProgress = false;
+
+	for (int32 TypeIndex = 0; TypeIndex < (int32)EClothBreakWorkType::Count; ++TypeIndex)
+	{
+		TArray<FClothBreakWorkItem>& Queue = WorkQueues[TypeIndex];
+		int32& Head = WorkQueueHeads[TypeIndex];
+
+		while (Head < Queue.Num())
+		{
+			if (bMadeProgress && FPlatformTime::Seconds() >= DeadlineSeconds)
+			{
+				UE_LOG(LogTemp, Verbose, TEXT("Cloth break budget exhausted, %d work items deferred"), GetNumPendingWorkItems());
+				CompactWorkQueues();
+				return;
+			}
+
+			// 事件回调中可能追加新工作项，这里按索引访问并在执行前拷贝
+			FClothBreakWorkItem Item = Queue[Head];
+			const bool bFinished = ExecuteWorkStep((EClothBreakWorkType)TypeIndex, Item);
+			bMadeProgress = true;
+
+			if (bFinished)
+			{
+				++Head;
+			}
+			else
+			{
+				Queue[Head] = Item;
+			}
+		}
+
+		// 队列已清空，保留容量供之后的帧使用
+		Queue.Reset();
+		Head = 0;
+
+		if (TypeIndex == (int32)EClothBreakWorkType::Debris)
+		{
+			FragmentPool.Reset();
+		}
+	}
+}
+
+void UClothBreakingSubsystem::CompactWorkQueues()
+{
+	for (int32 TypeIndex = 0; TypeIndex < (int32)EClothBreakWorkType::Count; ++TypeIndex)
+	{
+		// 已完成的部分超过一半时才移动，摊销后每个工作项只移动常数次
+		TArray<FClothBreakWorkItem>& Queue = WorkQueues[TypeIndex];
+		int32& Head = WorkQueueHeads[TypeIndex];
+		if (Head > 0 && Head * 2 >= Queue.Num())
+		{
+			Queue.RemoveAt(0, Head, EAllowShrinking::No);
+			Head = 0;
+		}
+	}
+
+	// 碎片工作项按入队顺序引用碎片池，第一个未完成工作项之前的碎片参数都已用完
+	TArray<FClothBreakWorkItem>& DebrisQueue = WorkQueues[(int32)EClothBreakWorkType::Debris];
+	const int32 Head = WorkQueueHeads[(int32)EClothBreakWorkType::Debris];
+	const int32 NumUsedFragments = DebrisQueue.IsValidIndex(Head) ? DebrisQueue[Head].FirstFragment : FragmentPool.Num();
+	if (NumUsedFragments > 0 && NumUsedFragments * 2 >= FragmentPool.Num())
+	{
+		FragmentPool.RemoveAt(0, NumUsedFragments, EAllowShrinking::No);
+		for (int32 QueueIndex = Head; QueueIndex < DebrisQueue.Num(); ++QueueIndex)
+		{
+			DebrisQueue[QueueIndex].FirstFragment -= NumUsedFragments;
+		}
+	}
+}
+
+bool UClothBreakingSubsystem::ExecuteWorkStep(EClothBreakWorkType Type, FClothBreakWorkItem& Item)
+{
+	UClothBreakableComponent* Component = Item.Component.Get();
+	if (!IsValid(Component) || Component->RuntimeStateIndex == INDEX_NONE)
+	{
+		return true;
+	}
+
+	switch (Type)
+	{
+	case EClothBreakWorkType::Cut:
+		if (Component->TargetSkeletalMesh)
+		{
+			const FVector Location = Component->TargetSkeletalMesh->GetComponentTransform().TransformPosition(Item.Location);
+			Component->ApplyBreakCut(Location, Item.Radius, Item.MaterialID, Item.HitBone);
+			if (Component->GetRuntimeSettings().bEnableTearPropagation && Component->IsFullBreakLOD())
+			{
+				StartTear(Component, Location, Item.Radius, Item.MaterialID);
+			}
+		}
+		return true;
+
+	case EClothBreakWorkType::Event:
+		Component->BroadcastBreak(Item.Location, Item.Radius, Item.Force, Item.MaterialID);
+		if (IsStressTesting())
+		{
+			++StressStats.NumBreaks;
+		}
+		return true;
+
+	case EClothBreakWorkType::Debris:
+		// 每一步只生成一个碎片，便于在预算用完时中断
+		if (Item.NextFragment < Item.NumFragments && Component->TargetSkeletalMesh)
+		{
+			const FTransform& ComponentTransform = Component->TargetSkeletalMesh->GetComponentTransform();
+			FClothFragmentSpawnParams Params = FragmentPool[Item.FirstFragment + Item.NextFragment];
+			Params.Location = ComponentTransform.TransformPosition(Params.Location);
+			Params.Rotation = ComponentTransform.TransformRotation(Params.Rotation.Quaternion()).Rotator();
+			Component->SpawnBreakFragments(MakeArrayView(&Params, 1), Item.MaterialID);
+			++Item.NextFragment;
+
+			if (Replay)
+			{
+				++ReplayStats.NumFragments;
+			}
+			if (IsStressTesting())
+			{
+				++StressStats.NumFragments;
+			}
+		}
+		return Item.NextFragment >= Item.NumFragments;
+
+	default:
+		return true;
+	}
+}
+
+void UClothBreakingSubsystem::AddBreakRecord(const FClothBreakRecord& Record)
+{
+	if (BreaksBatchedDelegate.IsBound())
+	{
+		BreakRecords.Add(Record);
+	}
+}
+
+void UClothBreakingSubsystem::FlushBreakRecords()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::FlushBreakRecords);
+
+	// 回调中产生的断裂留到下一帧派发，断裂后同一帧内被销毁的组件不再派发
+	TClothFrameArray<FClothBreakRecord> Records;
+	Records.Reserve(BreakRecords.Num());
+	for (const FClothBreakRecord& Record : BreakRecords)
+	{
+		if (Record.Component.IsValid())
+		{
+			Records.Add(Record);
+		}
+	}
+	BreakRecords.Reset();
+
+	if (Records.Num() == 0)
+	{
+		return;
+	}
+
+	BreaksBatchedDelegate.Broadcast(Records);
+}
+
+int64 UClothBreakingSubsystem::ReportMemory(FOutputDevice* Ar)
+{
+	using ClothBreakMemory::ToKB;
+
+	if (Ar)
+	{
+		Ar->Logf(TEXT("Cloth break memory report (%s)"), *GetNameSafe(GetWorld()));
+		Ar->Logf(TEXT("  Shared per mesh:"));
+	}
+
+	const int64 SharedBytes = GetSharedMemoryBytes(Ar);
+
+	// 各组件各自持有的数据，完整遍历后同时刷新预算检查使用的统计
+	if (Ar)
+	{
+		Ar->Logf(TEXT("  Per component:"));
+	}
+
+	int64 ComponentBytes = 0;
+	int32 NumComponents = 0;
+	int32 NumFragments = 0;
+	for (FClothBreakableRuntimeState& State : States)
+	{
+		UClothBreakableComponent* Component = State.Component.Get();
+		if (!Component)
+		{
+			continue;
+		}
+
+		FClothBreakableMemoryStats Stats;
+		MeasureComponentMemory(State, Stats);
+		ComponentBytes += State.MemoryBytes;
+		NumFragments += Stats.NumFragments;
+		++NumComponents;
+
+		if (Ar)
+		{
+			const USkeletalMesh* Mesh = Component->TargetSkeletalMesh ? Component->TargetSkeletalMesh->GetSkeletalMeshAsset() : nullptr;
+			Ar->Logf(TEXT("    %s.%s (%s): %.1f KB [component %.1f, hole mask %.1f, snapshot %.1f, tearing %.1f, fragments %.1f] holes=%d fragments=%d"),
+				*GetNameSafe(Component->GetOwner()), *Component->GetName(), *GetNameSafe(Mesh), ToKB(Stats.GetTotalBytes()),
+				ToKB(Stats.ComponentBytes), ToKB(Stats.HoleMaskBytes), ToKB(Stats.SnapshotBytes), ToKB(Stats.TearingBytes), ToKB(Stats.FragmentBytes),
+				Component->GetNumBreakHoles(), Stats.NumFragments);
+		}
+	}
+	TrackedComponentBytes = ComponentBytes;
+
+	// 所有世界共用的碎片网格和材质
+	const UClothFragmentAssetCache* AssetCache = UClothFragmentAssetCache::Get();
+	const int64 AssetCacheBytes = AssetCache ? AssetCache->GetMemorySize() : 0;
+
+	const int64 SubsystemBytes = GetSubsystemMemoryBytes();
+
+	const int64 TotalBytes = SharedBytes + ComponentBytes + AssetCacheBytes + SubsystemBytes;
+	if (Ar)
+	{
+		Ar->Logf(TEXT("  Shared: %.1f KB, components: %.1f KB (%d), fragment assets: %.1f KB, subsystem: %.1f KB"),
+			ToKB(SharedBytes), ToKB(ComponentBytes), NumComponents, ToKB(AssetCacheBytes), ToKB(SubsystemBytes));
+		Ar->Logf(TEXT("  Total: %.1f KB, budget: %.1f KB, live fragments: %d"),
+			ToKB(TotalBytes), ToKB(ClothBreakMemory::GetBudgetBytes()), NumFragments);
+	}
+
+	return TotalBytes;
+}
+
+int64 UClothBreakingSubsystem::GetSharedMemoryBytes(FOutputDevice* Ar) const
+{
+	using ClothBreakMemory::ToKB;
+
+	// 同一网格体的组件共享的数据
+	int64 SharedBytes = 0;
+	FClothSurfaceUVTable::ForEachLoaded([&SharedBytes, Ar](const USkeletalMesh* Mesh, int32 LODIndex, const FClothSurfaceUVTable& Table)
+	{
+		const int64 Bytes = Table.GetAllocatedSize();
+		SharedBytes += Bytes;
+		if (Ar)
+		{
+			Ar->Logf(TEXT("    %s LOD%d surface table: %.1f KB, %d vertices"), *GetNameSafe(Mesh), LODIndex, ToKB(Bytes), Table.Positions.Num());
+		}
+	});
+
+	for (const TPair<TPair<TObjectKey<UClothingAssetBase>, int32>, TSharedPtr<const FClothTearGraph>>& Pair : TearGraphs)
+	{
+		const int64 Bytes = Pair.Value ? Pair.Value->GetAllocatedSize() : 0;
+		SharedBytes += Bytes;
+		if (Ar && Pair.Value)
+		{
+			Ar->Logf(TEXT("    %s LOD%d tear graph: %.1f KB, %d edges"), *GetNameSafe(Pair.Key.Key.ResolveObjectPtr()), Pair.Key.Value,
+				ToKB(Bytes), Pair.Value->Edges.Num());
+		}
+	}
+
+	return SharedBytes;
+}
+
+void UClothBreakingSubsystem::MeasureComponentMemory(FClothBreakableRuntimeState& State, FClothBreakableMemoryStats& OutStats)
+{
+	OutStats = FClothBreakableMemoryStats();
+	if (UClothBreakableComponent* Component = State.Component.Get())
+	{
+		Component->GetMemoryStats(OutStats);
+		OutStats.TearingBytes = State.Tearing ? State.Tearing->GetAllocatedSize() : 0;
+	}
+	State.MemoryBytes = OutStats.GetTotalBytes();
+}
+
+int64 UClothBreakingSubsystem::GetSubsystemMemoryBytes() const
+{
+	// 子系统自身的队列和帧内分配器
+	int64 SubsystemBytes = States.GetAllocatedSize() + PendingImpacts.GetAllocatedSize() + UninitializedComponents.GetAllocatedSize()
+		+ PenetratedLayers.GetAllocatedSize() + BreakRecords.GetAllocatedSize() + FragmentPool.GetAllocatedSize()
+		+ StashedBreakStates.GetAllocatedSize() + TearGraphs.GetAllocatedSize() + TearingComponents.GetAllocatedSize()
+		+ LooseningComponents.GetAllocatedSize()
+		+ FClothBreakFrameArena::Get().GetPeakFrameBytes();
+	for (const TArray<FClothBreakWorkItem>& Queue : WorkQueues)
+	{
+		SubsystemBytes += Queue.GetAllocatedSize();
+	}
+	for (const TPair<FString, FClothBreakStashedState>& Pair : StashedBreakStates)
+	{
+		SubsystemBytes += Pair.Key.GetAllocatedSize() + Pair.Value.Data.GetAllocatedSize();
+	}
+
+	return SubsystemBytes;
+}
+
+void UClothBreakingSubsystem::CheckMemoryBudget()
+{
+	const int64 BudgetBytes = ClothBreakMemory::GetBudgetBytes();
+	if (BudgetBytes <= 0)
+	{
+		bOverMemoryBudget = false;
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::CheckMemoryBudget);
+
+	// 每次只重新统计一部分组件，其余沿用上次的结果，几轮之后覆盖所有组件
+	const int32 NumToMeasure = FMath::Min(MemoryCheckComponentsPerPass, States.Num());
+	for (int32 Count = 0; Count < NumToMeasure; ++Count)
+	{
+		MemoryCheckCursor = MemoryCheckCursor < States.Num() ? MemoryCheckCursor : 0;
+		FClothBreakableRuntimeState& State = States[MemoryCheckCursor++];
+		const int64 PreviousBytes = State.MemoryBytes;
+		FClothBreakableMemoryStats Stats;
+		MeasureComponentMemory(State, Stats);
+		TrackedComponentBytes += State.MemoryBytes - PreviousBytes;
+	}
+
+	// 共享数据按网格体统计，数量与组件数量无关
+	const UClothFragmentAssetCache* AssetCache = UClothFragmentAssetCache::Get();
+	const int64 TotalBytes = GetSharedMemoryBytes(nullptr) + TrackedComponentBytes + (AssetCache ? AssetCache->GetMemorySize() : 0)
+		+ GetSubsystemMemoryBytes();
+
+	// 只在越过预算时警告一次，回到预算内后再次越过时重新警告
+	const bool bOverBudget = TotalBytes > BudgetBytes;
+	if (bOverBudget && !bOverMemoryBudget)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cloth break memory %.2f MB exceeds budget %.2f MB, run ClothBreak.MemReport for details"),
+			TotalBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0));
+	}
+	bOverMemoryBudget = bOverBudget;
+}
+
+const FClothSimSnapshotSection* UClothBreakingSubsystem::FindClothSimData(UClothBreakableComponent* Component, int32 ClothingAssetIndex)
+{
+	// 正在撕裂或刚断裂的组件在这里按需读取，结果只在当帧使用
+	const FClothSimSnapshot* Snapshot = Component ? Component->GetSimSnapshot() : nullptr;
+	return Snapshot ? Snapshot->FindSection(ClothingAssetIndex) : nullptr;
+}
+
+FClothTearState* UClothBreakingSubsystem::GetOrCreateTearState(FClothBreakableRuntimeState& State, int32 MaterialID)
+{
+	LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+
+	const UClothBreakableComponent* Component = State.Component.Get();
+	const USkeletalMesh* Mesh = Component && Component->TargetSkeletalMesh ? Component->TargetSkeletalMesh->GetSkeletalMeshAsset() : nullptr;
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+
+	// 使用被击中的、在当前渲染LOD有模拟且材质可断裂的布料资产，撕裂不会扩展到不可断裂的区域
+	const int32 MeshLOD = Component->GetRenderedLOD();
+	const TArray<UClothingAssetBase*> ClothingAssets = Mesh->GetMeshClothingAssets();
+	for (int32 AssetIndex = 0; AssetIndex < ClothingAssets.Num(); ++AssetIndex)
+	{
+		const UClothingAssetCommon* ClothingAsset = Cast<UClothingAssetCommon>(ClothingAssets[AssetIndex]);
+		if (!ClothingAsset || !ClothingAsset->LodMap.IsValidIndex(MeshLOD) || ClothingAsset->LodMap[MeshLOD] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const int32 AssetMaterialID = GetClothingAssetMaterialID(*Mesh, MeshLOD, AssetIndex);
+		if ((MaterialID >= 0 && AssetMaterialID != MaterialID)
+			|| (State.Settings.BreakableMaterialIDs.Num() > 0 && !State.Settings.BreakableMaterialIDs.Contains(AssetMaterialID)))
+		{
+			continue;
+		}
+
+		const int32 ClothLOD = ClothingAsset->LodMap[MeshLOD];
+		if (State.Tearing && State.Tearing->ClothingAssetIndex == AssetIndex && State.Tearing->LODIndex == ClothLOD)
+		{
+			return State.Tearing.Get();
+		}
+
+		// 边图通常已在预热时构建，尚未完成时本次不撕裂
+		const TSharedPtr<const FClothTearGraph>* Graph = TearGraphs.Find(TPair<TObjectKey<UClothingAssetBase>, int32>(ClothingAsset, ClothLOD));
+		if (!Graph)
+		{
+			RequestTearGraph(ClothingAsset, ClothLOD);
+			return nullptr;
+		}
+
+		if (!*Graph)
+		{
+			return nullptr;
+		}
+
+		// 模拟切换到其他LOD或击中其他布料资产后粒子编号不同，原有的撕裂无法延续，已记录的破洞仍然保留
+		if (State.Tearing)
+		{
+			NumActiveTears = FMath::Max(NumActiveTears - State.Tearing->ActiveTears.Num(), 0);
+		}
+		State.Tearing = MakeUnique<FClothTearState>();
+		State.Tearing->Initialize(*Graph, AssetIndex, ClothLOD);
+		return State.Tearing.Get();
+	}
+
+	return nullptr;
+}
+
+void UClothBreakingSubsystem::RequestTearGraph(const UClothingAssetCommon* ClothingAsset, int32 ClothLOD)
+{
+	const TPair<TObjectKey<UClothingAssetBase>, int32> Key(ClothingAsset, ClothLOD);
+	if (!ClothingAsset || !ClothingAsset->LodData.IsValidIndex(ClothLOD) || TearGraphs.Contains(Key))
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+
+	// 占位，构建期间不重复请求；构建失败时保持为空，不再重试
+	TearGraphs.Add(Key);
+
+	// 只拷贝物理网格，工作线程不持有布料资产
+	const FClothPhysicalMeshData& PhysicalMesh = ClothingAsset->LodData[ClothLOD].PhysicalMeshData;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[WeakThis = TWeakObjectPtr<UClothBreakingSubsystem>(this), Key, Name = ClothingAsset->GetFName(), Vertices = PhysicalMesh.Vertices, Indices = PhysicalMesh.Indices]()
+	{
+		LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+		TSharedPtr<const FClothTearGraph> Graph = FClothTearGraph::Build(Vertices, Indices);
+		if (Graph)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Built cloth tear graph for %s LOD%d: %d vertices, %d edges"),
+				*Name.ToString(), Key.Value, Graph->GetNumVertices(), Graph->Edges.Num());
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Key, Graph = MoveTemp(Graph)]()
+		{
+			if (UClothBreakingSubsystem* Subsystem = WeakThis.Get())
+			{
+				if (TSharedPtr<const FClothTearGraph>* Slot = Subsystem->TearGraphs.Find(Key))
+				{
+					*Slot = Graph;
+				}
+			}
+		});
+	});
+}
+
+void UClothBreakingSubsystem::ResetTearState(const UClothBreakableComponent* Component)
+{
+	if (!Component || !States.IsValidIndex(Component->RuntimeStateIndex))
+	{
+		return;
+	}
+
+	TUniquePtr<FClothTearState>& Tearing = States[Component->RuntimeStateIndex].Tearing;
+	if (Tearing)
+	{
+		NumActiveTears = FMath::Max(NumActiveTears - Tearing->ActiveTears.Num(), 0);
+		Tearing.Reset();
+	}
+}
+
+void UClothBreakingSubsystem::StartTear(UClothBreakableComponent* Component, const FVector& Location, float Radius, int32 MaterialID)
+{
+	if (!States.IsValidIndex(Component->RuntimeStateIndex))
+	{
+		return;
+	}
+
+	if (NumActiveTears >= MaxActiveTears)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Too many active cloth tears (%d), not tearing from this hole"), NumActiveTears);
+		return;
+	}
+
+	FClothTearState* Tearing = GetOrCreateTearState(States[Component->RuntimeStateIndex], MaterialID);
+	const FClothSimSnapshotSection* SimData = Tearing ? FindClothSimData(Component, Tearing->ClothingAssetIndex) : nullptr;
+	if (!SimData)
+	{
+		return;
+	}
+
+	// 模拟数据位于模拟空间，将破洞中心转换过去
+	LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+	const FVector ComponentLocation = Component->TargetSkeletalMesh->GetComponentTransform().InverseTransformPosition(Location);
+	const FVector3f SimCenter = FVector3f(SimData->ComponentRelativeTransform.InverseTransformPosition(ComponentLocation));
+	if (Tearing->StartTear(*SimData, SimCenter, Radius, MaterialID))
+	{
+		++NumActiveTears;
+		TearingComponents.Add(Component);
+	}
+}
+
+void UClothBreakingSubsystem::QueueDamageLoosening(UClothBreakableComponent* Component)
+{
+	if (Component)
+	{
+		LooseningComponents.Add(Component);
+	}
+}
+
+void UClothBreakingSubsystem::FlushDamageLoosening()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::FlushDamageLoosening);
+
+	for (const TWeakObjectPtr<UClothBreakableComponent>& Component : LooseningComponents)
+	{
+		if (UClothBreakableComponent* LooseningComponent = Component.Get())
+		{
+			LooseningComponent->ApplyDamageLoosening();
+		}
+	}
+
+	LooseningComponents.Reset();
+}
+
+void UClothBreakingSubsystem::AdvanceTears(double DeadlineSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UClothBreakingSubsystem::AdvanceTears);
+	LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+
+	// 在游戏线程读取正在撕裂的组件当前的模拟位置
+	TClothFrameArray<UClothBreakableComponent*> Components;
+	TClothFrameArray<FClothBreakableRuntimeState*> TearStates;
+	TClothFrameArray<const FClothSimSnapshotSection*> SimDatas;
+	int32 NumTears = 0;
+
+	for (auto It = TearingComponents.CreateIterator(); It; ++It)
+	{
+		UClothBreakableComponent* Component = It->Get();
+		FClothBreakableRuntimeState* State = Component && States.IsValidIndex(Component->RuntimeStateIndex) ? &States[Component->RuntimeStateIndex] : nullptr;
+		if (!State || !State->Tearing || !State->Tearing->HasActiveTears())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		NumTears += State->Tearing->ActiveTears.Num();
+
+		// 低精度LOD上撕裂暂停，回到近处后继续
+		if (!Component->IsFullBreakLOD())
+		{
+			continue;
+		}
+
+		// 本帧没有模拟数据时（例如布料被暂停）撕裂保持不动
+		if (const FClothSimSnapshotSection* SimData = FindClothSimData(Component, State->Tearing->ClothingAssetIndex))
+		{
+			Components.Add(Component);
+			TearStates.Add(State);
+			SimDatas.Add(SimData);
+		}
+	}
+
+	// 重新统计，组件注销或切换LOD时丢弃的撕裂不再占用名额
+	NumActiveTears = NumTears;
+
+	const int32 NumComponents = Components.Num();
+	if (NumComponents == 0)
+	{
+		return;
+	}
+
+	TClothFrameArray<FVector3f> Points;
+	const int32 FirstIndex = TearCursor % NumComponents;
+	int32 NumProcessed = 0;
+	while (NumProcessed < NumComponents)
+	{
+		if (NumProcessed > 0 && FPlatformTime::Seconds() >= DeadlineSeconds)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Cloth break budget exhausted, %d tearing components deferred"), NumComponents - NumProcessed);
+			break;
+		}
+
+		// 不同组件的撕裂互不依赖，一批内并行推进，每条撕裂每帧的步数有上限
+		const int32 BatchSize = FMath::Min(TearBatchSize, NumComponents - NumProcessed);
+		ParallelFor(BatchSize, [&](int32 BatchIndex)
+		{
+			LLM_SCOPE_BYTAG(ClothBreak_Tearing);
+			const int32 Index = (FirstIndex + NumProcessed + BatchIndex) % NumComponents;
+			const FClothBreakableRuntimeSettings& Settings = TearStates[Index]->Settings;
+			TearStates[Index]->Tearing->AdvanceTears(SimDatas[Index]->Positions,
+				Settings.TearStrainThreshold, Settings.MaxTearStepsPerFrame, Settings.MaxTearLength);
+		});
+
+		// 在游戏线程把每条撕裂新断开的边合并到它的破洞记录，并计入损伤，布料约束随撕裂放松
+		for (int32 BatchIndex = 0; BatchIndex < BatchSize; ++BatchIndex)
+		{
+			const int32 Index = (FirstIndex + NumProcessed + BatchIndex) % NumComponents;
+			FClothTearState& Tearing = *TearStates[Index]->Tearing;
+			const FClothSimSnapshotSection& SimData = *SimDatas[Index];
+
+			for (FClothTear& Tear : Tearing.ActiveTears)
+			{
+				if (Tear.NewlyBrokenEdges.Num() == 0)
+				{
+					continue;
+				}
+
+				Points.Reset();
+				for (const int32 EdgeIndex : Tear.NewlyBrokenEdges)
+				{
+					const FClothTearGraph::FEdge& Edge = Tearing.Graph->Edges[EdgeIndex];
+					Points.Add(FVector3f(SimData.ComponentRelativeTransform.TransformPosition(FVector(SimData.Positions[Edge.VertexA]))));
+					Points.Add(FVector3f(SimData.ComponentRelativeTransform.TransformPosition(FVector(SimData.Positions[Edge.VertexB]))));
+				}
+
+				Tear.HoleIndex = Components[Index]->ExtendTearHole(Tear.HoleIndex, Points, Tear.MaterialID);
+				// 每条断开的边把前沿推进到一个新顶点
+				Components[Index]->AddTearDamage(Tearing.ClothingAssetIndex, SimData.Positions.Num(), Tear.NewlyBrokenEdges.Num());
+				Tear.NewlyBrokenEdges.Reset();
+			}
+
+			NumActiveTears -= Tearing.RemoveFinishedTears();
+		}
+
+		NumProcessed += BatchSize;
+	}
+
+	TearCursor = FirstIndex + NumProcessed;
+}
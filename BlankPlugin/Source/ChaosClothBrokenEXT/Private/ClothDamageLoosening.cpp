@@ -0,0 +1,198 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothDamageLoosening.h"
+#include "ClothSimSnapshot.h"
+#include "ClothingAsset.h"
+#include "ChaosCloth/ChaosClothConfig.h"
+#include "ChaosCloth/ChaosClothingSimulationInteractor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+namespace
+{
+	// 拴系刚度缩放的下限，拴系约束限制布料相对固定点的拉伸，刚度降为0时布料会被无限拉长
+	constexpr float MinTetherStiffnessScale = 0.5f;
+
+	/**
+	 * 按比例缩放一个布料资产的动画驱动和拴系刚度
+	 * @return 布料资产使用Chaos布料配置且找到了对应的交互器时返回true
+	 */
+	bool ApplyConstraintScale(UChaosClothingSimulationInteractor& Interactor, const USkeletalMesh& Mesh, int32 ClothingAssetIndex,
+		float AnimDriveScale, float TetherScale)
+	{
+		const TArray<TObjectPtr<UClothingAssetBase>>& ClothingAssets = Mesh.GetMeshClothingAssets();
+		const UClothingAssetCommon* ClothingAsset = ClothingAssets.IsValidIndex(ClothingAssetIndex) ? Cast<UClothingAssetCommon>(ClothingAssets[ClothingAssetIndex]) : nullptr;
+		const UChaosClothConfig* ClothConfig = ClothingAsset ? ClothingAsset->GetClothConfig<UChaosClothConfig>() : nullptr;
+		if (!ClothConfig)
+		{
+			return false;
+		}
+
+		UChaosClothingInteractor* ClothingInteractor = Cast<UChaosClothingInteractor>(Interactor.GetClothingInteractor(ClothingAsset->GetName()));
+		if (!ClothingInteractor)
+		{
+			return false;
+		}
+
+		// 基准值始终取资产配置，重复应用不会累积
+		ClothingInteractor->SetAnimDrive(
+			FVector2D(ClothConfig->AnimDriveStiffness.Low, ClothConfig->AnimDriveStiffness.High) * AnimDriveScale,
+			FVector2D(ClothConfig->AnimDriveDamping.Low, ClothConfig->AnimDriveDamping.High));
+		ClothingInteractor->SetLongRangeAttachment(
+			FVector2D(ClothConfig->TetherStiffness.Low, ClothConfig->TetherStiffness.High) * TetherScale,
+			FVector2D(ClothConfig->TetherScale.Low, ClothConfig->TetherScale.High));
+		return true;
+	}
+}
+
+int32 FClothDamageLooseningState::AddHoleDamage(const FClothSimSnapshot& Snapshot, const FVector3f& ComponentLocation, float Radius)
+{
+	const float RadiusSq = FMath::Square(Radius);
+	int32 NumNewlyDamaged = 0;
+
+	for (const FClothSimSnapshotSection& SimData : Snapshot.Sections)
+	{
+		// 先用包围盒排除不在破洞范围内的布料
+		const FVector3f SimCenter(SimData.ComponentRelativeTransform.InverseTransformPosition(FVector(ComponentLocation)));
+		if (SimData.Bounds.ComputeSquaredDistanceToPoint(SimCenter) > RadiusSq)
+		{
+			continue;
+		}
+
+		// 快照读取时已建立空间哈希，只检查破洞附近的粒子
+		int32 NumInRadius = 0;
+		SimData.ForEachParticleInRadius(SimCenter, Radius, [&NumInRadius](int32 Particle, float DistanceSq)
+		{
+			++NumInRadius;
+		});
+
+		if (NumInRadius > 0)
+		{
+			NumNewlyDamaged += AddDamage(SimData.ClothingAssetIndex, SimData.Positions.Num(), NumInRadius);
+		}
+	}
+
+	return NumNewlyDamaged;
+}
+
+int32 FClothDamageLooseningState::AddTearDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumTornParticles)
+{
+	return NumTornParticles > 0 ? AddDamage(ClothingAssetIndex, NumParticles, NumTornParticles) : 0;
+}
+
+int32 FClothDamageLooseningState::AddDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumDamagedParticles)
+{
+	FClothDamageLooseningSection* Section = Sections.FindByPredicate([ClothingAssetIndex](const FClothDamageLooseningSection& Existing)
+	{
+		return Existing.ClothingAssetIndex == ClothingAssetIndex;
+	});
+	if (!Section)
+	{
+		Section = &Sections.AddDefaulted_GetRef();
+		Section->ClothingAssetIndex = ClothingAssetIndex;
+	}
+
+	// 模拟LOD切换后粒子数量不再对应，重新开始
+	if (Section->NumParticles != NumParticles)
+	{
+		Section->NumParticles = NumParticles;
+		Section->NumDamagedParticles = 0;
+		Section->bDirty = true;
+	}
+
+	const int32 NumAdded = FMath::Min(NumDamagedParticles, Section->NumParticles - Section->NumDamagedParticles);
+	if (NumAdded > 0)
+	{
+		Section->NumDamagedParticles += NumAdded;
+		Section->bDirty = true;
+	}
+	return FMath::Max(NumAdded, 0);
+}
+
+bool FClothDamageLooseningState::ApplyPendingUpdate(USkeletalMeshComponent& SkeletalMeshComponent, float Looseness)
+{
+	UChaosClothingSimulationInteractor* Interactor = Cast<UChaosClothingSimulationInteractor>(SkeletalMeshComponent.GetClothingSimulationInteractor());
+	const USkeletalMesh* Mesh = SkeletalMeshComponent.GetSkeletalMeshAsset();
+	if (!Interactor || !Mesh)
+	{
+		return false;
+	}
+
+	bool bApplied = false;
+	for (FClothDamageLooseningSection& Section : Sections)
+	{
+		if (!Section.bDirty)
+		{
+			continue;
+		}
+
+		Section.bDirty = false;
+		const float Scale = FMath::Clamp(1.0f - Section.GetDamagedFraction() * Looseness, 0.0f, 1.0f);
+		bApplied |= ApplyConstraintScale(*Interactor, *Mesh, Section.ClothingAssetIndex, Scale, FMath::Max(Scale, MinTetherStiffnessScale));
+	}
+
+	return bApplied;
+}
+
+void FClothDamageLooseningState::Save(FArchive& Ar) const
+{
+	int32 NumSections = Sections.Num();
+	Ar << NumSections;
+
+	for (const FClothDamageLooseningSection& Section : Sections)
+	{
+		int32 ClothingAssetIndex = Section.ClothingAssetIndex;
+		int32 NumParticles = Section.NumParticles;
+		int32 NumDamagedParticles = Section.NumDamagedParticles;
+		Ar << ClothingAssetIndex << NumParticles << NumDamagedParticles;
+	}
+}
+
+bool FClothDamageLooseningState::Load(FArchive& Ar)
+{
+	Sections.Reset();
+
+	int32 NumSections = 0;
+	Ar << NumSections;
+
+	// 每个布料资产有索引、粒子数量和损伤粒子数量三个字段
+	if (NumSections < 0 || NumSections * 3 * (int64)sizeof(int32) > Ar.TotalSize() - Ar.Tell())
+	{
+		return false;
+	}
+	Sections.SetNum(NumSections);
+
+	for (FClothDamageLooseningSection& Section : Sections)
+	{
+		Ar << Section.ClothingAssetIndex << Section.NumParticles << Section.NumDamagedParticles;
+		if (Section.NumParticles < 0 || Section.NumDamagedParticles < 0 || Section.NumDamagedParticles > Section.NumParticles)
+		{
+			Sections.Reset();
+			return false;
+		}
+		Section.bDirty = Section.NumDamagedParticles > 0;
+	}
+
+	if (Ar.IsError())
+	{
+		Sections.Reset();
+		return false;
+	}
+	return true;
+}
+
+void FClothDamageLooseningState::Reset(USkeletalMeshComponent* SkeletalMeshComponent)
+{
+	UChaosClothingSimulationInteractor* Interactor = SkeletalMeshComponent ? Cast<UChaosClothingSimulationInteractor>(SkeletalMeshComponent->GetClothingSimulationInteractor()) : nullptr;
+	const USkeletalMesh* Mesh = SkeletalMeshComponent ? SkeletalMeshComponent->GetSkeletalMeshAsset() : nullptr;
+	if (Interactor && Mesh)
+	{
+		// 已应用过的损伤可能已被清零但尚未重新应用，所有记录过的布料资产都恢复
+		for (const FClothDamageLooseningSection& Section : Sections)
+		{
+			ApplyConstraintScale(*Interactor, *Mesh, Section.ClothingAssetIndex, 1.0f, 1.0f);
+		}
+	}
+
+	Sections.Reset();
+}
@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothFragmentAssetCache.h"
+#include "ClothBreakMemory.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/Material.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "MeshDescription.h"
+#include "MeshDescriptionBuilder.h"
+#include "StaticMeshAttributes.h"
+
+namespace ClothFragmentAssetCache
+{
+	/** 向网格描述追加一个四边形面 */
+	void AppendQuad(FMeshDescriptionBuilder& Builder, const FPolygonGroupID& GroupID,
+		const FVector& P0, const FVector& P1, const FVector& P2, const FVector& P3, const FVector& Normal)
+	{
+		const FVector Positions[4] = { P0, P1, P2, P3 };
+		const FVector2D UVs[4] = { FVector2D(0, 0), FVector2D(1, 0), FVector2D(1, 1), FVector2D(0, 1) };
+
+		FVertexInstanceID Instances[4];
+		for (int32 i = 0; i < 4; ++i)
+		{
+			const FVertexID VertexID = Builder.AppendVertex(Positions[i]);
+			Instances[i] = Builder.AppendInstance(VertexID);
+			Builder.SetInstanceNormal(Instances[i], Normal);
+			Builder.SetInstanceUV(Instances[i], UVs[i], 0);
+		}
+
+		Builder.AppendTriangle(Instances[0], Instances[1], Instances[2], GroupID);
+		Builder.AppendTriangle(Instances[0], Instances[2], Instances[3], GroupID);
+	}
+
+	/** 向网格描述追加一个以原点为中心的长方体 */
+	void AppendBox(FMeshDescriptionBuilder& Builder, const FPolygonGroupID& GroupID, const FVector& Extent)
+	{
+		const float X = Extent.X;
+		const float Y = Extent.Y;
+		const float Z = Extent.Z;
+
+		AppendQuad(Builder, GroupID, FVector(-X, -Y, Z), FVector(X, -Y, Z), FVector(X, Y, Z), FVector(-X, Y, Z), FVector::UpVector);
+		AppendQuad(Builder, GroupID, FVector(-X, Y, -Z), FVector(X, Y, -Z), FVector(X, -Y, -Z), FVector(-X, -Y, -Z), FVector::DownVector);
+		AppendQuad(Builder, GroupID, FVector(X, -Y, -Z), FVector(X, Y, -Z), FVector(X, Y, Z), FVector(X, -Y, Z), FVector::ForwardVector);
+		AppendQuad(Builder, GroupID, FVector(-X, Y, -Z), FVector(-X, -Y, -Z), FVector(-X, -Y, Z), FVector(-X, Y, Z), FVector::BackwardVector);
+		AppendQuad(Builder, GroupID, FVector(X, Y, -Z), FVector(-X, Y, -Z), FVector(-X, Y, Z), FVector(X, Y, Z), FVector::RightVector);
+		AppendQuad(Builder, GroupID, FVector(-X, -Y, -Z), FVector(X, -Y, -Z), FVector(X, -Y, Z), FVector(-X, -Y, Z), FVector::LeftVector);
+	}
+
+	/** 各形状类别在单位尺寸下的半尺寸 */
+	FVector GetShapeExtent(EClothFragmentShape Shape, float Size)
+	{
+		// 布料碎片很薄，厚度取尺寸的一小部分，同时保证碰撞体不会退化
+		const float Thickness = FMath::Max(Size * 0.05f, 0.1f);
+
+		switch (Shape)
+		{
+		case EClothFragmentShape::Strip:
+			return FVector(Size, Size * 0.25f, Thickness);
+		case EClothFragmentShape::Patch:
+		default:
+			return FVector(Size * 0.5f, Size * 0.5f, Thickness);
+		}
+	}
+}
+
+UClothFragmentAssetCache* UClothFragmentAssetCache::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UClothFragmentAssetCache>() : nullptr;
+}
+
+void UClothFragmentAssetCache::Deinitialize()
+{
+	FragmentMeshes.Empty();
+
+	Super::Deinitialize();
+}
+
+UStaticMesh* UClothFragmentAssetCache::GetFragmentMesh(EClothFragmentShape Shape, float Size, float& OutQuantizedSize)
+{
+	const int32 SizeBucket = QuantizeSize(Size);
+	OutQuantizedSize = GetBucketSize(SizeBucket);
+
+	const uint32 ShapeKey = MakeShapeKey(Shape, SizeBucket);
+	if (TObjectPtr<UStaticMesh>* CachedMesh = FragmentMeshes.Find(ShapeKey))
+	{
+		return *CachedMesh;
+	}
+
+	LLM_SCOPE_BYTAG(ClothBreak_Fragments);
+	UStaticMesh* NewMesh = BuildFragmentMesh(Shape, OutQuantizedSize);
+	if (NewMesh)
+	{
+		FragmentMeshes.Add(ShapeKey, NewMesh);
+		UE_LOG(LogTemp, Log, TEXT("Built shared fragment mesh: Shape=%d, Size=%f, Cached=%d"),
+			static_cast<int32>(Shape), OutQuantizedSize, FragmentMeshes.Num());
+	}
+
+	return NewMesh;
+}
+
+int64 UClothFragmentAssetCache::GetMemorySize() const
+{
+	int64 Bytes = FragmentMeshes.GetAllocatedSize();
+	for (const TPair<uint32, TObjectPtr<UStaticMesh>>& Pair : FragmentMeshes)
+	{
+		Bytes += ClothBreakMemory::GetObjectSize(Pair.Value);
+	}
+	return Bytes;
+}
+
+int32 UClothFragmentAssetCache::QuantizeSize(float Size)
+{
+	if (Size <= MinBucketSize)
+	{
+		return 0;
+	}
+
+	// 按几何级数划分档位，相邻档位的尺寸误差不超过BucketRatio的一半
+	const float Bucket = FMath::Loge(Size / MinBucketSize) / FMath::Loge(BucketRatio);
+	return FMath::Clamp(FMath::RoundToInt(Bucket), 0, MaxSizeBuckets - 1);
+}
+
+float UClothFragmentAssetCache::GetBucketSize(int32 SizeBucket)
+{
+	return MinBucketSize * FMath::Pow(BucketRatio, static_cast<float>(SizeBucket));
+}
+
+UStaticMesh* UClothFragmentAssetCache::BuildFragmentMesh(EClothFragmentShape Shape, float Size)
+{
+	const FVector Extent = ClothFragmentAssetCache::GetShapeExtent(Shape, Size);
+
+	// 构建网格描述
+	FMeshDescription MeshDescription;
+	FStaticMeshAttributes Attributes(MeshDescription);
+	Attributes.Register();
+
+	FMeshDescriptionBuilder Builder;
+	Builder.SetMeshDescription(&MeshDescription);
+	Builder.EnablePolyGroups();
+	Builder.SetNumUVLayers(1);
+
+	const FPolygonGroupID GroupID = Builder.AppendPolygonGroup(TEXT("Fragment"));
+	ClothFragmentAssetCache::AppendBox(Builder, GroupID, Extent);
+
+	// 创建静态网格并生成渲染数据
+	const FName MeshName = MakeUniqueObjectName(this, UStaticMesh::StaticClass(), TEXT("ClothFragmentMesh"));
+	UStaticMesh* StaticMesh = NewObject<UStaticMesh>(this, MeshName, RF_Transient);
+	StaticMesh->GetStaticMaterials().Add(FStaticMaterial(UMaterial::GetDefaultMaterial(MD_Surface), TEXT("Fragment")));
+
+	UStaticMesh::FBuildMeshDescriptionsParams BuildParams;
+	BuildParams.bFastBuild = true;
+	BuildParams.bBuildSimpleCollision = false;
+	BuildParams.bAllowCpuAccess = false;
+
+	TArray<const FMeshDescription*> MeshDescriptions;
+	MeshDescriptions.Add(&MeshDescription);
+	if (!StaticMesh->BuildFromMeshDescriptions(MeshDescriptions, BuildParams))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to build fragment mesh"));
+		return nullptr;
+	}
+
+	// 使用简单凸包碰撞，避免为每个碎片烘焙复杂碰撞
+	StaticMesh->CreateBodySetup();
+	UBodySetup* BodySetup = StaticMesh->GetBodySetup();
+	if (BodySetup)
+	{
+		BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		BodySetup->AggGeom.BoxElems.Add(FKBoxElem(Extent.X * 2.0f, Extent.Y * 2.0f, Extent.Z * 2.0f));
+		BodySetup->CreatePhysicsMeshes();
+	}
+
+	return StaticMesh;
+}
@@ -1,9 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ClothFragmentGenerator.h"
+#include "ClothFragmentAssetCache.h"
+#include "ClothBreakFrameArena.h"
+#include "ClothBreakMemory.h"
+#include "ClothBreakConsoleVariables.h"
 #include "Components/StaticMeshComponent.h"
-#include "Components/SphereComponent.h"
-#include "Materials/MaterialInstanceDynamic.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/StaticMesh.h"
 #include "TimerManager.h"
@@ -16,7 +18,8 @@ UClothFragmentGenerator::UClothFragmentGenerator()
 
 bool UClothFragmentGenerator::GenerateFragmentsFromCloth(USkeletalMeshComponent* SkeletalMeshComponent,
     const FVector& ImpactLocation, float ImpactRadius, int32 MaterialID,
-    int32 FragmentCount, float MinSize, float MaxSize)
+    int32 FragmentCount, float MinSize, float MaxSize, EClothFragmentStrategy Strategy, bool bSimulatePhysics,
+    FVector ImpactNormal, float FragmentMass, float FragmentLifetime)
 {
     if (!SkeletalMeshComponent || !SkeletalMeshComponent->SkeletalMesh)
     {
@@ -24,109 +27,251 @@ bool UClothFragmentGenerator::GenerateFragmentsFromCloth(USkeletalMeshComponent*
         return false;
     }
 
+    // 画质档位限制单次断裂的碎片数量，只保留破洞或不模拟物理的档位不生成碎片
+    FragmentCount = FMath::Min(FragmentCount, ClothBreakCVars::GetQualityTier().MaxFragmentsPerBreak);
+    if (FragmentCount <= 0)
+    {
+        return false;
+    }
+
+    // 先在帧内临时数组中规划全部碎片，再统一生成
+    TClothFrameArray<FClothFragmentSpawnParams> SpawnList;
+    SpawnList.SetNumUninitialized(MaxFragmentsPerBreak);
+
+    FRandomStream RandomStream(FMath::Rand());
+    const FVector PlanNormal = ResolveImpactNormal(ImpactNormal, ImpactLocation, SkeletalMeshComponent->Bounds.Origin);
+    const int32 NumPlanned = PlanFragments(Strategy, RandomStream, ImpactLocation, PlanNormal, ImpactRadius,
+        FragmentCount, MinSize, MaxSize, SpawnList);
+
+    const int32 NumSpawned = SpawnFragments(MakeArrayView(SpawnList.GetData(), NumPlanned),
+        ResolveFragmentMaterial(SkeletalMeshComponent, MaterialID), bSimulatePhysics, false, FragmentMass, FragmentLifetime);
+
+    return NumSpawned > 0;
+}
+
+int32 UClothFragmentGenerator::PlanFragments(EClothFragmentStrategy Strategy, FRandomStream& RandomStream, const FVector& ImpactLocation,
+    const FVector& ImpactNormal, float ImpactRadius, int32 FragmentCount, float MinSize, float MaxSize,
+    TArrayView<FClothFragmentSpawnParams> OutSpawnParams)
+{
+    // 碎片倍率为0时不生成碎片
+    const int32 ActualFragmentCount = FMath::Min(FMath::Clamp(FragmentCount, 0, MaxFragmentsPerBreak), OutSpawnParams.Num());
+    if (ActualFragmentCount <= 0)
+    {
+        return 0;
+    }
+
+    FClothFragmentPlanContext Context;
+    Context.ImpactLocation = ImpactLocation;
+    Context.ImpactNormal = ImpactNormal;
+    Context.ImpactRadius = ImpactRadius;
+    Context.MinSize = MinSize;
+    Context.MaxSize = FMath::Max(MaxSize, MinSize);
+
+    // 策略在这里分派一次，逐碎片的循环按策略类型单独实例化
+    ClothFragmentStrategies::PlanFragments(Strategy, RandomStream, Context, ActualFragmentCount, OutSpawnParams);
+
+    return ActualFragmentCount;
+}
+
+FVector UClothFragmentGenerator::ResolveImpactNormal(const FVector& Normal, const FVector& ImpactLocation, const FVector& BoundsOrigin)
+{
+    if (!Normal.IsNearlyZero())
+    {
+        return Normal.GetSafeNormal();
+    }
+
+    // 布料大体包裹在网格体外侧，包围盒中心指向冲击点的方向近似为外法线
+    return (ImpactLocation - BoundsOrigin).GetSafeNormal(UE_KINDA_SMALL_NUMBER, FVector::UpVector);
+}
+
+UMaterialInterface* UClothFragmentGenerator::ResolveFragmentMaterial(USkeletalMeshComponent* SkeletalMeshComponent, int32 MaterialID)
+{
+    if (!SkeletalMeshComponent || SkeletalMeshComponent->GetNumMaterials() <= 0)
+    {
+        return nullptr;
+    }
+
+    // 如果指定了材质ID且有效，则使用该材质，否则使用第一个材质
+    if (MaterialID >= 0 && MaterialID < SkeletalMeshComponent->GetNumMaterials())
+    {
+        return SkeletalMeshComponent->GetMaterial(MaterialID);
+    }
+
+    return SkeletalMeshComponent->GetMaterial(0);
+}
+
+int32 UClothFragmentGenerator::SpawnFragments(TConstArrayView<FClothFragmentSpawnParams> SpawnParams, UMaterialInterface* Material, bool bSimulatePhysics,
+    bool bHidden, float FragmentMass, float FragmentLifetime)
+{
     // 清理之前生成的碎片
     CleanupOldFragments();
 
-    // 获取材质
-    UMaterialInterface* ClothMaterial = nullptr;
-    if (SkeletalMeshComponent->GetNumMaterials() > 0)
+    LLM_SCOPE_BYTAG(ClothBreak_Fragments);
+    GeneratedFragments.Reserve(GeneratedFragments.Num() + SpawnParams.Num());
+
+    int32 NumSpawned = 0;
+    for (const FClothFragmentSpawnParams& Params : SpawnParams)
     {
-        // 如果指定了材质ID且有效，则使用该材质
-        if (MaterialID >= 0 && MaterialID < SkeletalMeshComponent->GetNumMaterials())
+        AActor* Fragment = CreateSimpleFragment(Params, Material, bSimulatePhysics, bHidden, FragmentMass, FragmentLifetime);
+        if (Fragment)
         {
-            ClothMaterial = SkeletalMeshComponent->GetMaterial(MaterialID);
+            GeneratedFragments.Add(Fragment);
+            ++NumSpawned;
         }
-        else
+    }
+
+    UE_LOG(LogTemp, Verbose, TEXT("Generated %d simple fragments"), NumSpawned);
+    return NumSpawned;
+}
+
+void UClothFragmentGenerator::DestroyAllFragments()
+{
+    for (AActor* Fragment : GeneratedFragments)
+    {
+        if (IsValid(Fragment))
         {
-            // 否则使用第一个材质
-            ClothMaterial = SkeletalMeshComponent->GetMaterial(0);
+            Fragment->Destroy();
         }
     }
+    GeneratedFragments.Reset();
+}
 
-    // 生成随机碎片
-    int32 ActualFragmentCount = FMath::Clamp(FragmentCount, 1, 20);
-    for (int32 i = 0; i < ActualFragmentCount; ++i)
+int32 UClothFragmentGenerator::GetNumLiveFragments() const
+{
+    int32 NumLive = 0;
+    for (const AActor* Fragment : GeneratedFragments)
     {
-        // 随机大小
-        float FragmentSize = FMath::RandRange(MinSize, MaxSize);
-
-        // 随机位置 (在碰撞半径内)
-        FVector RandomOffset = FMath::VRand() * FMath::RandRange(0.0f, ImpactRadius * 0.8f);
-        FVector FragmentLocation = ImpactLocation + RandomOffset;
-
-        // 创建碎片
-        AActor* Fragment = CreateSimpleFragment(FragmentLocation, FragmentSize, ClothMaterial);
-        if (Fragment)
+        if (IsValid(Fragment))
         {
-            GeneratedFragments.Add(Fragment);
+            ++NumLive;
         }
     }
+    return NumLive;
+}
 
-    UE_LOG(LogTemp, Log, TEXT("Generated %d simple fragments"), GeneratedFragments.Num());
-    return GeneratedFragments.Num() > 0;
+int64 UClothFragmentGenerator::GetFragmentMemorySize() const
+{
+    int64 Bytes = GeneratedFragments.GetAllocatedSize();
+    for (AActor* Fragment : GeneratedFragments)
+    {
+        if (!IsValid(Fragment))
+        {
+            continue;
+        }
+
+        Bytes += ClothBreakMemory::GetObjectSize(Fragment);
+        Fragment->ForEachComponent(false, [&Bytes](UActorComponent* Component)
+        {
+            Bytes += ClothBreakMemory::GetObjectSize(Component);
+        });
+    }
+    return Bytes;
 }
 
-AActor* UClothFragmentGenerator::CreateSimpleFragment(const FVector& WorldLocation, float Size, UMaterialInterface* Material)
+AActor* UClothFragmentGenerator::CreateSimpleFragment(const FClothFragmentSpawnParams& SpawnParams, UMaterialInterface* Material, bool bSimulatePhysics,
+    bool bHidden, float FragmentMass, float FragmentLifetime)
 {
     UWorld* World = GetWorld();
-    if (!World)
+    UClothFragmentAssetCache* AssetCache = UClothFragmentAssetCache::Get();
+    if (!World || !AssetCache)
     {
         return nullptr;
     }
 
+    // 从共享缓存获取碎片网格，相同形状和尺寸档位的碎片共用同一网格及碰撞
+    float QuantizedSize = SpawnParams.Size;
+    UStaticMesh* FragmentMesh = AssetCache->GetFragmentMesh(SpawnParams.Shape, SpawnParams.Size, QuantizedSize);
+    if (!FragmentMesh)
+    {
+        return nullptr;
+    }
+
+    // 只有随碎片保留下来的Actor、组件、物理体和定时器单独计数，共享网格查找和碎片列表的分配仍计为临时分配
+    FClothBreakAllocationCounter::FKeptScope KeptScope;
+
     // 创建一个空的Actor
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+    FActorSpawnParameters ActorSpawnParams;
+    ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-    AActor* FragmentActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(WorldLocation), SpawnParams);
+    AActor* FragmentActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(SpawnParams.Location), ActorSpawnParams);
     if (!FragmentActor)
     {
         return nullptr;
     }
 
-    // 添加一个球体组件作为碎片
-    USphereComponent* SphereComp = NewObject<USphereComponent>(FragmentActor, TEXT("SphereComp"));
-    if (SphereComp)
+    // 添加一个引用共享网格的静态网格组件作为碎片
+    UStaticMeshComponent* MeshComp = NewObject<UStaticMeshComponent>(FragmentActor, TEXT("MeshComp"));
+    if (MeshComp)
     {
-        SphereComp->SetSphereRadius(Size);
-        SphereComp->SetCollisionProfileName(TEXT("PhysicsActor"));
-        SphereComp->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-        SphereComp->SetGenerateOverlapEvents(true);
+        MeshComp->SetStaticMesh(FragmentMesh);
 
-        // 设置材质
+        // 低画质档位不模拟物理，碎片也不参与碰撞，省去物理体的创建
+        if (bSimulatePhysics)
+        {
+            MeshComp->SetCollisionProfileName(TEXT("PhysicsActor"));
+            MeshComp->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+            MeshComp->SetGenerateOverlapEvents(true);
+        }
+        else
+        {
+            MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+            MeshComp->SetGenerateOverlapEvents(false);
+        }
+
+        // 直接使用源材质，单个碎片的差异通过自定义图元数据传入，不创建新的材质对象
         if (Material)
         {
-            UMaterialInstanceDynamic* DynMaterial = UMaterialInstanceDynamic::Create(Material, this);
-            if (DynMaterial)
-            {
-                SphereComp->SetMaterial(0, DynMaterial);
-            }
+            MeshComp->SetMaterial(0, Material);
         }
 
-        // 注册组件
-        SphereComp->RegisterComponent();
+        ApplyFragmentVariation(MeshComp, FLinearColor(SpawnParams.Brightness, SpawnParams.Brightness, SpawnParams.Brightness), 1.0f, 0.0f);
+
+        // 注册前隐藏，渲染代理创建时即为隐藏状态
+        if (bHidden)
+        {
+            MeshComp->SetHiddenInGame(true);
+        }
 
-        // 设置为根组件
-        FragmentActor->SetRootComponent(SphereComp);
+        // 设置为根组件并注册，空Actor没有根组件时不保留生成位置，需要显式设置变换
+        FragmentActor->SetRootComponent(MeshComp);
+        MeshComp->SetWorldLocationAndRotation(SpawnParams.Location, SpawnParams.Rotation);
+        MeshComp->RegisterComponent();
 
         // 设置物理属性
-        SetupFragmentPhysics(SphereComp);
+        if (bSimulatePhysics)
+        {
+            SetupFragmentPhysics(MeshComp, FragmentMass);
+        }
     }
 
-    // 设置Actor名称
+#if WITH_EDITOR
+    // 设置Actor名称（仅编辑器，避免运行时格式化字符串）
     FragmentActor->SetActorLabel(FString::Printf(TEXT("ClothFragment_%d"), GeneratedFragments.Num()));
+#endif
 
     // 设置自动销毁定时器
-    float LifeTime = 5.0f; // 默认生命周期
     FTimerHandle TimerHandle;
     FTimerDelegate TimerDelegate;
     TimerDelegate.BindUFunction(this, FName("DestroyFragment"), FragmentActor);
-    World->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, LifeTime, false);
+    World->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, FMath::Max(FragmentLifetime, UE_KINDA_SMALL_NUMBER), false);
 
     return FragmentActor;
 }
 
-bool UClothFragmentGenerator::SetupFragmentPhysics(UPrimitiveComponent* FragmentComponent)
+void UClothFragmentGenerator::ApplyFragmentVariation(UPrimitiveComponent* FragmentComponent,
+    const FLinearColor& Tint, float Fade, float Burn)
+{
+    if (!FragmentComponent)
+    {
+        return;
+    }
+
+    FragmentComponent->SetCustomPrimitiveDataVector3(ClothFragmentPrimitiveData::Tint, FVector(Tint.R, Tint.G, Tint.B));
+    FragmentComponent->SetCustomPrimitiveDataFloat(ClothFragmentPrimitiveData::Fade, Fade);
+    FragmentComponent->SetCustomPrimitiveDataFloat(ClothFragmentPrimitiveData::Burn, Burn);
+}
+
+bool UClothFragmentGenerator::SetupFragmentPhysics(UPrimitiveComponent* FragmentComponent, float FragmentMass)
 {
     if (!FragmentComponent)
     {
@@ -137,8 +282,7 @@ bool UClothFragmentGenerator::SetupFragmentPhysics(UPrimitiveComponent* Fragment
     FragmentComponent->SetSimulatePhysics(true);
 
     // 设置质量
-    float Mass = 10.0f; // 默认质量
-    FragmentComponent->SetMassOverrideInKg(NAME_None, Mass);
+    FragmentComponent->SetMassOverrideInKg(NAME_None, FragmentMass);
 
     // 添加初始冲量
     FVector RandomImpulse = FMath::VRand() * 100.0f;
@@ -159,7 +303,7 @@ void UClothFragmentGenerator::CleanupOldFragments()
     }
 
     // 如果碎片数量超过限制，则销毁最旧的碎片
-    const int32 MaxFragments = 50; // 最大碎片数量限制
+    const int32 MaxFragments = ClothBreakCVars::GetMaxLiveFragments(); // 最大碎片数量限制
     if (GeneratedFragments.Num() > MaxFragments)
     {
         int32 NumToRemove = GeneratedFragments.Num() - MaxFragments;
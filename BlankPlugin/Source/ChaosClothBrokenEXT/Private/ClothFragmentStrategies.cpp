@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothFragmentStrategies.h"
+#include "ClothFragmentGenerator.h"
+#include "HAL/IConsoleManager.h"
+
+namespace ClothFragmentStrategies
+{
+	void PlanFragments(EClothFragmentStrategy Strategy, FRandomStream& RandomStream,
+		const FClothFragmentPlanContext& Context, int32 FragmentCount, TArrayView<FClothFragmentSpawnParams> OutSpawnParams)
+	{
+		switch (Strategy)
+		{
+		case EClothFragmentStrategy::BakedCells:
+			PlanFragmentsWithStrategy<FSpiralCells>(RandomStream, Context, FragmentCount, OutSpawnParams);
+			break;
+
+		case EClothFragmentStrategy::LocalVoronoi:
+			PlanFragmentsWithStrategy<FLocalVoronoi>(RandomStream, Context, FragmentCount, OutSpawnParams);
+			break;
+
+		case EClothFragmentStrategy::StripTear:
+			PlanFragmentsWithStrategy<FStripTear>(RandomStream, Context, FragmentCount, OutSpawnParams);
+			break;
+
+		case EClothFragmentStrategy::SphereDebris:
+		default:
+			PlanFragmentsWithStrategy<FSphereDebris>(RandomStream, Context, FragmentCount, OutSpawnParams);
+			break;
+		}
+	}
+
+	/** 对一个策略计时，所有策略使用相同的输入和种子 */
+	template<typename TStrategy>
+	static double TimeStrategy(TConstArrayView<FClothFragmentPlanContext> Contexts, int32 Iterations,
+		TArrayView<FClothFragmentSpawnParams> Scratch, double& OutChecksum)
+	{
+		const double StartSeconds = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const FClothFragmentPlanContext& Context = Contexts[Iteration % Contexts.Num()];
+			FRandomStream RandomStream(Iteration);
+			PlanFragmentsWithStrategy<TStrategy>(RandomStream, Context, Scratch.Num(), Scratch);
+
+			// 累加结果，避免规划被优化掉
+			OutChecksum += Scratch[Iteration % Scratch.Num()].Size;
+		}
+		return (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+	}
+
+	void RunBenchmark(int32 Iterations)
+	{
+		Iterations = FMath::Max(Iterations, 1);
+
+		// 固定的一组冲击输入
+		TArray<FClothFragmentPlanContext> Contexts;
+		FRandomStream InputStream(0x434C4F54);
+		for (int32 i = 0; i < 64; ++i)
+		{
+			FClothFragmentPlanContext& Context = Contexts.AddDefaulted_GetRef();
+			Context.ImpactLocation = InputStream.GetUnitVector() * 100.0f;
+			Context.ImpactNormal = InputStream.GetUnitVector();
+			Context.ImpactRadius = InputStream.FRandRange(5.0f, 40.0f);
+			Context.MinSize = 5.0f;
+			Context.MaxSize = 20.0f;
+		}
+
+		TArray<FClothFragmentSpawnParams> Scratch;
+		Scratch.SetNum(UClothFragmentGenerator::MaxFragmentsPerBreak);
+
+		double Checksum = 0.0;
+		const double Timings[] =
+		{
+			TimeStrategy<FSphereDebris>(Contexts, Iterations, Scratch, Checksum),
+			TimeStrategy<FSpiralCells>(Contexts, Iterations, Scratch, Checksum),
+			TimeStrategy<FLocalVoronoi>(Contexts, Iterations, Scratch, Checksum),
+			TimeStrategy<FStripTear>(Contexts, Iterations, Scratch, Checksum),
+		};
+		static_assert(UE_ARRAY_COUNT(Timings) == (int32)EClothFragmentStrategy::Count, "Benchmark must cover every strategy");
+
+		const double NumFragments = (double)Iterations * Scratch.Num();
+		for (int32 StrategyIndex = 0; StrategyIndex < (int32)EClothFragmentStrategy::Count; ++StrategyIndex)
+		{
+			UE_LOG(LogTemp, Log, TEXT("%-14s %8.3f ms total, %7.1f ns per fragment"),
+				*StaticEnum<EClothFragmentStrategy>()->GetNameStringByIndex(StrategyIndex),
+				Timings[StrategyIndex], Timings[StrategyIndex] * 1000000.0 / NumFragments);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Fragment strategy benchmark: %d breaks x %d fragments (checksum %.1f)"),
+			Iterations, Scratch.Num(), Checksum);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("ClothBreak.BenchmarkStrategies"),
+		TEXT("Time every fragment strategy on the same impacts. Usage: ClothBreak.BenchmarkStrategies [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+		}));
+}
@@ -0,0 +1,639 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothHoleMask.h"
+#include "Engine/SkeletalMesh.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkinnedAssetCommon.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Rendering/SkinWeightVertexBuffer.h"
+#include "ClothBreakRegionData.h"
+#include "ClothBreakMemory.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#endif
+
+FName ClothHoleMask::GetParameterName(int32 Index)
+{
+	static const FName ParameterNames[MaxHoles] =
+	{
+		TEXT("ClothHole0"), TEXT("ClothHole1"), TEXT("ClothHole2"), TEXT("ClothHole3"),
+		TEXT("ClothHole4"), TEXT("ClothHole5"), TEXT("ClothHole6"), TEXT("ClothHole7"),
+	};
+	static_assert(UE_ARRAY_COUNT(ParameterNames) == MaxHoles, "Parameter names must cover every hole slot");
+
+	return ParameterNames[Index];
+}
+
+FIntVector FClothSurfaceUVTable::GetCell(const FVector3f& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Position.X / CellSize),
+		FMath::FloorToInt(Position.Y / CellSize),
+		FMath::FloorToInt(Position.Z / CellSize));
+}
+
+int32 FClothSurfaceUVTable::FindNearestVertex(const FVector3f& Position, int32 MaterialID) const
+{
+	const FIntVector Center = GetCell(Position);
+	int32 BestVertex = INDEX_NONE;
+	float BestDistanceSquared = UE_BIG_NUMBER;
+
+	// 只搜索相邻的27个单元
+	for (int32 Z = -1; Z <= 1; ++Z)
+	{
+		for (int32 Y = -1; Y <= 1; ++Y)
+		{
+			for (int32 X = -1; X <= 1; ++X)
+			{
+				const TPair<int32, int32>* Cell = Cells.Find(Center + FIntVector(X, Y, Z));
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (int32 i = Cell->Key; i < Cell->Key + Cell->Value; ++i)
+				{
+					const int32 Vertex = SortedVertices[i];
+					if (MaterialID >= 0 && MaterialIndices[Vertex] != MaterialID)
+					{
+						continue;
+					}
+
+					const float DistanceSquared = FVector3f::DistSquared(Positions[Vertex], Position);
+					if (DistanceSquared < BestDistanceSquared)
+					{
+						BestDistanceSquared = DistanceSquared;
+						BestVertex = Vertex;
+					}
+				}
+			}
+		}
+	}
+
+	return BestVertex;
+}
+
+FVector3f FClothSurfaceUVTable::ToBindPose(const FVector3f& Location, const FClothBindPoseMapping& Mapping, int32 HitBone) const
+{
+	if (!Mapping.IsValidFor(*this))
+	{
+		return Location;
+	}
+
+	// 命中的骨骼直接决定所在的肢体；关节距离只是近似，长骨骼中段的点可能更靠近相邻骨骼的关节
+	int32 SeedBone = HitBone != INDEX_NONE ? UsedBones.IndexOfByKey(HitBone) : INDEX_NONE;
+	if (SeedBone == INDEX_NONE)
+	{
+		float NearestDistanceSquared = UE_BIG_NUMBER;
+		for (int32 Bone = 0; Bone < Mapping.BonePositions.Num(); ++Bone)
+		{
+			const float DistanceSquared = FVector3f::DistSquared(Mapping.BonePositions[Bone], Location);
+			if (DistanceSquared < NearestDistanceSquared)
+			{
+				NearestDistanceSquared = DistanceSquared;
+				SeedBone = Bone;
+			}
+		}
+	}
+
+	// 用初始骨骼的逆变换得到估计位置
+	const FVector3f Estimate = Mapping.ToBindPose[SeedBone].TransformPosition(Location);
+	if (InfluenceBones.Num() != Positions.Num() * MaxInfluences)
+	{
+		return Estimate;
+	}
+
+	// 按附近顶点的蒙皮权重混合，与渲染时的线性蒙皮相互对应
+	const int32 Vertex = FindNearestVertex(Estimate, INDEX_NONE);
+	if (Vertex == INDEX_NONE)
+	{
+		return Estimate;
+	}
+
+	FVector3f Blended = FVector3f::ZeroVector;
+	float TotalWeight = 0.0f;
+	for (int32 Influence = Vertex * MaxInfluences; Influence < (Vertex + 1) * MaxInfluences; ++Influence)
+	{
+		const float Weight = InfluenceWeights[Influence];
+		if (Weight > 0.0f)
+		{
+			Blended += Mapping.ToBindPose[InfluenceBones[Influence]].TransformPosition(Location) * Weight;
+			TotalWeight += Weight;
+		}
+	}
+
+	return TotalWeight > 0.0f ? Blended / TotalWeight : Estimate;
+}
+
+bool FClothBindPoseMapping::Update(const FClothSurfaceUVTable& Table, const USkeletalMeshComponent& Component)
+{
+	const USkeletalMesh* Mesh = Component.GetSkeletalMeshAsset();
+	const int32 NumBones = Table.UsedBones.Num();
+
+	// 跟随主姿势时渲染使用主组件的组件空间姿势，骨骼按名称映射到主组件的骨骼索引
+	const USkinnedMeshComponent* LeaderComponent = Component.LeaderPoseComponent.Get();
+	const TArray<FTransform>& Pose = LeaderComponent ? LeaderComponent->GetComponentSpaceTransforms() : Component.GetComponentSpaceTransforms();
+	const TArray<int32>& LeaderBoneMap = Component.GetLeaderBoneMap();
+	if (!Mesh || NumBones == 0)
+	{
+		BonePositions.Reset();
+		ToBindPose.Reset();
+		return false;
+	}
+
+	const TArray<FMatrix44f>& RefBasesInvMatrix = Mesh->GetRefBasesInvMatrix();
+	BonePositions.SetNumUninitialized(NumBones);
+	ToBindPose.SetNumUninitialized(NumBones);
+
+	for (int32 Slot = 0; Slot < NumBones; ++Slot)
+	{
+		const int32 Bone = Table.UsedBones[Slot];
+		const int32 PoseBone = !LeaderComponent ? Bone : (LeaderBoneMap.IsValidIndex(Bone) ? LeaderBoneMap[Bone] : INDEX_NONE);
+		if (!Pose.IsValidIndex(PoseBone) || !RefBasesInvMatrix.IsValidIndex(Bone))
+		{
+			BonePositions.Reset();
+			ToBindPose.Reset();
+			return false;
+		}
+
+		// 蒙皮矩阵为参考姿势的逆乘以当前姿势，其逆把当前姿势的位置映射回参考姿势
+		BonePositions[Slot] = FVector3f(Pose[PoseBone].GetLocation());
+		ToBindPose[Slot] = (RefBasesInvMatrix[Bone] * FMatrix44f(Pose[PoseBone].ToMatrixWithScale())).Inverse();
+	}
+
+	return true;
+}
+
+namespace ClothSurfaceTableRegistry
+{
+	using FKey = TPair<TObjectKey<USkeletalMesh>, int32>;
+
+	// 只保存弱引用，所有组件释放后表随之释放
+	static TMap<FKey, TWeakPtr<const FClothSurfaceUVTable>> Tables;
+
+	// 构建失败后重试前的等待时间（秒）
+	static constexpr double FailedTableRetrySeconds = 30.0;
+
+	// 构建失败的表及允许重试的时间，避免每次请求都重新构建
+	static TMap<FKey, double> FailedTables;
+
+	/** 一次后台构建，网格体在构建完成前由强引用保持，不会被垃圾回收 */
+	struct FPendingBuild
+	{
+		TStrongObjectPtr<USkeletalMesh> Mesh;
+		TArray<TFunction<void(TSharedPtr<const FClothSurfaceUVTable>)>> Callbacks;
+	};
+
+	// 正在后台构建的表及等待结果的回调
+	static TMap<FKey, FPendingBuild> PendingBuilds;
+
+	/** 后台构建的输入，在游戏线程收集，烘焙数据复制一份，不在工作线程访问区域数据对象 */
+	struct FBuildInputs
+	{
+		const USkeletalMesh* Mesh = nullptr;
+		FString MeshName;
+		TArray<uint8> BakedData;
+		FString CacheKey;
+	};
+
+	/** 依次尝试烘焙数据、派生数据缓存和渲染数据，可在工作线程调用 */
+	static TSharedPtr<const FClothSurfaceUVTable> LoadOrBuild(const FBuildInputs& Inputs, int32 LODIndex)
+	{
+		// 优先使用随网格体烘焙的数据，运行时不需要读取渲染数据
+		if (Inputs.BakedData.Num() > 0)
+		{
+			if (TSharedPtr<FClothSurfaceUVTable> Table = FClothSurfaceUVTable::LoadFromBytes(Inputs.BakedData))
+			{
+				return Table;
+			}
+		}
+
+#if WITH_EDITOR
+		return FClothSurfaceUVTable::BuildCached(Inputs.Mesh, LODIndex, Inputs.CacheKey);
+#else
+		UE_LOG(LogTemp, Log, TEXT("No baked cloth region table for %s LOD%d, building at runtime"), *Inputs.MeshName, LODIndex);
+		return FClothSurfaceUVTable::Build(Inputs.Mesh, LODIndex);
+#endif
+	}
+
+	/** 在游戏线程登记构建结果并通知所有等待的回调 */
+	static void FinishBuild(const FKey& Key, TSharedPtr<const FClothSurfaceUVTable> Table)
+	{
+		check(IsInGameThread());
+
+		if (Table)
+		{
+			Tables.Add(Key, Table);
+		}
+		else
+		{
+			FailedTables.Add(Key, FPlatformTime::Seconds() + FailedTableRetrySeconds);
+		}
+
+		// 释放网格体的强引用也在游戏线程完成
+		FPendingBuild Build;
+		PendingBuilds.RemoveAndCopyValue(Key, Build);
+		for (const TFunction<void(TSharedPtr<const FClothSurfaceUVTable>)>& Callback : Build.Callbacks)
+		{
+			Callback(Table);
+		}
+	}
+}
+
+TSharedPtr<const FClothSurfaceUVTable> FClothSurfaceUVTable::Find(const USkeletalMesh* Mesh, int32 LODIndex)
+{
+	check(IsInGameThread());
+
+	return Mesh ? ClothSurfaceTableRegistry::Tables.FindRef(ClothSurfaceTableRegistry::FKey(Mesh, LODIndex)).Pin() : nullptr;
+}
+
+void FClothSurfaceUVTable::ForEachLoaded(TFunctionRef<void(const USkeletalMesh*, int32, const FClothSurfaceUVTable&)> Visitor)
+{
+	check(IsInGameThread());
+
+	for (const TPair<ClothSurfaceTableRegistry::FKey, TWeakPtr<const FClothSurfaceUVTable>>& Pair : ClothSurfaceTableRegistry::Tables)
+	{
+		if (TSharedPtr<const FClothSurfaceUVTable> Table = Pair.Value.Pin())
+		{
+			Visitor(Pair.Key.Key.ResolveObjectPtr(), Pair.Key.Value, *Table);
+		}
+	}
+}
+
+void FClothSurfaceUVTable::GetAsync(const USkeletalMesh* Mesh, int32 LODIndex, TFunction<void(TSharedPtr<const FClothSurfaceUVTable>)> OnComplete)
+{
+	using namespace ClothSurfaceTableRegistry;
+
+	check(IsInGameThread());
+	LLM_SCOPE_BYTAG(ClothBreak_Tables);
+
+	if (!Mesh || LODIndex < 0)
+	{
+		OnComplete(nullptr);
+		return;
+	}
+
+	const FKey Key(Mesh, LODIndex);
+	if (TSharedPtr<const FClothSurfaceUVTable> Table = Tables.FindRef(Key).Pin())
+	{
+		OnComplete(Table);
+		return;
+	}
+
+	if (const double* RetryTime = FailedTables.Find(Key))
+	{
+		if (FPlatformTime::Seconds() < *RetryTime)
+		{
+			OnComplete(nullptr);
+			return;
+		}
+		FailedTables.Remove(Key);
+	}
+
+	// 同一张表只构建一次，同时生成的角色共用一次构建
+	if (FPendingBuild* Pending = PendingBuilds.Find(Key))
+	{
+		Pending->Callbacks.Add(MoveTemp(OnComplete));
+		return;
+	}
+	FPendingBuild& Pending = PendingBuilds.Add(Key);
+	Pending.Mesh.Reset(const_cast<USkeletalMesh*>(Mesh));
+	Pending.Callbacks.Add(MoveTemp(OnComplete));
+
+	// 访问UObject的部分在游戏线程完成，后台只读取渲染数据和复制出的烘焙数据
+	FBuildInputs Inputs;
+	Inputs.Mesh = Mesh;
+	Inputs.MeshName = Mesh->GetName();
+	if (const UClothBreakRegionUserData* UserData = UClothBreakRegionUserData::Find(Mesh))
+	{
+		if (UserData->IsUpToDate(Mesh, LODIndex))
+		{
+			Inputs.BakedData = UserData->FindLOD(LODIndex)->Data;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Baked cloth region data for %s LOD%d does not match the mesh, rebuilding"), *Mesh->GetName(), LODIndex);
+		}
+	}
+#if WITH_EDITOR
+	Inputs.CacheKey = GetCacheKey(Mesh, LODIndex);
+#endif
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Inputs = MoveTemp(Inputs), Key, LODIndex]()
+	{
+		LLM_SCOPE_BYTAG(ClothBreak_Tables);
+		TSharedPtr<const FClothSurfaceUVTable> Table = LoadOrBuild(Inputs, LODIndex);
+		AsyncTask(ENamedThreads::GameThread, [Key, Table = MoveTemp(Table)]()
+		{
+			FinishBuild(Key, Table);
+		});
+	});
+}
+
+void FClothSurfaceUVTable::Invalidate(const USkeletalMesh* Mesh)
+{
+	using namespace ClothSurfaceTableRegistry;
+
+	check(IsInGameThread());
+
+	const TObjectKey<USkeletalMesh> MeshKey(Mesh);
+	for (auto It = Tables.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == MeshKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = FailedTables.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == MeshKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+#if WITH_EDITOR
+FString FClothSurfaceUVTable::GetCacheKey(const USkeletalMesh* Mesh, int32 LODIndex)
+{
+	// 网格体的派生数据键在重新导入或修改构建设置后变化
+	const FString KeySuffix = FString::Printf(TEXT("%s_LOD%d"), *const_cast<USkeletalMesh*>(Mesh)->GetDerivedDataKey(), LODIndex);
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("CLOTHBREAKREGION"), *FString::Printf(TEXT("V%u"), DataVersion), *KeySuffix);
+}
+
+TSharedPtr<FClothSurfaceUVTable> FClothSurfaceUVTable::BuildCached(const USkeletalMesh* Mesh, int32 LODIndex, const FString& CacheKey)
+{
+	TArray<uint8> Data;
+	if (GetDerivedDataCacheRef().GetSynchronous(*CacheKey, Data, Mesh->GetPathName()))
+	{
+		if (TSharedPtr<FClothSurfaceUVTable> Table = LoadFromBytes(Data))
+		{
+			return Table;
+		}
+	}
+
+	TSharedPtr<FClothSurfaceUVTable> Table = Build(Mesh, LODIndex);
+	if (Table)
+	{
+		Table->SaveToBytes(Data);
+		GetDerivedDataCacheRef().Put(*CacheKey, Data, Mesh->GetPathName());
+	}
+
+	return Table;
+}
+#endif
+
+void FClothSurfaceUVTable::Serialize(FArchive& Ar)
+{
+	Ar << Positions;
+	Ar << UVs;
+	Ar << MaterialIndices;
+	Ar << UVPerUnit;
+	Ar << UsedBones;
+	Ar << InfluenceBones;
+	Ar << InfluenceWeights;
+	Ar << CellSize;
+	Ar << Cells;
+	Ar << SortedVertices;
+}
+
+void FClothSurfaceUVTable::SaveToBytes(TArray<uint8>& OutData) const
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+
+	uint32 Version = DataVersion;
+	Writer << Version;
+	const_cast<FClothSurfaceUVTable*>(this)->Serialize(Writer);
+}
+
+TSharedPtr<FClothSurfaceUVTable> FClothSurfaceUVTable::LoadFromBytes(const TArray<uint8>& Data)
+{
+	FMemoryReader Reader(Data);
+
+	uint32 Version = 0;
+	Reader << Version;
+	if (Version != DataVersion)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FClothSurfaceUVTable> Table = MakeShared<FClothSurfaceUVTable>();
+	Table->Serialize(Reader);
+
+	// 数据不完整时丢弃，之后重新构建
+	if (Reader.IsError() || Table->UVs.Num() != Table->Positions.Num() || Table->MaterialIndices.Num() != Table->Positions.Num()
+		|| Table->SortedVertices.Num() != Table->Positions.Num() || Table->InfluenceWeights.Num() != Table->InfluenceBones.Num()
+		|| (Table->InfluenceBones.Num() > 0 && Table->InfluenceBones.Num() != Table->Positions.Num() * MaxInfluences))
+	{
+		return nullptr;
+	}
+
+	return Table;
+}
+
+namespace
+{
+	/** 记录顶点权重最大的几个骨骼影响，权重归一化到255 */
+	void AddSkinInfluences(FClothSurfaceUVTable& Table, const FSkinWeightVertexBuffer& SkinWeights, int32 NumSourceInfluences,
+		const TArray<FBoneIndexType>& BoneMap, TMap<int32, int32>& BoneSlots, uint32 Vertex)
+	{
+		TArray<TPair<uint32, int32>, TInlineAllocator<MAX_TOTAL_INFLUENCES>> Influences;
+		for (int32 Influence = 0; Influence < NumSourceInfluences; ++Influence)
+		{
+			const uint32 Weight = SkinWeights.GetBoneWeight(Vertex, Influence);
+			const int32 LocalBone = SkinWeights.GetBoneIndex(Vertex, Influence);
+			if (Weight > 0 && BoneMap.IsValidIndex(LocalBone))
+			{
+				Influences.Emplace(Weight, BoneMap[LocalBone]);
+			}
+		}
+
+		Influences.Sort([](const TPair<uint32, int32>& A, const TPair<uint32, int32>& B) { return A.Key > B.Key; });
+		Influences.SetNum(FMath::Min(Influences.Num(), FClothSurfaceUVTable::MaxInfluences));
+
+		uint32 TotalWeight = 0;
+		for (const TPair<uint32, int32>& Influence : Influences)
+		{
+			TotalWeight += Influence.Key;
+		}
+
+		int32 Remaining = MAX_uint8;
+		for (int32 Index = 0; Index < Influences.Num(); ++Index)
+		{
+			int32* Slot = BoneSlots.Find(Influences[Index].Value);
+			if (!Slot)
+			{
+				Slot = &BoneSlots.Add(Influences[Index].Value, Table.UsedBones.Add(Influences[Index].Value));
+			}
+
+			// 最后一个影响取余数，保证权重之和为255
+			const int32 Weight = Index == Influences.Num() - 1 ? Remaining : FMath::Min(Remaining, (int32)(Influences[Index].Key * MAX_uint8 / TotalWeight));
+			Remaining -= Weight;
+
+			const int32 Offset = Vertex * FClothSurfaceUVTable::MaxInfluences + Index;
+			Table.InfluenceBones[Offset] = (uint16)*Slot;
+			Table.InfluenceWeights[Offset] = (uint8)Weight;
+		}
+	}
+}
+
+TSharedPtr<FClothSurfaceUVTable> FClothSurfaceUVTable::Build(const USkeletalMesh* Mesh, int32 LODIndex)
+{
+	const FSkeletalMeshRenderData* RenderData = Mesh->GetResourceForRendering();
+	return RenderData ? Build(Mesh, *RenderData, LODIndex) : nullptr;
+}
+
+TSharedPtr<FClothSurfaceUVTable> FClothSurfaceUVTable::Build(const USkeletalMesh* Mesh, const FSkeletalMeshRenderData& RenderData, int32 LODIndex)
+{
+	if (!RenderData.LODRenderData.IsValidIndex(LODIndex))
+	{
+		return nullptr;
+	}
+
+	const FSkeletalMeshLODRenderData& LODData = RenderData.LODRenderData[LODIndex];
+	const FSkeletalMeshLODInfo* LODInfo = Mesh->GetLODInfo(LODIndex);
+	const FPositionVertexBuffer& PositionBuffer = LODData.StaticVertexBuffers.PositionVertexBuffer;
+	const FStaticMeshVertexBuffer& VertexBuffer = LODData.StaticVertexBuffers.StaticMeshVertexBuffer;
+	const int32 NumVertices = PositionBuffer.GetNumVertices();
+
+	if (NumVertices == 0 || !PositionBuffer.GetVertexData() || !VertexBuffer.GetTexCoordData())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot build cloth surface table for %s LOD%d: vertex data not CPU accessible"), *Mesh->GetName(), LODIndex);
+		return nullptr;
+	}
+
+	TSharedPtr<FClothSurfaceUVTable> Table = MakeShared<FClothSurfaceUVTable>();
+	Table->Positions.SetNumUninitialized(NumVertices);
+	Table->UVs.SetNumUninitialized(NumVertices);
+	Table->MaterialIndices.SetNumZeroed(NumVertices);
+
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		Table->Positions[Vertex] = PositionBuffer.VertexPosition(Vertex);
+		Table->UVs[Vertex] = VertexBuffer.GetVertexUV(Vertex, 0);
+	}
+
+	// 按渲染分段记录材质，并统计每个材质的平均UV密度
+	TArray<uint32> Indices;
+	LODData.MultiSizeIndexContainer.GetIndexBuffer(Indices);
+
+	// 蒙皮权重用于把动画姿势下的位置映射回参考姿势，没有CPU数据时只能按最近骨骼映射
+	const FSkinWeightVertexBuffer* SkinWeights = LODData.GetSkinWeightVertexBuffer();
+	const bool bHasSkinWeights = SkinWeights && SkinWeights->GetNumVertices() == (uint32)NumVertices && SkinWeights->GetDataVertexBuffer()->GetWeightData();
+	const int32 NumSourceInfluences = bHasSkinWeights ? (int32)SkinWeights->GetMaxBoneInfluences() : 0;
+	if (bHasSkinWeights)
+	{
+		Table->InfluenceBones.SetNumZeroed(NumVertices * MaxInfluences);
+		Table->InfluenceWeights.SetNumZeroed(NumVertices * MaxInfluences);
+	}
+	TMap<int32, int32> BoneSlots;
+
+	TArray<double> UVAreas;
+	TArray<double> PositionAreas;
+	for (int32 SectionIndex = 0; SectionIndex < LODData.RenderSections.Num(); ++SectionIndex)
+	{
+		const FSkelMeshRenderSection& Section = LODData.RenderSections[SectionIndex];
+
+		// 低LOD的分段可以通过材质映射使用其他材质槽位
+		int32 MaterialIndex = Section.MaterialIndex;
+		if (LODInfo && LODInfo->LODMaterialMap.IsValidIndex(SectionIndex) && LODInfo->LODMaterialMap[SectionIndex] != INDEX_NONE)
+		{
+			MaterialIndex = LODInfo->LODMaterialMap[SectionIndex];
+		}
+		MaterialIndex = FMath::Clamp(MaterialIndex, 0, (int32)MAX_uint8);
+
+		for (uint32 Vertex = Section.BaseVertexIndex; Vertex < Section.BaseVertexIndex + Section.NumVertices && (int32)Vertex < NumVertices; ++Vertex)
+		{
+			Table->MaterialIndices[Vertex] = (uint8)MaterialIndex;
+
+			if (bHasSkinWeights)
+			{
+				AddSkinInfluences(*Table, *SkinWeights, NumSourceInfluences, Section.BoneMap, BoneSlots, Vertex);
+			}
+		}
+
+		// 没有蒙皮权重时仍记录分段引用的骨骼，以便按最近骨骼映射
+		if (!bHasSkinWeights)
+		{
+			for (const FBoneIndexType Bone : Section.BoneMap)
+			{
+				if (!BoneSlots.Contains(Bone))
+				{
+					BoneSlots.Add(Bone, Table->UsedBones.Add(Bone));
+				}
+			}
+		}
+
+		if (UVAreas.Num() <= MaterialIndex)
+		{
+			UVAreas.SetNumZeroed(MaterialIndex + 1);
+			PositionAreas.SetNumZeroed(MaterialIndex + 1);
+		}
+
+		for (uint32 Triangle = 0; Triangle < Section.NumTriangles; ++Triangle)
+		{
+			const uint32 First = Section.BaseIndex + Triangle * 3;
+			if ((int32)First + 2 >= Indices.Num())
+			{
+				break;
+			}
+
+			const uint32 A = Indices[First], B = Indices[First + 1], C = Indices[First + 2];
+			const FVector3f& PA = Table->Positions[A];
+			const FVector3f& PB = Table->Positions[B];
+			const FVector3f& PC = Table->Positions[C];
+			const FVector2f UVAB = Table->UVs[B] - Table->UVs[A];
+			const FVector2f UVAC = Table->UVs[C] - Table->UVs[A];
+
+			PositionAreas[MaterialIndex] += 0.5 * ((PB - PA) ^ (PC - PA)).Size();
+			UVAreas[MaterialIndex] += 0.5 * FMath::Abs(UVAB ^ UVAC);
+		}
+	}
+
+	Table->UVPerUnit.SetNumZeroed(UVAreas.Num());
+	for (int32 MaterialIndex = 0; MaterialIndex < UVAreas.Num(); ++MaterialIndex)
+	{
+		if (PositionAreas[MaterialIndex] > UE_SMALL_NUMBER)
+		{
+			Table->UVPerUnit[MaterialIndex] = (float)FMath::Sqrt(UVAreas[MaterialIndex] / PositionAreas[MaterialIndex]);
+		}
+	}
+
+	// 按空间单元排序顶点
+	TMap<FIntVector, int32> CellCounts;
+	TArray<FIntVector> VertexCells;
+	VertexCells.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		VertexCells[Vertex] = Table->GetCell(Table->Positions[Vertex]);
+		++CellCounts.FindOrAdd(VertexCells[Vertex]);
+	}
+
+	int32 Offset = 0;
+	Table->Cells.Reserve(CellCounts.Num());
+	for (const TPair<FIntVector, int32>& CellCount : CellCounts)
+	{
+		Table->Cells.Add(CellCount.Key, TPair<int32, int32>(Offset, 0));
+		Offset += CellCount.Value;
+	}
+
+	Table->SortedVertices.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		TPair<int32, int32>& Cell = Table->Cells[VertexCells[Vertex]];
+		Table->SortedVertices[Cell.Key + Cell.Value++] = Vertex;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Built cloth surface table for %s LOD%d: %d vertices, %d cells, %d bones"),
+		*Mesh->GetName(), LODIndex, NumVertices, Table->Cells.Num(), Table->UsedBones.Num());
+
+	return Table;
+}
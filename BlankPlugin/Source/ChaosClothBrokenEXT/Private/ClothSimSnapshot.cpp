@@ -0,0 +1,230 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothSimSnapshot.h"
+#include "ClothBreakMemory.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "ClothingSimulationInterface.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkinnedAssetCommon.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+
+namespace
+{
+	FIntVector GetParticleCell(const FVector3f& Position)
+	{
+		return FIntVector(
+			FMath::FloorToInt(Position.X / FClothSimSnapshotSection::CellSize),
+			FMath::FloorToInt(Position.Y / FClothSimSnapshotSection::CellSize),
+			FMath::FloorToInt(Position.Z / FClothSimSnapshotSection::CellSize));
+	}
+
+	uint32 HashParticleCell(const FIntVector& Cell)
+	{
+		return ((uint32)Cell.X * 73856093u) ^ ((uint32)Cell.Y * 19349663u) ^ ((uint32)Cell.Z * 83492791u);
+	}
+}
+
+void FClothSimSnapshotSection::BuildIndex()
+{
+	// 桶数为不小于粒子数的2的幂，按桶计数排序，不需要额外的数组
+	const int32 NumParticles = Positions.Num();
+	const uint32 BucketMask = FMath::RoundUpToPowerOfTwo(FMath::Max(NumParticles, 1)) - 1;
+	BucketStarts.Reset();
+	BucketStarts.SetNumZeroed((int32)BucketMask + 2);
+	SortedParticles.Reset();
+	SortedParticles.SetNumUninitialized(NumParticles);
+
+	for (const FVector3f& Position : Positions)
+	{
+		++BucketStarts[HashParticleCell(GetParticleCell(Position)) & BucketMask];
+	}
+	for (int32 Bucket = 1; Bucket < BucketStarts.Num(); ++Bucket)
+	{
+		BucketStarts[Bucket] += BucketStarts[Bucket - 1];
+	}
+
+	// 计数前缀和为各桶的终点，倒序写入后变为起点
+	for (int32 Particle = NumParticles - 1; Particle >= 0; --Particle)
+	{
+		SortedParticles[--BucketStarts[HashParticleCell(GetParticleCell(Positions[Particle])) & BucketMask]] = Particle;
+	}
+}
+
+void FClothSimSnapshotSection::ForEachParticleInRadius(const FVector3f& SimLocation, float Radius, TFunctionRef<void(int32, float)> Visitor) const
+{
+	const float RadiusSq = FMath::Square(Radius);
+	const int32 NumBuckets = BucketStarts.Num() - 1;
+	const FIntVector MinCell = GetParticleCell(SimLocation - FVector3f(Radius));
+	const FIntVector MaxCell = GetParticleCell(SimLocation + FVector3f(Radius));
+	const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+
+	// 没有索引或半径覆盖的单元太多时，逐个检查更快
+	if (NumBuckets <= 0 || SortedParticles.Num() != Positions.Num() || NumCells > NumBuckets)
+	{
+		for (int32 Particle = 0; Particle < Positions.Num(); ++Particle)
+		{
+			const float DistanceSq = FVector3f::DistSquared(Positions[Particle], SimLocation);
+			if (DistanceSq <= RadiusSq)
+			{
+				Visitor(Particle, DistanceSq);
+			}
+		}
+		return;
+	}
+
+	const uint32 BucketMask = NumBuckets - 1;
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				// 不同单元可能落在同一个桶，只接受确实位于本单元的粒子，避免重复访问
+				const FIntVector Cell(X, Y, Z);
+				const uint32 Bucket = HashParticleCell(Cell) & BucketMask;
+				for (int32 Index = BucketStarts[Bucket]; Index < BucketStarts[Bucket + 1]; ++Index)
+				{
+					const int32 Particle = SortedParticles[Index];
+					const float DistanceSq = FVector3f::DistSquared(Positions[Particle], SimLocation);
+					if (DistanceSq <= RadiusSq && GetParticleCell(Positions[Particle]) == Cell)
+					{
+						Visitor(Particle, DistanceSq);
+					}
+				}
+			}
+		}
+	}
+}
+
+const FClothSimSnapshotSection* FClothSimSnapshot::FindSection(int32 ClothingAssetIndex) const
+{
+	return Sections.FindByPredicate([ClothingAssetIndex](const FClothSimSnapshotSection& Section)
+	{
+		return Section.ClothingAssetIndex == ClothingAssetIndex;
+	});
+}
+
+const FClothSimSnapshotSection* FClothSimSnapshot::FindNearestParticle(const FVector3f& ComponentLocation, float MaxDistance, int32& OutParticle) const
+{
+	const FClothSimSnapshotSection* NearestSection = nullptr;
+	float NearestDistanceSq = FMath::Square(MaxDistance);
+	OutParticle = INDEX_NONE;
+
+	for (const FClothSimSnapshotSection& Section : Sections)
+	{
+		// 先用包围盒排除距离较远的布料
+		const FVector3f SimLocation(Section.ComponentRelativeTransform.InverseTransformPosition(FVector(ComponentLocation)));
+		if (Section.Bounds.ComputeSquaredDistanceToPoint(SimLocation) > NearestDistanceSq)
+		{
+			continue;
+		}
+
+		Section.ForEachParticleInRadius(SimLocation, FMath::Sqrt(NearestDistanceSq),
+			[&Section, &NearestSection, &NearestDistanceSq, &OutParticle](int32 Particle, float DistanceSq)
+			{
+				if (DistanceSq <= NearestDistanceSq)
+				{
+					NearestDistanceSq = DistanceSq;
+					NearestSection = &Section;
+					OutParticle = Particle;
+				}
+			});
+	}
+
+	return NearestSection;
+}
+
+void FClothSimSnapshot::Capture(const USkeletalMeshComponent& SkeletalMeshComponent, int32 RenderedLOD)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FClothSimSnapshot::Capture);
+	LLM_SCOPE_BYTAG(ClothBreak_Components);
+
+	if (RenderedLOD != MaterialIDsLOD)
+	{
+		UpdateMaterialIDs(SkeletalMeshComponent, RenderedLOD);
+	}
+
+	// 只读取骨骼网格体已取回的模拟结果，不等待布料模拟任务
+	const TMap<int32, FClothSimulData>& SimDatas = SkeletalMeshComponent.GetCurrentClothingData_GameThread();
+
+	FrameNumber = GFrameCounter;
+	LODIndex = RenderedLOD;
+	Sections.SetNum(SimDatas.Num());
+
+	int32 SectionIndex = 0;
+	for (const TPair<int32, FClothSimulData>& Pair : SimDatas)
+	{
+		FClothSimSnapshotSection& Section = Sections[SectionIndex++];
+		Section.ClothingAssetIndex = Pair.Key;
+		Section.MaterialID = AssetMaterialIDs.IsValidIndex(Pair.Key) ? AssetMaterialIDs[Pair.Key] : INDEX_NONE;
+		Section.ComponentRelativeTransform = Pair.Value.ComponentRelativeTransform;
+
+		// 复用上一次读取时的数组
+		Section.Positions.Reset();
+		Section.Positions.Append(Pair.Value.Positions);
+
+		Section.Bounds = FBox3f(ForceInit);
+		for (const FVector3f& Position : Section.Positions)
+		{
+			Section.Bounds += Position;
+		}
+		Section.BuildIndex();
+	}
+}
+
+void FClothSimSnapshot::Reset()
+{
+	FrameNumber = 0;
+	LODIndex = INDEX_NONE;
+	Sections.Empty();
+	AssetMaterialIDs.Empty();
+	MaterialIDsLOD = INDEX_NONE;
+}
+
+SIZE_T FClothSimSnapshot::GetAllocatedSize() const
+{
+	SIZE_T Bytes = Sections.GetAllocatedSize() + AssetMaterialIDs.GetAllocatedSize();
+	for (const FClothSimSnapshotSection& Section : Sections)
+	{
+		Bytes += Section.Positions.GetAllocatedSize() + Section.BucketStarts.GetAllocatedSize() + Section.SortedParticles.GetAllocatedSize();
+	}
+	return Bytes;
+}
+
+void FClothSimSnapshot::UpdateMaterialIDs(const USkeletalMeshComponent& SkeletalMeshComponent, int32 RenderedLOD)
+{
+	MaterialIDsLOD = RenderedLOD;
+	AssetMaterialIDs.Reset();
+
+	const USkeletalMesh* Mesh = SkeletalMeshComponent.GetSkeletalMeshAsset();
+	const FSkeletalMeshRenderData* RenderData = Mesh ? Mesh->GetResourceForRendering() : nullptr;
+	if (!RenderData || !RenderData->LODRenderData.IsValidIndex(RenderedLOD))
+	{
+		return;
+	}
+
+	AssetMaterialIDs.Init(INDEX_NONE, Mesh->GetMeshClothingAssets().Num());
+
+	// 布料对应的渲染片段决定其材质槽位，与表面查找表一样按LOD的材质映射换算
+	const FSkeletalMeshLODInfo* LODInfo = Mesh->GetLODInfo(RenderedLOD);
+	const FSkeletalMeshLODRenderData& LODData = RenderData->LODRenderData[RenderedLOD];
+	for (int32 SectionIndex = 0; SectionIndex < LODData.RenderSections.Num(); ++SectionIndex)
+	{
+		const FSkelMeshRenderSection& RenderSection = LODData.RenderSections[SectionIndex];
+		if (!RenderSection.HasClothingData() || RenderSection.CorrespondClothAssetIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		int32 MaterialIndex = RenderSection.MaterialIndex;
+		if (LODInfo && LODInfo->LODMaterialMap.IsValidIndex(SectionIndex) && LODInfo->LODMaterialMap[SectionIndex] != INDEX_NONE)
+		{
+			MaterialIndex = LODInfo->LODMaterialMap[SectionIndex];
+		}
+
+		if (AssetMaterialIDs.IsValidIndex(RenderSection.CorrespondClothAssetIndex))
+		{
+			AssetMaterialIDs[RenderSection.CorrespondClothAssetIndex] = MaterialIndex;
+		}
+	}
+}
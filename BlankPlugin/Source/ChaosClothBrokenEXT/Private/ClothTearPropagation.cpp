@@ -0,0 +1,208 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClothTearPropagation.h"
+#include "ClothSimSnapshot.h"
+
+namespace
+{
+	// 前沿顶点没有边断开时最多检查的次数，布料一直没有被拉开的撕裂随之结束
+	constexpr int32 MaxFrontierChecks = 30;
+}
+
+TSharedPtr<const FClothTearGraph> FClothTearGraph::Build(TConstArrayView<FVector3f> Vertices, TConstArrayView<uint32> Indices)
+{
+	const int32 NumVertices = Vertices.Num();
+	if (NumVertices == 0 || Indices.Num() < 3)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FClothTearGraph> Graph = MakeShared<FClothTearGraph>();
+
+	// 三角形的三条边去重，相邻三角形共享的边只保留一次
+	TSet<uint64> EdgeKeys;
+	EdgeKeys.Reserve(Indices.Num());
+	Graph->Edges.Reserve(Indices.Num());
+
+	TArray<int32> VertexDegrees;
+	VertexDegrees.SetNumZeroed(NumVertices);
+
+	for (int32 TriangleStart = 0; TriangleStart + 2 < Indices.Num(); TriangleStart += 3)
+	{
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const int32 VertexA = (int32)Indices[TriangleStart + Corner];
+			const int32 VertexB = (int32)Indices[TriangleStart + (Corner + 1) % 3];
+			if (VertexA == VertexB || VertexA >= NumVertices || VertexB >= NumVertices)
+			{
+				continue;
+			}
+
+			const uint64 EdgeKey = ((uint64)FMath::Min(VertexA, VertexB) << 32) | (uint64)FMath::Max(VertexA, VertexB);
+			bool bAlreadyInSet = false;
+			EdgeKeys.Add(EdgeKey, &bAlreadyInSet);
+			if (bAlreadyInSet)
+			{
+				continue;
+			}
+
+			FEdge& Edge = Graph->Edges.AddDefaulted_GetRef();
+			Edge.VertexA = VertexA;
+			Edge.VertexB = VertexB;
+			Edge.RestLength = FMath::Max(FVector3f::Dist(Vertices[VertexA], Vertices[VertexB]), UE_KINDA_SMALL_NUMBER);
+
+			++VertexDegrees[VertexA];
+			++VertexDegrees[VertexB];
+		}
+	}
+
+	// 按顶点压缩存储相邻边
+	Graph->VertexEdgeOffsets.SetNumUninitialized(NumVertices + 1);
+	Graph->VertexEdgeOffsets[0] = 0;
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		Graph->VertexEdgeOffsets[Vertex + 1] = Graph->VertexEdgeOffsets[Vertex] + VertexDegrees[Vertex];
+	}
+
+	Graph->VertexEdges.SetNumUninitialized(Graph->VertexEdgeOffsets[NumVertices]);
+	TArray<int32> WriteOffsets(Graph->VertexEdgeOffsets.GetData(), NumVertices);
+	for (int32 EdgeIndex = 0; EdgeIndex < Graph->Edges.Num(); ++EdgeIndex)
+	{
+		const FEdge& Edge = Graph->Edges[EdgeIndex];
+		Graph->VertexEdges[WriteOffsets[Edge.VertexA]++] = EdgeIndex;
+		Graph->VertexEdges[WriteOffsets[Edge.VertexB]++] = EdgeIndex;
+	}
+
+	return Graph;
+}
+
+void FClothTearState::Initialize(TSharedPtr<const FClothTearGraph> InGraph, int32 InClothingAssetIndex, int32 InLODIndex)
+{
+	Graph = MoveTemp(InGraph);
+	ClothingAssetIndex = InClothingAssetIndex;
+	LODIndex = InLODIndex;
+	BrokenEdges.Init(false, Graph ? Graph->Edges.Num() : 0);
+	ActiveTears.Reset();
+}
+
+int32 FClothTearState::RemoveFinishedTears()
+{
+	return ActiveTears.RemoveAllSwap([](const FClothTear& Tear) { return Tear.bFinished; }, EAllowShrinking::No);
+}
+
+bool FClothTearState::StartTear(const FClothSimSnapshotSection& SimData, const FVector3f& Center, float Radius, int32 MaterialID)
+{
+	const TConstArrayView<FVector3f> Positions = SimData.Positions;
+	if (!Graph || Positions.Num() != Graph->GetNumVertices())
+	{
+		return false;
+	}
+
+	FClothTear Tear;
+	Tear.MaterialID = MaterialID;
+	const float RadiusSquared = FMath::Square(Radius);
+
+	// 只访问破洞内粒子的相邻边，完全在破洞外的边不可能被断开
+	SimData.ForEachParticleInRadius(Center, Radius, [this, &Tear, Positions, &Center, RadiusSquared](int32 Vertex, float DistanceSq)
+	{
+		for (const int32 EdgeIndex : Graph->GetVertexEdges(Vertex))
+		{
+			if (BrokenEdges[EdgeIndex])
+			{
+				continue;
+			}
+
+			BrokenEdges[EdgeIndex] = true;
+			++Tear.NumBrokenEdges;
+
+			// 跨越破洞边界的边，外侧端点成为撕裂前沿
+			const int32 OtherVertex = Graph->GetOtherVertex(EdgeIndex, Vertex);
+			const bool bOtherOutside = FVector3f::DistSquared(Positions[OtherVertex], Center) > RadiusSquared;
+			if (bOtherOutside && !Tear.Frontier.ContainsByPredicate([OtherVertex](const FClothTearFrontierVertex& Front) { return Front.Vertex == OtherVertex; }))
+			{
+				Tear.Frontier.Add({ OtherVertex, 0 });
+			}
+		}
+	});
+
+	if (Tear.Frontier.Num() == 0)
+	{
+		return false;
+	}
+
+	ActiveTears.Add(MoveTemp(Tear));
+	return true;
+}
+
+void FClothTearState::AdvanceTears(TConstArrayView<FVector3f> Positions, float StrainThreshold, int32 MaxStepsPerTear, int32 MaxTearLength)
+{
+	if (!Graph || Positions.Num() != Graph->GetNumVertices())
+	{
+		for (FClothTear& Tear : ActiveTears)
+		{
+			Tear.bFinished = true;
+		}
+		return;
+	}
+
+	for (FClothTear& Tear : ActiveTears)
+	{
+		if (Tear.bFinished)
+		{
+			continue;
+		}
+
+		TArray<FClothTearFrontierVertex, TInlineAllocator<16>> NextFrontier;
+
+		// 每帧只处理固定数量的前沿顶点，其余留到之后的帧
+		const int32 NumSteps = FMath::Min(Tear.Frontier.Num(), MaxStepsPerTear);
+		int32 Step = 0;
+		for (; Step < NumSteps && Tear.NumBrokenEdges < MaxTearLength; ++Step)
+		{
+			FClothTearFrontierVertex Front = Tear.Frontier[Step];
+			bool bBrokeEdge = false;
+			for (const int32 EdgeIndex : Graph->GetVertexEdges(Front.Vertex))
+			{
+				if (BrokenEdges[EdgeIndex])
+				{
+					continue;
+				}
+
+				const FClothTearGraph::FEdge& Edge = Graph->Edges[EdgeIndex];
+				const float Length = FVector3f::Dist(Positions[Edge.VertexA], Positions[Edge.VertexB]);
+				const float Strain = (Length - Edge.RestLength) / Edge.RestLength;
+				if (Strain <= StrainThreshold)
+				{
+					continue;
+				}
+
+				BrokenEdges[EdgeIndex] = true;
+				Tear.NewlyBrokenEdges.Add(EdgeIndex);
+				bBrokeEdge = true;
+
+				const int32 OtherVertex = Graph->GetOtherVertex(EdgeIndex, Front.Vertex);
+				if (!NextFrontier.ContainsByPredicate([OtherVertex](const FClothTearFrontierVertex& Next) { return Next.Vertex == OtherVertex; }))
+				{
+					NextFrontier.Add({ OtherVertex, 0 });
+				}
+
+				if (++Tear.NumBrokenEdges >= MaxTearLength)
+				{
+					break;
+				}
+			}
+
+			// 本次没有拉开的顶点排到前沿末尾，布料之后被拉伸时再检查
+			if (!bBrokeEdge && ++Front.NumChecks < MaxFrontierChecks)
+			{
+				NextFrontier.Add(Front);
+			}
+		}
+
+		Tear.Frontier.RemoveAt(0, Step, EAllowShrinking::No);
+		Tear.Frontier.Append(NextFrontier);
+
+		// 没有可以继续扩展的顶点或达到长度上限时撕裂结束
+		Tear.bFinished = Tear.Frontier.Num() == 0 || Tear.NumBrokenEdges >= MaxTearLength;
+	}
+}
@@ -0,0 +1,366 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
+
+#include "ClothBreakableComponent.h"
+#include "ClothBreakingSubsystem.h"
+#include "ClothFragmentGenerator.h"
+#include "ClothBreakFrameArena.h"
+#include "ClothBreakConsoleVariables.h"
+#include "Components/SphereComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "UObject/UObjectArray.h"
+
+namespace ClothBreakAllocationTests
+{
+	// 稳定状态下每次断裂允许的上限，优化落地后只应下调
+	// 冲击只入队，不应产生任何堆分配或对象
+	constexpr int32 MaxTransientAllocationsPerImpact = 0;
+
+	// 子系统处理断裂时，除保留下来的碎片外不应产生临时堆分配
+	constexpr int32 MaxTransientAllocationsPerBreak = 0;
+
+	// 每个碎片只创建Actor和静态网格组件，网格来自共享缓存，材质直接使用源材质
+	constexpr int32 MaxObjectsPerFragment = 2;
+
+	// 每个碎片保留的堆分配：Actor、组件、注册、物理体和自动销毁定时器，不含共享网格和碎片列表
+	constexpr int32 MaxKeptAllocationsPerFragment = 64;
+
+	// 预热次数，覆盖帧内分配器、共享网格和破洞遮罩材质的首次创建
+	constexpr int32 NumWarmupBreaks = 8;
+
+	// 统计的断裂次数
+	constexpr int32 NumMeasuredBreaks = 8;
+
+	// 测试使用的引擎自带骨骼网格体
+	const TCHAR* const TestMeshPath = TEXT("/Engine/EngineMeshes/SkeletalCube.SkeletalCube");
+
+	/** 统计游戏线程创建的UObject数量 */
+	class FObjectCreationCounter : public FUObjectArray::FUObjectCreateListener
+	{
+	public:
+		FObjectCreationCounter()
+		{
+			GUObjectArray.AddUObjectCreateListener(this);
+		}
+
+		virtual ~FObjectCreationCounter() override
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+
+		virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override
+		{
+			if (IsInGameThread())
+			{
+				++NumCreated;
+			}
+		}
+
+		virtual void OnUObjectArrayShutdown() override
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+
+		int32 NumCreated = 0;
+	};
+
+	/** 无界面运行的游戏世界，包含一个带断裂组件的骨骼网格体 */
+	class FTestWorld
+	{
+	public:
+		FTestWorld()
+		{
+			// 固定在最高画质档位，保证每次断裂都生成碎片
+			QualityVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("ClothBreak.Quality"));
+			if (QualityVariable)
+			{
+				PreviousQuality = QualityVariable->GetInt();
+				QualityVariable->Set(ClothBreakCVars::NumQualityLevels - 1, ECVF_SetByCode);
+			}
+
+			World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ClothBreakAllocationTest"));
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->BeginPlay();
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+
+			if (QualityVariable)
+			{
+				QualityVariable->Set(PreviousQuality, ECVF_SetByCode);
+			}
+		}
+
+		/**
+		 * 生成带断裂组件的角色并完成初始化
+		 * @return 是否成功，缺少测试网格体时返回false
+		 */
+		bool SpawnBreakable()
+		{
+			USkeletalMesh* Mesh = LoadObject<USkeletalMesh>(nullptr, TestMeshPath);
+			if (!Mesh)
+			{
+				return false;
+			}
+
+			AActor* Owner = World->SpawnActor<AActor>();
+			MeshComponent = NewObject<USkeletalMeshComponent>(Owner, TEXT("Mesh"));
+			MeshComponent->SetSkeletalMeshAsset(Mesh);
+			Owner->SetRootComponent(MeshComponent);
+			MeshComponent->RegisterComponent();
+
+			// 阈值为0保证每次冲击都断裂，碎片尺寸固定，预热后不再生成新的共享网格
+			FClothBreakableSettingsOverrides Overrides;
+			Overrides.bOverride_BreakForceThreshold = true;
+			Overrides.BreakForceThreshold = 0.0f;
+			Overrides.bOverride_FragmentSize = true;
+			Overrides.MinFragmentSize = 10.0f;
+			Overrides.MaxFragmentSize = 10.0f;
+
+			Breakable = NewObject<UClothBreakableComponent>(Owner, TEXT("Breakable"));
+			Breakable->TargetSkeletalMesh = MeshComponent;
+			Breakable->SettingsOverrides = Overrides;
+			Breakable->RegisterComponent();
+
+			// 子弹只需要一个图元根组件
+			Bullet = World->SpawnActor<AActor>();
+			USphereComponent* BulletRoot = NewObject<USphereComponent>(Bullet, TEXT("BulletRoot"));
+			BulletRoot->InitSphereRadius(1.0f);
+			Bullet->SetRootComponent(BulletRoot);
+			BulletRoot->RegisterComponent();
+
+			Subsystem = UClothBreakingSubsystem::Get(World);
+			if (Subsystem)
+			{
+				Subsystem->Tick(0.0f);
+			}
+
+			Breakable->OnClothBreakNative.AddLambda([this](const FClothBreakRecord&) { ++NumBreaks; });
+			return Subsystem && Breakable->TryInitialize();
+		}
+
+		/** 驱动子系统直到本帧的冲击和工作队列全部处理完 */
+		void FlushSubsystem()
+		{
+			for (int32 Frame = 0; Frame < 16; ++Frame)
+			{
+				Subsystem->Tick(1.0f / 60.0f);
+				FClothBreakFrameArena::Get().Reset();
+				if (Subsystem->GetNumPendingWorkItems() == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		/** 冲击位置，位于网格体的包围盒中心 */
+		FVector GetImpactLocation() const
+		{
+			return MeshComponent->Bounds.Origin;
+		}
+
+		UWorld* World = nullptr;
+		USkeletalMeshComponent* MeshComponent = nullptr;
+		UClothBreakableComponent* Breakable = nullptr;
+		UClothBreakingSubsystem* Subsystem = nullptr;
+		AActor* Bullet = nullptr;
+		int32 NumBreaks = 0;
+
+	private:
+		IConsoleVariable* QualityVariable = nullptr;
+		int32 PreviousQuality = INDEX_NONE;
+	};
+
+	/** 一次冲击及其处理的统计 */
+	struct FBreakCounts
+	{
+		int32 ImpactTransientAllocations = 0;
+		int32 ImpactObjects = 0;
+		int32 BreakTransientAllocations = 0;
+		int32 BreakKeptAllocations = 0;
+		int32 BreakObjects = 0;
+		int32 Fragments = 0;
+	};
+
+	/**
+	 * 发出一次冲击并处理，分别统计入队和子系统处理两个阶段
+	 * @param TestWorld 测试世界
+	 * @param Impact 发出冲击，返回是否成功
+	 * @param OutCounts 输出的统计
+	 * @return 冲击是否成功
+	 */
+	bool MeasureBreak(FTestWorld& TestWorld, TFunctionRef<bool()> Impact, FBreakCounts& OutCounts)
+	{
+		bool bImpacted = false;
+		{
+			FObjectCreationCounter Objects;
+			FClothBreakAllocationCounter::FScope Allocations;
+			bImpacted = Impact();
+			OutCounts.ImpactTransientAllocations = Allocations.GetNumTransientAllocations();
+			OutCounts.ImpactObjects = Objects.NumCreated;
+		}
+
+		const int32 FragmentsBefore = TestWorld.Breakable->GetFragmentGenerator()->GetNumLiveFragments();
+		{
+			FObjectCreationCounter Objects;
+			FClothBreakAllocationCounter::FScope Allocations;
+			TestWorld.FlushSubsystem();
+			OutCounts.BreakTransientAllocations = Allocations.GetNumTransientAllocations();
+			OutCounts.BreakKeptAllocations = Allocations.GetNumKeptAllocations();
+			OutCounts.BreakObjects = Objects.NumCreated;
+		}
+		OutCounts.Fragments = FMath::Max(TestWorld.Breakable->GetFragmentGenerator()->GetNumLiveFragments() - FragmentsBefore, 0);
+
+		return bImpacted;
+	}
+
+	/**
+	 * 预热后重复断裂并检查上限
+	 * @param Test 当前测试
+	 * @param Context 冲击入口的名称
+	 * @param Impact 发出冲击，返回是否成功
+	 */
+	void RunBreakBudgetTest(FAutomationTestBase& Test, const TCHAR* Context, TFunctionRef<bool(FTestWorld&)> Impact)
+	{
+		// 对象数量不依赖分配计数器，总是检查；堆分配只在安装了计数器时检查
+		const bool bCountAllocations = FClothBreakAllocationCounter::IsEnabled();
+		if (!bCountAllocations)
+		{
+			Test.AddInfo(FString::Printf(TEXT("%s: heap allocation checks need -ClothBreakTrackAllocations, checking object counts only"), Context));
+		}
+
+		FTestWorld TestWorld;
+		if (!TestWorld.SpawnBreakable())
+		{
+			Test.AddError(FString::Printf(TEXT("%s: cannot set up the test breakable, test mesh %s missing"), Context, TestMeshPath));
+			return;
+		}
+
+		FBreakCounts Counts;
+		for (int32 Break = 0; Break < NumWarmupBreaks; ++Break)
+		{
+			MeasureBreak(TestWorld, [&TestWorld, &Impact]() { return Impact(TestWorld); }, Counts);
+		}
+
+		const int32 BreaksBefore = TestWorld.NumBreaks;
+		for (int32 Break = 0; Break < NumMeasuredBreaks; ++Break)
+		{
+			const bool bImpacted = MeasureBreak(TestWorld, [&TestWorld, &Impact]() { return Impact(TestWorld); }, Counts);
+			Test.TestTrue(FString::Printf(TEXT("%s break %d accepted"), Context, Break), bImpacted);
+
+			Test.TestEqual(FString::Printf(TEXT("%s impact objects"), Context), Counts.ImpactObjects, 0);
+			Test.TestTrue(FString::Printf(TEXT("%s break objects (%d for %d fragments)"), Context, Counts.BreakObjects, Counts.Fragments),
+				Counts.BreakObjects <= Counts.Fragments * MaxObjectsPerFragment);
+
+			if (bCountAllocations)
+			{
+				Test.TestTrue(FString::Printf(TEXT("%s impact transient allocations (%d <= %d)"), Context,
+					Counts.ImpactTransientAllocations, MaxTransientAllocationsPerImpact), Counts.ImpactTransientAllocations <= MaxTransientAllocationsPerImpact);
+				Test.TestTrue(FString::Printf(TEXT("%s break transient allocations (%d <= %d)"), Context,
+					Counts.BreakTransientAllocations, MaxTransientAllocationsPerBreak), Counts.BreakTransientAllocations <= MaxTransientAllocationsPerBreak);
+				Test.TestTrue(FString::Printf(TEXT("%s break kept allocations (%d <= %d for %d fragments)"), Context, Counts.BreakKeptAllocations,
+					Counts.Fragments * MaxKeptAllocationsPerFragment, Counts.Fragments), Counts.BreakKeptAllocations <= Counts.Fragments * MaxKeptAllocationsPerFragment);
+			}
+
+			Test.AddInfo(FString::Printf(TEXT("%s break %d: fragments=%d objects=%d kept allocations=%d"), Context, Break,
+				Counts.Fragments, Counts.BreakObjects, Counts.BreakKeptAllocations));
+		}
+
+		Test.TestEqual(FString::Printf(TEXT("%s breaks broadcast"), Context), TestWorld.NumBreaks - BreaksBefore, NumMeasuredBreaks);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClothBreakSimulateImpactAllocationTest, "Plugins.ChaosClothBrokenEXT.Allocations.SimulateBulletImpact",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClothBreakSimulateImpactAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace ClothBreakAllocationTests;
+
+	RunBreakBudgetTest(*this, TEXT("SimulateBulletImpact"), [](FTestWorld& TestWorld)
+	{
+		return TestWorld.Breakable->SimulateBulletImpact(TestWorld.GetImpactLocation(), 1.0f, 1000.0f);
+	});
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClothBreakHandleHitAllocationTest, "Plugins.ChaosClothBrokenEXT.Allocations.HandleBulletHit",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClothBreakHandleHitAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace ClothBreakAllocationTests;
+
+	RunBreakBudgetTest(*this, TEXT("HandleBulletHit"), [](FTestWorld& TestWorld)
+	{
+		const FHitResult Hit(TestWorld.Bullet, TestWorld.MeshComponent, TestWorld.GetImpactLocation(), FVector::UpVector);
+		return TestWorld.Breakable->HandleBulletHit(Hit);
+	});
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClothBreakGenerateFragmentsAllocationTest, "Plugins.ChaosClothBrokenEXT.Allocations.GenerateFragmentsFromCloth",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClothBreakGenerateFragmentsAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace ClothBreakAllocationTests;
+
+	const bool bCountAllocations = FClothBreakAllocationCounter::IsEnabled();
+	if (!bCountAllocations)
+	{
+		AddInfo(TEXT("Heap allocation checks need -ClothBreakTrackAllocations, checking object counts only"));
+	}
+
+	FTestWorld TestWorld;
+	if (!TestWorld.SpawnBreakable())
+	{
+		AddError(FString::Printf(TEXT("Cannot set up the test breakable, test mesh %s missing"), TestMeshPath));
+		return false;
+	}
+
+	// 直接调用生成器，不经过子系统
+	constexpr int32 FragmentCount = 5;
+	UClothFragmentGenerator* Generator = TestWorld.Breakable->GetFragmentGenerator();
+	const FVector Location = TestWorld.GetImpactLocation();
+	for (int32 Break = 0; Break < NumWarmupBreaks + NumMeasuredBreaks; ++Break)
+	{
+		FObjectCreationCounter Objects;
+		FClothBreakAllocationCounter::FScope Allocations;
+		const bool bGenerated = Generator->GenerateFragmentsFromCloth(TestWorld.MeshComponent, Location, 10.0f, 0, FragmentCount, 10.0f, 10.0f);
+		const int32 TransientAllocations = Allocations.GetNumTransientAllocations();
+		const int32 KeptAllocations = Allocations.GetNumKeptAllocations();
+		const int32 NumObjects = Objects.NumCreated;
+		FClothBreakFrameArena::Get().Reset();
+
+		if (Break < NumWarmupBreaks)
+		{
+			continue;
+		}
+
+		TestTrue(TEXT("Fragments generated"), bGenerated);
+		TestTrue(FString::Printf(TEXT("GenerateFragmentsFromCloth objects (%d for %d fragments)"), NumObjects, FragmentCount),
+			NumObjects <= FragmentCount * MaxObjectsPerFragment);
+
+		if (bCountAllocations)
+		{
+			TestTrue(FString::Printf(TEXT("GenerateFragmentsFromCloth transient allocations (%d <= %d)"), TransientAllocations, MaxTransientAllocationsPerBreak),
+				TransientAllocations <= MaxTransientAllocationsPerBreak);
+			TestTrue(FString::Printf(TEXT("GenerateFragmentsFromCloth kept allocations (%d <= %d)"), KeptAllocations, FragmentCount * MaxKeptAllocationsPerFragment),
+				KeptAllocations <= FragmentCount * MaxKeptAllocationsPerFragment);
+		}
+	}
+	return true;
+}
+
+#endif
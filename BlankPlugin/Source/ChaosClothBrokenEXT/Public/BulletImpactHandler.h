@@ -7,8 +7,43 @@
 #include "Engine/EngineTypes.h"
 #include "Components/SphereComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "UObject/ObjectKey.h"
 #include "BulletImpactHandler.generated.h"
 
+class UBulletProfile;
+class UClothBreakableSettings;
+struct FClothBreakableRuntimeSettings;
+
+/**
+ * 子弹冲击的解析结果
+ */
+struct FBulletImpactParams
+{
+	/** 碰撞位置 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 世界空间的布料表面法线，未知时为零向量 */
+	FVector Normal = FVector::ZeroVector;
+
+	/** 命中的骨骼名称，命中物理资产的刚体时有效，用于把命中点映射回参考姿势 */
+	FName BoneName = NAME_None;
+
+	/** 断裂半径 */
+	float BreakRadius = 0.0f;
+
+	/** 碰撞力 */
+	float ImpactForce = 0.0f;
+
+	/** 命中时的动能，由子弹速度和质量计算，没有子弹配置时为0 */
+	float ImpactEnergy = 0.0f;
+
+	/** 碎片数量倍率 */
+	float FragmentMultiplier = 1.0f;
+
+	/** 使用的子弹配置，没有时回退为物理探测 */
+	const UBulletProfile* Profile = nullptr;
+};
+
 /**
  * 处理子弹碰撞事件，计算断裂区域
  * 专门用于子弹击中布料时的断裂效果
@@ -34,6 +69,25 @@ public:
 	bool ProcessBulletImpact(const FHitResult& HitResult, float RadiusMultiplier,
 		FVector& OutImpactLocation, float& OutBreakRadius, float& OutImpactForce);
 
+	/**
+	 * 按断裂设置解析子弹冲击
+	 * 子弹类有对应的子弹配置时，半径和碰撞力只需一次缓存查找和一次曲线求值
+	 * @param HitResult 碰撞结果
+	 * @param Settings 运行时设置，提供半径倍率和子弹配置
+	 * @param OutParams 输出的冲击参数
+	 * @return 是否成功处理碰撞
+	 */
+	bool ResolveBulletImpact(const FHitResult& HitResult, const FClothBreakableRuntimeSettings& Settings, FBulletImpactParams& OutParams);
+
+	/**
+	 * 查找子弹类对应的子弹配置
+	 * 每个子弹类只解析一次，之后直接命中缓存
+	 * @param ProjectileClass 子弹类
+	 * @param Settings 断裂设置
+	 * @return 子弹配置，没有时返回nullptr
+	 */
+	const UBulletProfile* FindBulletProfile(UClass* ProjectileClass, const UClothBreakableSettings* Settings);
+
 	/**
 	 * 计算断裂区域半径
 	 * @param HitComponent 被击中的组件
@@ -53,6 +107,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
 	static float CalculateImpactForce(const FHitResult& HitResult);
 
+	/**
+	 * 计算子弹的飞行方向
+	 * @param HitResult 碰撞结果
+	 * @return 单位方向向量
+	 */
+	static FVector CalculateBulletDirection(const FHitResult& HitResult);
+
 	/**
 	 * 模拟子弹碰撞
 	 * @param TargetComponent 目标组件
@@ -80,6 +141,12 @@ public:
 	void SetDebugVisualization(bool bEnable, float DrawDuration = 3.0f);
 
 private:
+	/** 子弹当前的速度，优先使用ProjectileMovementComponent，无法获取时为零 */
+	static FVector GetBulletVelocity(const AActor* BulletActor);
+
+	/** 绘制调试信息 */
+	void DrawImpactDebug(UWorld* World, const FVector& ImpactLocation, float BreakRadius, float ImpactForce) const;
+
 	// 默认断裂半径
 	static constexpr float DefaultRadius = 5.0f;
 
@@ -90,4 +157,13 @@ private:
 	// 调试绘制持续时间
 	UPROPERTY()
 	float DebugDrawDuration;
+
+	// 子弹类到子弹配置的解析缓存
+	TMap<TObjectKey<UClass>, TWeakObjectPtr<const UBulletProfile>> ResolvedProfiles;
+
+	// 解析缓存对应的断裂设置，设置变化时清空缓存
+	TWeakObjectPtr<const UClothBreakableSettings> ResolvedProfilesSettings;
+
+	// 解析缓存对应的设置修改版本，同一资产的子弹配置被修改后清空缓存
+	uint32 ResolvedProfilesRevision = 0;
 };
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Curves/CurveFloat.h"
+#include "BulletProfile.generated.h"
+
+/**
+ * 子弹配置
+ * 描述一类子弹的弹道参数，替代每次命中时对子弹物理状态的探测
+ */
+UCLASS(BlueprintType)
+class CHAOSCLOTHBROKENEXT_API UBulletProfile : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UBulletProfile();
+
+	/** 半径曲线为空时使用的子弹尺寸 (厘米)，与无法探测子弹碰撞体时的回退值一致，保持原有的默认断裂半径 */
+	static constexpr float DefaultBulletSize = 5.0f;
+
+	/** 口径 (厘米)，断裂半径不小于弹头半径 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet", meta = (ClampMin = "0.01"))
+	float Caliber;
+
+	/** 弹头质量 (千克) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet", meta = (ClampMin = "0.0001"))
+	float Mass;
+
+	/** 枪口动能 (焦耳)，无法获取命中速度时使用 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet", meta = (ClampMin = "0.0"))
+	float MuzzleEnergy;
+
+	/** 断裂半径曲线，横轴为命中时的动能 (焦耳)，纵轴为断裂半径 (厘米)。为空时按DefaultBulletSize和半径倍率计算 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet")
+	FRuntimeFloatCurve RadiusCurve;
+
+	/** 动能到碰撞力的换算系数，碰撞力与BreakForceThreshold比较 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet", meta = (ClampMin = "0.0"))
+	float ImpactForceScale;
+
+	/** 碎片数量倍率，为0时不生成碎片 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Bullet", meta = (ClampMin = "0.0"))
+	float FragmentMultiplier;
+
+	/**
+	 * 计算命中时的动能，1/2·m·v²
+	 * @param ImpactSpeed 命中速度 (厘米/秒)，小于等于0时使用枪口动能
+	 * @return 动能 (焦耳)
+	 */
+	float EvaluateImpactEnergy(float ImpactSpeed) const;
+
+	/**
+	 * 计算断裂半径
+	 * @param ImpactEnergy 命中时的动能
+	 * @param RadiusMultiplier 子弹大小到断裂半径的倍率，半径曲线为空时使用
+	 * @return 断裂半径
+	 */
+	float EvaluateBreakRadius(float ImpactEnergy, float RadiusMultiplier) const;
+
+	/**
+	 * 计算碰撞力
+	 * @param ImpactEnergy 命中时的动能
+	 * @return 碰撞力
+	 */
+	float EvaluateImpactForce(float ImpactEnergy) const;
+};
@@ -26,4 +26,10 @@ public:
 	/** IModuleInterface实现 */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+#if WITH_EDITOR
+	/** 骨骼网格体修改后清除表面查找表的回调 */
+	FDelegateHandle MeshChangedHandle;
+#endif
 };
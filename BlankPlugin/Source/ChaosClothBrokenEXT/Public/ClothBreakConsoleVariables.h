@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClothFragmentStrategies.h"
+
+struct FClothBreakableRuntimeSettings;
+
+/**
+ * 断裂画质档位的各项上限
+ * 档位默认跟随引擎的特效画质分组（sg.EffectsQuality），设备配置或画质配置中可通过ClothBreak.Quality单独指定，
+ * 单项控制台变量（如ClothBreak.MaxFragments）不小于0时优先于档位
+ */
+struct FClothBreakQualityTier
+{
+	/** 每个组件存活碎片的上限 */
+	int32 MaxLiveFragments;
+
+	/** 单次断裂的碎片数量上限 */
+	int32 MaxFragmentsPerBreak;
+
+	/** 断裂半径上限 */
+	float MaxBreakRadius;
+
+	/** 子系统每帧的默认时间预算，0表示不限制，SetFrameBudgetMs设置的预算优先 */
+	float FrameBudgetMs;
+
+	/** 调试球的分段数 */
+	int32 DebugSphereSegments;
+
+	/** 碎片是否模拟物理，关闭时不生成碎片，避免碎片静止悬停 */
+	bool bEnableFragmentPhysics;
+
+	/** 是否允许SphereDebris以外的碎片策略 */
+	bool bAllowAdvancedStrategies;
+
+	/** 只记录破洞并写入遮罩，不生成碎片也不撕裂 */
+	bool bHoleMaskOnly;
+};
+
+/**
+ * 全局调节用的控制台变量
+ * 覆盖所有组件的设置，用于运行时调整预算和探测性能上限，无需重新编译或逐个修改设置资产。
+ * 修改影响运行时设置的变量后，所有组件的运行时设置随之重建
+ */
+namespace ClothBreakCVars
+{
+	/** 画质档位数量，与引擎画质分组的低、中、高、极高对应 */
+	constexpr int32 NumQualityLevels = 4;
+
+	/** 当前生效的画质档位 (ClothBreak.Quality，小于0时跟随sg.EffectsQuality) */
+	CHAOSCLOTHBROKENEXT_API int32 GetQualityLevel();
+
+	/** 当前生效的画质档位的各项上限 */
+	CHAOSCLOTHBROKENEXT_API const FClothBreakQualityTier& GetQualityTier();
+
+	/** 断裂半径上限 (ClothBreak.MaxBreakRadius) */
+	CHAOSCLOTHBROKENEXT_API float GetMaxBreakRadius();
+
+	/** 调试球的分段数 */
+	CHAOSCLOTHBROKENEXT_API int32 GetDebugSphereSegments();
+
+	/** 每个组件存活碎片的上限 (ClothBreak.MaxFragments) */
+	CHAOSCLOTHBROKENEXT_API int32 GetMaxLiveFragments();
+
+	/**
+	 * 子系统每帧的时间预算
+	 * 依次使用ClothBreak.FrameBudgetMs、显式设置的预算和画质档位的预算，前两者小于0时视为未设置
+	 * @param ExplicitBudgetMs 通过子系统显式设置的预算，小于0表示未设置
+	 * @return 毫秒，小于等于0表示不限制
+	 */
+	CHAOSCLOTHBROKENEXT_API float GetFrameBudgetMs(float ExplicitBudgetMs);
+
+	/** 组件初始化后是否自动预热断裂资源 (ClothBreak.AutoPrewarm) */
+	CHAOSCLOTHBROKENEXT_API bool IsAutoPrewarmEnabled();
+
+	/** 碎片策略是否启用 (ClothBreak.Fragments.<策略名>) */
+	CHAOSCLOTHBROKENEXT_API bool IsFragmentStrategyEnabled(EClothFragmentStrategy Strategy);
+
+	/**
+	 * 将控制台变量应用到合并后的运行时设置
+	 * 包括画质档位的碎片数量、物理和策略限制，LOD距离、完整断裂的最大LOD，以及被禁用的碎片策略
+	 * @param Settings 运行时设置
+	 */
+	CHAOSCLOTHBROKENEXT_API void ApplyOverrides(FClothBreakableRuntimeSettings& Settings);
+}
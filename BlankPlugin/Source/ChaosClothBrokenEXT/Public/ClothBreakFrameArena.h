@@ -0,0 +1,211 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * 断裂流程的帧内线性分配器
+ * 断裂流程中的临时数组、顶点/索引缓冲从这里分配，帧结束时整体重置，
+ * 稳定运行时不会触及通用堆。只能在游戏线程使用，分配的内存不能跨帧保存
+ */
+class CHAOSCLOTHBROKENEXT_API FClothBreakFrameArena
+{
+public:
+	/** 获取游戏线程的帧内分配器 */
+	static FClothBreakFrameArena& Get();
+
+	/** 模块加载时注册帧结束回调 */
+	static void Startup();
+
+	/** 模块卸载时移除帧结束回调并释放内存 */
+	static void Shutdown();
+
+	/**
+	 * 分配内存
+	 * @param Size 字节数
+	 * @param Alignment 对齐
+	 * @return 分配的内存，帧结束前有效
+	 */
+	void* Allocate(SIZE_T Size, uint32 Alignment);
+
+	/** 重置分配器，释放本帧的全部分配 */
+	void Reset();
+
+	/** 本帧已分配的字节数 */
+	int64 GetFrameBytes() const { return FrameBytes; }
+
+	/** 单帧分配字节数的峰值 */
+	int64 GetPeakFrameBytes() const { return PeakFrameBytes; }
+
+private:
+	FClothBreakFrameArena() = default;
+
+	// 底层的页式线性分配器，页来自FPageAllocator的缓存，不经过通用堆
+	FMemStackBase Stack;
+
+	// 帧起点标记，重置时弹出即可整体释放
+	TOptional<FMemMark> FrameMark;
+
+	// 本帧已分配的字节数
+	int64 FrameBytes = 0;
+
+	// 单帧分配字节数的峰值
+	int64 PeakFrameBytes = 0;
+
+	// 帧结束回调句柄
+	static FDelegateHandle EndFrameHandle;
+};
+
+/**
+ * 使用帧内分配器的容器分配策略
+ * 与TMemStackAllocator相同，但内存来自FClothBreakFrameArena，重新分配时旧内存随帧统一释放
+ */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TClothFrameArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType
+	{
+	public:
+		ForElementType()
+			: Data(nullptr)
+		{
+		}
+
+		FORCEINLINE void MoveToEmpty(ForElementType& Other)
+		{
+			checkSlow(this != &Other);
+			Data = Other.Data;
+			Other.Data = nullptr;
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			ElementType* OldData = Data;
+			if (NumElements)
+			{
+				Data = (ElementType*)FClothBreakFrameArena::Get().Allocate(NumElements * NumBytesPerElement,
+					FMath::Max(Alignment, (uint32)alignof(ElementType)));
+
+				if (OldData && PreviousNumElements)
+				{
+					const SizeType NumCopiedElements = FMath::Min(NumElements, PreviousNumElements);
+					FMemory::Memcpy(Data, OldData, NumCopiedElements * NumBytesPerElement);
+				}
+			}
+			else
+			{
+				Data = nullptr;
+			}
+		}
+
+		SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+
+		SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		bool HasAllocation() const
+		{
+			return !!Data;
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		ElementType* Data;
+	};
+
+	typedef void ForAnyElementType;
+};
+
+template<uint32 Alignment>
+struct TAllocatorTraits<TClothFrameArenaAllocator<Alignment>> : TAllocatorTraitsBase<TClothFrameArenaAllocator<Alignment>>
+{
+	enum { IsZeroConstruct = true };
+};
+
+/** 帧内临时数组 */
+template<typename ElementType>
+using TClothFrameArray = TArray<ElementType, TClothFrameArenaAllocator<>>;
+
+/**
+ * 断裂流程的堆分配计数
+ * 非Shipping版本中以 -ClothBreakTrackAllocations 启动时，模块加载时包装GMalloc，
+ * 统计作用域内当前线程的通用堆分配次数，用于验证稳定状态下的断裂不产生临时堆分配。
+ * 运行中不能开启，避免在其他线程分配内存时替换GMalloc
+ */
+class CHAOSCLOTHBROKENEXT_API FClothBreakAllocationCounter
+{
+public:
+	/** 是否已开启统计 */
+	static bool IsEnabled();
+
+	/** 模块加载时调用，命令行带 -ClothBreakTrackAllocations 时包装GMalloc，之后不会撤销 */
+	static void Startup();
+
+	/**
+	 * 统计作用域
+	 * 作用域内当前线程的堆分配计入统计
+	 */
+	class CHAOSCLOTHBROKENEXT_API FScope
+	{
+	public:
+		FScope();
+		~FScope();
+
+		/** 作用域内的全部堆分配次数 */
+		int32 GetNumAllocations() const;
+
+		/** 作用域内属于保留对象（碎片等）的堆分配次数 */
+		int32 GetNumKeptAllocations() const;
+
+		/** 作用域内的临时堆分配次数 */
+		int32 GetNumTransientAllocations() const { return GetNumAllocations() - GetNumKeptAllocations(); }
+
+	private:
+		int32 StartAllocations;
+		int32 StartKeptAllocations;
+	};
+
+	/**
+	 * 保留分配作用域
+	 * 作用域内的分配属于断裂后保留下来的对象（碎片Actor、组件等），单独计数
+	 */
+	class CHAOSCLOTHBROKENEXT_API FKeptScope
+	{
+	public:
+		FKeptScope();
+		~FKeptScope();
+	};
+};
@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 录制的一次冲击
+ * 位置记录在目标骨骼网格体组件空间中，回放时角色位置不同也能命中同一处布料
+ */
+struct FClothBreakRecordedImpact
+{
+	/** 相对录制开始的帧序号 */
+	uint32 Frame = 0;
+
+	/** 相对录制开始的时间 (秒) */
+	float Time = 0.0f;
+
+	/** 组件在组件表中的索引 */
+	uint16 ComponentIndex = 0;
+
+	/** 组件空间冲击位置 */
+	FVector3f LocalLocation = FVector3f::ZeroVector;
+
+	/** 组件空间的布料表面法线，未知时为零向量 */
+	FVector3f LocalNormal = FVector3f::ZeroVector;
+
+	/** 命中的骨骼索引，未知时为INDEX_NONE */
+	int32 HitBone = INDEX_NONE;
+
+	/** 断裂半径 */
+	float Radius = 0.0f;
+
+	/** 碰撞力 */
+	float Force = 0.0f;
+
+	/** 碎片数量倍率 */
+	float FragmentMultiplier = 1.0f;
+
+	/** 随机种子，回放时使用同一种子保证碎片规划一致 */
+	int32 Seed = 0;
+
+	/** 解析得到的材质ID，未断裂时为INDEX_NONE */
+	int32 MaterialID = INDEX_NONE;
+};
+
+/**
+ * 一段冲击录制
+ * 以紧凑的二进制格式保存，用于在相同负载下对比不同版本的性能
+ */
+class CHAOSCLOTHBROKENEXT_API FClothBreakImpactRecording
+{
+public:
+	/** 组件名称表，格式为 "角色名.组件名" */
+	TArray<FString> ComponentNames;
+
+	/** 按时间顺序排列的冲击 */
+	TArray<FClothBreakRecordedImpact> Impacts;
+
+	/**
+	 * 保存到文件
+	 * @param Filename 文件路径
+	 * @return 是否成功保存
+	 */
+	bool SaveToFile(const FString& Filename) const;
+
+	/**
+	 * 从文件加载
+	 * @param Filename 文件路径
+	 * @return 是否成功加载
+	 */
+	bool LoadFromFile(const FString& Filename);
+
+	/** 默认的录制文件路径 */
+	static FString GetDefaultFilename();
+
+	/** 组件在录制中使用的名称 */
+	static FString GetComponentName(const UActorComponent* Component);
+};
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * 插件的低级内存追踪标签
+ * 所有分配记在ClothBreak下，按用途细分为子标签，以-llm运行时可在stat LLM和LLM报告中查看
+ */
+LLM_DECLARE_TAG_API(ClothBreak, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_Components, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_Fragments, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_HoleMask, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_Tables, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_Tearing, CHAOSCLOTHBROKENEXT_API);
+LLM_DECLARE_TAG_API(ClothBreak_Subsystem, CHAOSCLOTHBROKENEXT_API);
+
+/**
+ * 单个组件的内存统计
+ * 不含同一网格体的组件共享的数据（表面查找表、撕裂边图）
+ */
+struct FClothBreakableMemoryStats
+{
+	/** 组件、碰撞处理器和碎片生成器对象，以及破洞记录 */
+	int64 ComponentBytes = 0;
+
+	/** 破洞遮罩的动态材质实例 */
+	int64 HoleMaskBytes = 0;
+
+	/** 布料模拟位置快照 */
+	int64 SnapshotBytes = 0;
+
+	/** 撕裂状态 */
+	int64 TearingBytes = 0;
+
+	/** 存活碎片的Actor和组件 */
+	int64 FragmentBytes = 0;
+
+	/** 存活碎片数量 */
+	int32 NumFragments = 0;
+
+	/** 合计字节数 */
+	int64 GetTotalBytes() const
+	{
+		return ComponentBytes + HoleMaskBytes + SnapshotBytes + TearingBytes + FragmentBytes;
+	}
+};
+
+namespace ClothBreakMemory
+{
+	/** 插件的内存预算（字节），由ClothBreak.MemoryBudgetMB设置，0表示不检查 */
+	CHAOSCLOTHBROKENEXT_API int64 GetBudgetBytes();
+
+	/**
+	 * 估算对象占用的内存
+	 * 对象本身的大小加上对象报告的独占资源大小，不依赖渲染设备，-nullrhi下同样可用
+	 * @param Object 对象
+	 * @return 字节数，对象为空时返回0
+	 */
+	CHAOSCLOTHBROKENEXT_API int64 GetObjectSize(UObject* Object);
+
+	/** 以KB为单位的显示值 */
+	inline double ToKB(int64 Bytes) { return Bytes / 1024.0; }
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "ClothBreakRegionData.generated.h"
+
+class USkeletalMesh;
+class ITargetPlatform;
+struct FClothSurfaceUVTable;
+
+/**
+ * 单个LOD烘焙的表面查找表
+ */
+USTRUCT()
+struct FClothBreakRegionLODData
+{
+	GENERATED_BODY()
+
+	/** 渲染LOD */
+	UPROPERTY()
+	int32 LODIndex = 0;
+
+	/** 烘焙时该LOD的渲染顶点数量，与运行时的渲染数据不一致时数据作废 */
+	UPROPERTY()
+	int32 NumVertices = 0;
+
+	/** FClothSurfaceUVTable::SaveToBytes保存的数据 */
+	UPROPERTY()
+	TArray<uint8> Data;
+};
+
+/**
+ * 随骨骼网格体保存和烘焙的布料断裂区域数据
+ * 在编辑器中通过派生数据缓存构建，烘焙时按目标平台的渲染数据重建，运行时直接加载，不需要读取渲染数据。
+ * 记录了网格体的派生数据键和各LOD的顶点数量，网格体重新导入后旧数据不会被误用
+ */
+UCLASS()
+class CHAOSCLOTHBROKENEXT_API UClothBreakRegionUserData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	/** 各LOD的表面查找表 */
+	UPROPERTY()
+	TArray<FClothBreakRegionLODData> LODs;
+
+#if WITH_EDITORONLY_DATA
+	/** 烘焙时网格体的派生数据键，为其他平台烘焙时附带平台名，编辑器中不会使用 */
+	UPROPERTY()
+	FString SourceMeshKey;
+#endif
+
+	/**
+	 * 查找某个LOD的烘焙数据
+	 * @param LODIndex 渲染LOD
+	 * @return 烘焙数据，没有该LOD时返回空
+	 */
+	const FClothBreakRegionLODData* FindLOD(int32 LODIndex) const;
+
+	/**
+	 * 加载某个LOD的表面查找表
+	 * @param LODIndex 渲染LOD
+	 * @return 查找表，没有该LOD的数据或版本不匹配时返回空
+	 */
+	TSharedPtr<FClothSurfaceUVTable> LoadTable(int32 LODIndex) const;
+
+	/**
+	 * 检查某个LOD的数据是否与网格体当前的渲染数据一致
+	 * 编辑器中比较派生数据键，所有构建中比较顶点数量，只能在游戏线程调用
+	 * @param Mesh 骨骼网格体
+	 * @param LODIndex 渲染LOD
+	 * @return 有该LOD的数据且与网格体一致时返回true
+	 */
+	bool IsUpToDate(const USkeletalMesh* Mesh, int32 LODIndex) const;
+
+	/** 查找骨骼网格体上的区域数据 */
+	static const UClothBreakRegionUserData* Find(const USkeletalMesh* Mesh);
+
+#if WITH_EDITOR
+	/**
+	 * 为所属骨骼网格体的所有LOD构建表面查找表
+	 * @param TargetPlatform 目标平台，为空或为当前平台时使用编辑器的渲染数据和派生数据缓存
+	 * @return 成功构建的LOD数量
+	 */
+	int32 Bake(const ITargetPlatform* TargetPlatform = nullptr);
+
+	/**
+	 * 为骨骼网格体添加区域数据并烘焙
+	 * @param Mesh 骨骼网格体
+	 * @return 成功构建的LOD数量
+	 */
+	static int32 BakeMesh(USkeletalMesh* Mesh);
+
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+};
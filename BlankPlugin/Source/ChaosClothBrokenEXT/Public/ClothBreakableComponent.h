@@ -8,12 +8,112 @@
 #include "ClothingSimulationInterface.h"
 #include "BulletImpactHandler.h"
 #include "ClothFragmentGenerator.h"
+#include "ClothBreakFrameArena.h"
+#include "ClothHoleMask.h"
+#include "ClothSimSnapshot.h"
+#include "ClothDamageLoosening.h"
+#include "ClothBreakMemory.h"
 #include "ClothBreakableComponent.generated.h"
 
+class UMaterialInstanceDynamic;
+class UClothBreakableComponent;
+
+/**
+ * 布料断裂组件的就绪状态
+ */
+UENUM(BlueprintType)
+enum class EClothBreakableReadiness : uint8
+{
+	/** 尚未初始化，不接受冲击 */
+	Uninitialized,
+	/** 正在后台加载区域数据，冲击走简化路径，限定了可断裂材质时简化路径拒绝冲击 */
+	Building,
+	/** 区域数据已就绪 */
+	Ready,
+	/** 区域数据暂不可用，冲击走简化路径，之后定期重新加载，成功后变为Ready并再次广播 */
+	Failed,
+};
+
+/**
+ * 一次断裂的记录
+ * 供原生监听者使用，按值传递，不经过反射系统
+ */
+struct FClothBreakRecord
+{
+	/** 断裂的组件，批量派发前已销毁的组件的记录会被丢弃 */
+	TWeakObjectPtr<UClothBreakableComponent> Component;
+
+	/** 目标骨骼网格体组件 */
+	TWeakObjectPtr<USkeletalMeshComponent> SkeletalMeshComponent;
+
+	/** 世界空间断裂位置 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 断裂半径 */
+	float Radius = 0.0f;
+
+	/** 碰撞力 */
+	float ImpactForce = 0.0f;
+
+	/** 材质ID */
+	int32 MaterialID = INDEX_NONE;
+};
+
+// 原生断裂事件，每次断裂立即派发
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnClothBreakNative, const FClothBreakRecord&);
+
+// 区域数据加载完成事件，Readiness为Ready或Failed，失败后重试成功时以Ready再次广播
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnClothBreakableReady, UClothBreakableComponent*, Component,
+	EClothBreakableReadiness, Readiness);
+
 // 布料断裂事件委托
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FOnClothBreakEvent, USkeletalMeshComponent*, SkeletalMeshComponent,
 	FVector, BreakLocation, float, BreakRadius, float, ImpactForce, int32, MaterialID);
 
+/**
+ * 布料上的一个破洞
+ * 位置记录在目标骨骼网格体组件空间中，随角色移动保持有效
+ */
+USTRUCT(BlueprintType)
+struct FClothBreakHole
+{
+	GENERATED_BODY()
+
+	/** 参考姿势下组件空间中的破洞中心，与表面查找表一致，不随动画变化 */
+	UPROPERTY(BlueprintReadOnly, Category = "Cloth Breaking")
+	FVector3f LocalCenter = FVector3f::ZeroVector;
+
+	/** 破洞半径 */
+	UPROPERTY(BlueprintReadOnly, Category = "Cloth Breaking")
+	float Radius = 0.0f;
+
+	/** 材质ID */
+	UPROPERTY(BlueprintReadOnly, Category = "Cloth Breaking")
+	int32 MaterialID = INDEX_NONE;
+
+	/** 是否为撕裂扩展的范围，每条撕裂只有一个随撕裂增长的记录 */
+	UPROPERTY(BlueprintReadOnly, Category = "Cloth Breaking")
+	bool bTear = false;
+};
+
+/**
+ * 一个材质槽位的破洞遮罩
+ * 破洞以UV坐标写入动态材质实例的向量参数，超出容量后覆盖最早的破洞
+ */
+USTRUCT()
+struct FClothHoleMaskSlot
+{
+	GENERATED_BODY()
+
+	/** 材质槽位的动态材质实例 */
+	UPROPERTY()
+	UMaterialInstanceDynamic* Material = nullptr;
+
+	/** 下一个写入的参数槽位 */
+	UPROPERTY()
+	int32 NextHole = 0;
+};
+
 /**
  * 管理布料断裂行为的组件
  * 专注于子弹碰撞断裂功能
@@ -26,14 +126,18 @@ class CHAOSCLOTHBROKENEXT_API UClothBreakableComponent : public UActorComponent
 public:
 	UClothBreakableComponent();
 
+	virtual void PostLoad() override;
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-	/** 布料断裂设置 */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking")
+	/** 共享的布料断裂设置资产，为空时使用默认设置；蓝图赋值经过SetBreakableSettings */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetBreakableSettings, Category = "Cloth Breaking")
 	UClothBreakableSettings* BreakableSettings;
 
+	/** 本组件对共享设置的覆盖；蓝图赋值经过SetSettingsOverrides */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetSettingsOverrides, Category = "Cloth Breaking")
+	FClothBreakableSettingsOverrides SettingsOverrides;
+
 	/** 目标骨骼网格体组件 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking")
 	USkeletalMeshComponent* TargetSkeletalMesh;
@@ -42,9 +146,22 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Cloth Breaking")
 	FOnClothBreakEvent OnClothBreak;
 
-	/** 手动触发布料在指定位置断裂 */
+	/** 原生断裂事件，与OnClothBreak同时派发，不经过反射系统 */
+	FOnClothBreakNative OnClothBreakNative;
+
+	/** 区域数据加载完成事件 */
+	UPROPERTY(BlueprintAssignable, Category = "Cloth Breaking")
+	FOnClothBreakableReady OnBreakableReady;
+
+	/**
+	 * 手动触发布料在指定位置断裂
+	 * @param WorldLocation 世界空间位置
+	 * @param Radius 断裂半径
+	 * @return 有子系统时表示冲击已加入断裂队列，区域判断在之后进行，实际断裂以OnClothBreak为准；
+	 *         没有子系统时同步处理，表示是否实际断裂
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
-	void ForceBreakClothAtLocation(FVector WorldLocation, float Radius);
+	bool ForceBreakClothAtLocation(FVector WorldLocation, float Radius);
 
 	/** 设置材质ID是否可断裂 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
@@ -52,8 +169,10 @@ public:
 
 	/**
 	 * 处理子弹碰撞事件
+	 * 断裂区域判断、碎片生成和事件派发在本帧UClothBreakingSubsystem的Tick中统一进行
 	 * @param HitResult 碰撞结果
-	 * @return 是否成功处理碰撞
+	 * @return 有子系统时表示冲击已加入断裂队列，区域判断在之后进行，实际断裂以OnClothBreak为准；
+	 *         没有子系统时同步处理，表示是否实际断裂
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
 	bool HandleBulletHit(const FHitResult& HitResult);
@@ -63,20 +182,235 @@ public:
 	 * @param ImpactLocation 碰撞位置
 	 * @param BulletSize 子弹大小
 	 * @param ImpactForce 碰撞力
-	 * @return 是否成功模拟碰撞
+	 * @return 有子系统时表示冲击已加入断裂队列，区域判断在之后进行，实际断裂以OnClothBreak为准；
+	 *         没有子系统时同步处理，表示是否实际断裂
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
 	bool SimulateBulletImpact(FVector ImpactLocation, float BulletSize, float ImpactForce);
 
+	/** 更换共享设置资产 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
+	void SetBreakableSettings(UClothBreakableSettings* NewSettings);
+
+	/** 更换本组件的设置覆盖 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
+	void SetSettingsOverrides(const FClothBreakableSettingsOverrides& NewOverrides);
+
+	/** 获取本组件的设置覆盖 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking")
+	const FClothBreakableSettingsOverrides& GetSettingsOverrides() const { return SettingsOverrides; }
+
+	/** 获取合并后的运行时设置 */
+	const FClothBreakableRuntimeSettings& GetRuntimeSettings() const { return RuntimeSettings; }
+
+	/** 重新合并共享设置和覆盖，并同步到子系统 */
+	void RefreshRuntimeSettings();
+
+	/** 是否已完成初始化 */
+	bool IsBreakableInitialized() const { return bIsInitialized; }
+
+	/** 获取就绪状态 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking")
+	EClothBreakableReadiness GetReadiness() const { return Readiness; }
+
+	/**
+	 * 尝试初始化，目标骨骼网格体尚未设置时返回false
+	 * @return 是否已完成初始化
+	 */
+	bool TryInitialize();
+
+	/**
+	 * 确保已初始化
+	 * 有子系统的世界由子系统重试初始化，没有子系统的世界（例如编辑器预览）在每次使用时重试
+	 * @return 是否已完成初始化
+	 */
+	bool EnsureInitialized();
+
+	/**
+	 * 在布料上记录一次破洞
+	 * 由UClothBreakingSubsystem在游戏线程调用
+	 * @param Location 世界空间断裂位置
+	 * @param Radius 断裂半径
+	 * @param MaterialID 材质ID
+	 * @param HitBone 命中的骨骼索引，未知时为INDEX_NONE
+	 */
+	void ApplyBreakCut(const FVector& Location, float Radius, int32 MaterialID, int32 HitBone = INDEX_NONE);
+
+	/**
+	 * 把撕裂新断开的边合并到这条撕裂的破洞记录
+	 * 记录的包围球随撕裂增长，一条撕裂只占一个破洞记录
+	 * @param HoleIndex 这条撕裂已有的破洞索引，无效时新建记录
+	 * @param LocalPoints 组件空间中新断开的边的端点
+	 * @param MaterialID 材质ID
+	 * @return 这条撕裂的破洞索引
+	 */
+	int32 ExtendTearHole(int32 HoleIndex, TConstArrayView<FVector3f> LocalPoints, int32 MaterialID);
+
+	/**
+	 * 把撕裂新断开的粒子计入损伤，本帧结束时与破洞一起放松布料约束
+	 * 不受bLoosenClothOnDamage限制，撕裂总是通过放松布料约束表现
+	 * @param ClothingAssetIndex 布料资产索引
+	 * @param NumParticles 该布料资产的模拟粒子数量
+	 * @param NumTornParticles 新断开的粒子数量
+	 */
+	void AddTearDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumTornParticles);
+
+	/**
+	 * 按新增的损伤放松布料约束
+	 * 由UClothBreakingSubsystem每帧批量调用一次，同一帧的多个破洞只更新一次
+	 */
+	void ApplyDamageLoosening();
+
+	/**
+	 * 生成已规划的碎片
+	 * @param Fragments 碎片参数
+	 * @param MaterialID 材质ID
+	 */
+	void SpawnBreakFragments(TConstArrayView<FClothFragmentSpawnParams> Fragments, int32 MaterialID);
+
+	/**
+	 * 派发断裂事件
+	 * 依次派发原生事件、蓝图事件（有绑定时），并加入子系统本帧的批量通知
+	 */
+	void BroadcastBreak(const FVector& Location, float Radius, float ImpactForce, int32 MaterialID);
+
+	/**
+	 * 判断该位置的断裂是否需要生成碎片
+	 * 渲染LOD超过MaxFullBreakLOD时不生成碎片；启用破洞遮罩时，距离所有本地玩家视点都较远的命中只显示破洞
+	 * @param Location 世界空间断裂位置
+	 * @return 是否生成碎片
+	 */
+	bool ShouldSpawnFragments(const FVector& Location) const;
+
+	/**
+	 * 重建破洞遮罩
+	 * 清空材质参数后按最近的冲击破洞重新写入，用于恢复断裂状态之后，撕裂记录不写入遮罩
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
+	void RefreshHoleMask();
+
+	/** 碎片生成器，组件初始化前为空 */
+	UClothFragmentGenerator* GetFragmentGenerator() const { return FragmentGenerator; }
+
+	/** 当前渲染的LOD */
+	int32 GetRenderedLOD() const;
+
+	/** 当前渲染LOD是否执行完整断裂（碎片和撕裂） */
+	bool IsFullBreakLOD() const { return GetRenderedLOD() <= RuntimeSettings.MaxFullBreakLOD; }
+
+	/**
+	 * 当前渲染LOD的表面查找表，与同一网格体的其他组件共享
+	 * 渲染LOD变化后在后台加载新的表，加载完成前继续返回之前的表
+	 * @return 查找表，尚未加载或不可用时返回空
+	 */
+	TSharedPtr<const FClothSurfaceUVTable> GetSurfaceTable();
+
+	/**
+	 * 布料当前的模拟位置，每帧第一次调用时从骨骼网格体读取
+	 * 只能在游戏线程调用，返回的指针只在当帧有效
+	 * @return 快照，布料本帧没有模拟数据时返回空
+	 */
+	const FClothSimSnapshot* GetSimSnapshot();
+
+	/**
+	 * 当前姿势到参考姿势的骨骼映射，每帧最多更新一次
+	 * 只能在游戏线程调用，返回的指针在下一次调用之前有效
+	 * @return 映射，没有表面查找表或姿势不可用时返回空，跟随主姿势的组件读取主组件的姿势
+	 */
+	const FClothBindPoseMapping* GetBindPoseMapping();
+
+	/**
+	 * 把当前姿势下的组件空间位置映射回参考姿势
+	 * @param LocalLocation 组件空间位置
+	 * @param HitBone 命中的骨骼索引，未知时为INDEX_NONE
+	 * @return 参考姿势下的组件空间位置，无法映射时原样返回
+	 */
+	FVector3f ToBindPose(const FVector3f& LocalLocation, int32 HitBone = INDEX_NONE);
+
+	/**
+	 * 命中的骨骼名称在目标骨骼网格体上的索引
+	 * @param BoneName 命中结果中的骨骼名称
+	 * @return 骨骼索引，名称为空或骨骼不存在时返回INDEX_NONE
+	 */
+	int32 FindHitBone(FName BoneName) const;
+
+	/**
+	 * 统计本组件持有的内存
+	 * 撕裂状态由子系统持有，由子系统填写
+	 * @param OutStats 输出的统计
+	 */
+	void GetMemoryStats(FClothBreakableMemoryStats& OutStats);
+
+	/** 获取已记录的破洞 */
+	const TArray<FClothBreakHole>& GetBreakHoles() const { return BreakHoles; }
+
+	/** 已记录的破洞数量 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking")
+	int32 GetNumBreakHoles() const { return BreakHoles.Num(); }
+
+	/**
+	 * 保存断裂状态
+	 * 破洞在组件空间中量化为紧凑的二进制数据，之后是各布料资产的损伤，并记录网格体版本，可直接写入存档
+	 * @param OutData 输出的断裂状态数据
+	 * @return 是否成功保存，破洞超出量化范围时记录错误并返回false
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Save")
+	bool SaveBreakState(TArray<uint8>& OutData) const;
+
+	/**
+	 * 恢复断裂状态
+	 * 一次解码所有破洞，不重放冲击，不生成碎片也不派发事件
+	 * @param Data 由SaveBreakState保存的数据
+	 * @return 是否成功恢复，版本或网格体不匹配时返回false
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Save")
+	bool RestoreBreakState(const TArray<uint8>& Data);
+
+	/** 清除所有破洞 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Save")
+	void ClearBreakState();
+
+	/** 断裂状态对应的网格体版本，网格体变化后旧的断裂状态不再适用 */
+	uint32 GetBreakStateMeshKey() const;
+
 protected:
 	/** 初始化可断裂布料 */
 	void InitializeBreakableCloth();
 
-	/** 在指定位置生成碎片 */
-	void GenerateFragmentsAtLocation(const FVector& Location, float Radius, float ImpactForce);
+	/**
+	 * 请求某个LOD的表面查找表，已加载时立即切换，否则在后台加载
+	 * @param LODIndex 渲染LOD
+	 */
+	void RequestSurfaceTable(int32 LODIndex);
+
+	/** 表面查找表加载完成 */
+	void HandleSurfaceTableLoaded(int32 LODIndex, TSharedPtr<const FClothSurfaceUVTable> Table);
+
+	/**
+	 * 将断裂交给子系统排队，没有子系统时立即处理
+	 * @param Normal 世界空间的布料表面法线，未知时为零向量
+	 * @param HitBone 命中的骨骼索引，未知时为INDEX_NONE
+	 * @return 有子系统时表示是否已入队，没有子系统时表示是否实际断裂
+	 */
+	bool DispatchBreak(const FVector& Location, float Radius, float ImpactForce, float FragmentMultiplier = 1.0f,
+		const FVector& Normal = FVector::ZeroVector, int32 HitBone = INDEX_NONE);
+
+	/** 在指定位置生成碎片，碎片在与Normal垂直的平面内展开 */
+	void GenerateFragmentsAtLocation(const FVector& Location, float Radius, float ImpactForce, int32 MaterialID, float FragmentMultiplier = 1.0f,
+		const FVector& Normal = FVector::ZeroVector);
+
+	/** 检查位置是否在可断裂区域内，HitBone为命中的骨骼索引，未知时为INDEX_NONE */
+	bool IsLocationInBreakableRegion(const FVector& Location, int32& OutMaterialID, int32 HitBone = INDEX_NONE);
+
+	/**
+	 * 将冲击破洞写入所在材质槽位的遮罩，只在破洞记录的材质上查找表面
+	 * @param Hole 破洞
+	 * @return 是否成功写入，撕裂记录、表面UV不可用或附近没有该材质的表面时返回false
+	 */
+	bool WriteHoleMask(const FClothBreakHole& Hole);
 
-	/** 检查位置是否在可断裂区域内 */
-	bool IsLocationInBreakableRegion(const FVector& Location, int32& OutMaterialID);
+	/** 输出一次断裂流程的堆分配统计 */
+	void ReportBreakAllocations(const FClothBreakAllocationCounter::FScope& Scope, const TCHAR* Context) const;
 
 	/** 注册碰撞事件 */
 	void RegisterHitEvents();
@@ -87,9 +421,58 @@ protected:
 		UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
 private:
+	friend class UClothBreakingSubsystem;
+
 	// 是否已初始化
 	bool bIsInitialized;
 
+	// 就绪状态
+	EClothBreakableReadiness Readiness;
+
+	// 在子系统运行时状态数组中的索引
+	int32 RuntimeStateIndex;
+
+	// 合并后的运行时设置
+	FClothBreakableRuntimeSettings RuntimeSettings;
+
+	// 已记录的破洞
+	UPROPERTY()
+	TArray<FClothBreakHole> BreakHoles;
+
+	// 持有的表面查找表引用，保证共享的表在使用期间不被释放
+	TSharedPtr<const FClothSurfaceUVTable> SurfaceTable;
+
+	// 表面查找表对应的LOD
+	int32 SurfaceTableLOD;
+
+	// 正在加载的表面查找表的LOD
+	int32 PendingSurfaceTableLOD;
+
+	// 表面查找表加载失败后，在此时间（FPlatformTime::Seconds）之前不再重新请求
+	double SurfaceTableRetryTime;
+
+	// 按需读取的布料模拟位置，数组在帧间复用
+	FClothSimSnapshot SimSnapshot;
+
+	// 当前姿势到参考姿势的骨骼映射
+	FClothBindPoseMapping BindPoseMapping;
+
+	// 骨骼映射对应的查找表，只用于比较
+	const FClothSurfaceUVTable* BindPoseMappingTable = nullptr;
+
+	// 骨骼映射更新时的帧号
+	uint64 BindPoseMappingFrame = 0;
+
+	// 骨骼映射是否可用
+	bool bBindPoseMappingValid = false;
+
+	// 破洞和撕裂对各布料资产造成的损伤，随断裂状态保存在破洞之后
+	FClothDamageLooseningState DamageLoosening;
+
+	// 按材质槽位的破洞遮罩
+	UPROPERTY()
+	TMap<int32, FClothHoleMaskSlot> HoleMaskSlots;
+
 	// 碰撞事件处理器句柄
 	FDelegateHandle ClothCollisionDelegateHandle;
 
@@ -49,7 +49,7 @@ public:
 	 * @param SkeletalMeshComponent 目标骨骼网格体组件
 	 * @param WorldLocation 世界空间中的位置
 	 * @param Radius 影响半径
-	 * @return 是否成功触发断裂
+	 * @return 是否成功触发断裂，有子系统时表示已加入断裂队列
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Manual")
 	static bool ForceBreakClothAtLocation(USkeletalMeshComponent* SkeletalMeshComponent, FVector WorldLocation, float Radius);
@@ -85,7 +85,7 @@ public:
 	 * @param ImpactLocation 碰撞位置
 	 * @param BulletSize 子弹大小
 	 * @param ImpactForce 碰撞力
-	 * @return 是否成功模拟碰撞
+	 * @return 是否成功模拟碰撞，有子系统时表示已加入断裂队列
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Bullet")
 	static bool SimulateBulletImpact(USkeletalMeshComponent* SkeletalMeshComponent,
@@ -95,7 +95,7 @@ public:
 	 * 处理子弹碰撞事件
 	 * @param SkeletalMeshComponent 目标骨骼网格体组件
 	 * @param HitResult 碰撞结果
-	 * @return 是否成功处理碰撞
+	 * @return 是否成功处理碰撞，有子系统时表示已加入断裂队列
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Bullet")
 	static bool HandleBulletHit(USkeletalMeshComponent* SkeletalMeshComponent,
@@ -141,4 +141,13 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Utility")
 	static bool HasCloth(USkeletalMeshComponent* SkeletalMeshComponent);
+
+	/**
+	 * 为骨骼网格体烘焙断裂区域表
+	 * 数据随网格体保存和烘焙，运行时所有使用该网格体的组件共享，不再从渲染数据构建。仅在编辑器中有效
+	 * @param SkeletalMesh 骨骼网格体
+	 * @return 成功烘焙的LOD数量
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Utility")
+	static int32 BakeClothBreakRegionTables(USkeletalMesh* SkeletalMesh);
 };
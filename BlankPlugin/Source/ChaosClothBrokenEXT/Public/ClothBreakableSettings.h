@@ -3,21 +3,44 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
+#include "Engine/DataAsset.h"
+#include "BulletProfile.h"
+#include "ClothFragmentStrategies.h"
 #include "ClothBreakableSettings.generated.h"
 
+class UClothBreakableSettings;
+class USkeletalMesh;
+
+/** 布料断裂设置资产被修改的委托 */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnClothBreakableSettingsChanged, const UClothBreakableSettings*);
+
 /**
  * 存储布料断裂设置
  * 专注于子弹碰撞断裂功能
+ * 作为共享资产被多个组件引用，运行时只读，实例差异通过FClothBreakableSettingsOverrides表达
  */
 UCLASS(BlueprintType)
-class CHAOSCLOTHBROKENEXT_API UClothBreakableSettings : public UObject
+class CHAOSCLOTHBROKENEXT_API UClothBreakableSettings : public UPrimaryDataAsset
 {
 	GENERATED_BODY()
 
 public:
 	UClothBreakableSettings();
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * 在蓝图或代码中修改属性后调用，引用该资产的组件重建运行时设置
+	 * 共享资产的修改会影响所有引用它的组件，单个组件的差异应使用SetSettingsOverrides
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
+	void NotifySettingsChanged();
+
+	/** 设置资产被修改时广播，引用该资产的组件据此重建运行时设置；参数为空表示全局控制台变量变化，所有组件都需重建 */
+	static FOnClothBreakableSettingsChanged OnSettingsChanged;
+
 	/** 可断裂区域的材质ID列表 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|General")
 	TArray<int32> BreakableMaterialIDs;
@@ -30,6 +53,72 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Bullet", meta = (ClampMin = "0.1"))
 	float RadiusMultiplier;
 
+	/** 子弹类到子弹配置的映射，按类继承关系匹配最接近的配置 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Bullet")
+	TMap<TSoftClassPtr<AActor>, UBulletProfile*> BulletProfiles;
+
+	/** 没有匹配到子弹配置时使用的默认配置，为空时回退为探测子弹的物理状态 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Bullet")
+	UBulletProfile* DefaultBulletProfile;
+
+	/** 是否启用多层穿透，启用后一次扫描找出弹道上的所有布料层 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Penetration")
+	bool bEnablePenetration;
+
+	/** 穿透扫描的最大深度 (厘米) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Penetration", meta = (EditCondition = "bEnablePenetration", ClampMin = "1.0"))
+	float MaxPenetrationDepth;
+
+	/** 最多穿透的布料层数 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Penetration", meta = (EditCondition = "bEnablePenetration", ClampMin = "1", ClampMax = "8"))
+	int32 MaxPenetrationLayers;
+
+	/** 穿过本层后保留的能量比例 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Penetration", meta = (EditCondition = "bEnablePenetration", ClampMin = "0.0", ClampMax = "1.0"))
+	float PenetrationEnergyRetention;
+
+	/**
+	 * 是否启用撕裂扩展，破洞周围拉伸过大的边会继续断开
+	 * 断开的边计入布料的损伤，布料约束按DamageLooseness随之放松，不需要同时启用bLoosenClothOnDamage
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Tearing")
+	bool bEnableTearPropagation;
+
+	/** 边断开的应变阈值，(当前长度 - 静止长度) / 静止长度 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Tearing", meta = (EditCondition = "bEnableTearPropagation", ClampMin = "0.0"))
+	float TearStrainThreshold;
+
+	/** 每条撕裂每帧最多处理的前沿顶点数 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Tearing", meta = (EditCondition = "bEnableTearPropagation", ClampMin = "1"))
+	int32 MaxTearStepsPerFrame;
+
+	/** 每条撕裂最多断开的边数 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Tearing", meta = (EditCondition = "bEnableTearPropagation", ClampMin = "1"))
+	int32 MaxTearLength;
+
+	/**
+	 * 受损后是否放松整块布料，破洞覆盖的模拟粒子越多，该布料资产的动画驱动和拴系刚度越低，不重建网格
+	 * 布料模拟交互器不支持逐粒子权重，放松作用于整个布料资产，破损处不会单独下垂，默认关闭
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Damage")
+	bool bLoosenClothOnDamage;
+
+	/** 损伤比例对约束的松弛倍率，动画驱动和拴系刚度按 1 - 损伤比例 * 倍率 缩放，拴系刚度不低于配置的一半 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Damage", meta = (EditCondition = "bLoosenClothOnDamage || bEnableTearPropagation", ClampMin = "0.0", ClampMax = "1.0"))
+	float DamageLooseness;
+
+	/** 是否启用破洞遮罩，破洞写入布料材质参数，通过Opacity Mask显示 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Hole Mask")
+	bool bEnableHoleMask;
+
+	/** 距离相机超过该值的命中只写入破洞遮罩，不生成碎片；0表示总是生成碎片 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Hole Mask", meta = (EditCondition = "bEnableHoleMask", ClampMin = "0.0"))
+	float FullBreakCameraDistance;
+
+	/** 完整断裂的最大渲染LOD，更低精度的LOD上只记录破洞，不生成碎片也不扩展撕裂 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|LOD", meta = (ClampMin = "0"))
+	int32 MaxFullBreakLOD;
+
 	/** 断裂时生成的最小碎片数量 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Fragments", meta = (ClampMin = "1", ClampMax = "10"))
 	int32 MinFragmentCount;
@@ -38,6 +127,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Fragments", meta = (ClampMin = "1", ClampMax = "20"))
 	int32 MaxFragmentCount;
 
+	/** 碎片生成策略 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Fragments")
+	EClothFragmentStrategy FragmentStrategy;
+
 	/** 碎片最小尺寸 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Fragments", meta = (ClampMin = "0.1"))
 	float MinFragmentSize;
@@ -57,4 +150,131 @@ public:
 	/** 碎片物理质量 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Physics", meta = (EditCondition = "bEnableFragmentPhysics", ClampMin = "0.1"))
 	float FragmentMass;
+
+	/**
+	 * 使用这套设置的骨骼网格体
+	 * 关卡中第一个引用这套设置的组件初始化时在后台加载并预热，之后才生成的角色第一次断裂时不再需要加载查找表和构建碎片网格
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking|Prewarm")
+	TArray<TSoftObjectPtr<USkeletalMesh>> PrewarmMeshes;
+
+	/** 设置的修改版本，每次通知修改时递增，依赖设置内容的缓存据此判断是否失效 */
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	/** 修改版本 */
+	uint32 Revision = 0;
+};
+
+/**
+ * 单个组件对共享设置的稀疏覆盖
+ * 只有勾选的字段会替换共享资产中的值
+ */
+USTRUCT(BlueprintType)
+struct CHAOSCLOTHBROKENEXT_API FClothBreakableSettingsOverrides
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_BreakableMaterialIDs = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_BreakForceThreshold = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_RadiusMultiplier = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_FragmentCount = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_FragmentSize = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (InlineEditConditionToggle))
+	bool bOverride_FragmentPhysics = false;
+
+	/** 可断裂区域的材质ID列表 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_BreakableMaterialIDs"))
+	TArray<int32> BreakableMaterialIDs;
+
+	/** 触发断裂的力阈值 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_BreakForceThreshold", ClampMin = "0.0"))
+	float BreakForceThreshold = 1000.0f;
+
+	/** 子弹大小到断裂半径的倍率 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_RadiusMultiplier", ClampMin = "0.1"))
+	float RadiusMultiplier = 2.0f;
+
+	/** 断裂时生成的最小碎片数量 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentCount", ClampMin = "1", ClampMax = "10"))
+	int32 MinFragmentCount = 3;
+
+	/** 断裂时生成的最大碎片数量 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentCount", ClampMin = "1", ClampMax = "20"))
+	int32 MaxFragmentCount = 7;
+
+	/** 碎片最小尺寸 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentSize", ClampMin = "0.1"))
+	float MinFragmentSize = 5.0f;
+
+	/** 碎片最大尺寸 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentSize", ClampMin = "0.1"))
+	float MaxFragmentSize = 20.0f;
+
+	/** 是否启用碎片物理模拟 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentPhysics"))
+	bool bEnableFragmentPhysics = true;
+
+	/** 碎片物理质量 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentPhysics", ClampMin = "0.1"))
+	float FragmentMass = 1.0f;
+
+	/** 碎片生命周期 (秒) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Breaking", meta = (EditCondition = "bOverride_FragmentPhysics", ClampMin = "0.1"))
+	float FragmentLifetime = 5.0f;
+};
+
+/**
+ * 共享设置与实例覆盖合并后的扁平运行时设置
+ * 只在设置或覆盖变化时重建，断裂流程只读取这里，不再经过UObject
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothBreakableRuntimeSettings
+{
+	/** 来源的共享设置，用于查找子弹配置 */
+	const UClothBreakableSettings* Source = nullptr;
+
+	float BreakForceThreshold = 1000.0f;
+	float RadiusMultiplier = 2.0f;
+	float MinFragmentSize = 5.0f;
+	float MaxFragmentSize = 20.0f;
+	float FragmentLifetime = 5.0f;
+	float FragmentMass = 1.0f;
+	float MaxPenetrationDepth = 60.0f;
+	float PenetrationEnergyRetention = 0.6f;
+	float TearStrainThreshold = 0.15f;
+	float DamageLooseness = 1.0f;
+	float FullBreakCameraDistance = 1500.0f;
+	int32 MinFragmentCount = 3;
+	int32 MaxFragmentCount = 7;
+	int32 MaxPenetrationLayers = 4;
+	int32 MaxTearStepsPerFrame = 8;
+	int32 MaxTearLength = 256;
+	int32 MaxFullBreakLOD = 1;
+	bool bEnableFragmentPhysics = true;
+	bool bEnablePenetration = false;
+	bool bEnableTearPropagation = false;
+	bool bLoosenClothOnDamage = false;
+	bool bEnableHoleMask = false;
+	bool bEnableFragments = true;
+	EClothFragmentStrategy FragmentStrategy = EClothFragmentStrategy::SphereDebris;
+
+	/** 可断裂区域的材质ID列表，为空时所有区域可断裂 */
+	TArray<int32, TInlineAllocator<4>> BreakableMaterialIDs;
+
+	/**
+	 * 合并共享设置和实例覆盖
+	 * @param Settings 共享设置，为空时使用默认设置
+	 * @param Overrides 实例覆盖
+	 */
+	void Resolve(const UClothBreakableSettings* Settings, const FClothBreakableSettingsOverrides& Overrides);
 };
@@ -0,0 +1,776 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClothFragmentGenerator.h"
+#include "ClothBreakableSettings.h"
+#include "ClothBreakImpactRecording.h"
+#include "ClothTearPropagation.h"
+#include "ClothHoleMask.h"
+#include "ClothBreakableComponent.h"
+#include "ClothBreakingSubsystem.generated.h"
+
+class UClothBreakableComponent;
+class UClothingAssetBase;
+class UClothingAssetCommon;
+class USkeletalMesh;
+struct FBulletImpactParams;
+struct FStreamableHandle;
+
+/**
+ * 布料断裂组件的运行时状态
+ * 由子系统统一存放在连续数组中，工作线程只读取这里的数据
+ */
+struct FClothBreakableRuntimeState
+{
+	/** 所属组件 */
+	TWeakObjectPtr<UClothBreakableComponent> Component;
+
+	/** 组件运行时设置的副本，组件设置变化时同步 */
+	FClothBreakableRuntimeSettings Settings;
+
+	/** 撕裂状态，第一次需要撕裂时创建 */
+	TUniquePtr<FClothTearState> Tearing;
+
+	/** 解析冲击时的渲染LOD，每帧有冲击时在游戏线程更新 */
+	int32 LODIndex = 0;
+
+	/** 该LOD的表面查找表，渲染数据不可读时为空 */
+	TSharedPtr<const FClothSurfaceUVTable> SurfaceTable;
+
+	/** 目标骨骼网格体组件的变换，用于在工作线程把冲击转换到组件空间 */
+	FTransform ComponentTransform;
+
+	/** 目标骨骼网格体组件的世界包围盒中心，冲击没有法线时用于估计表面朝向 */
+	FVector BoundsOrigin = FVector::ZeroVector;
+
+	/** 组件本帧读取的布料模拟位置，本帧没有模拟数据时为空，解析结束后清空，不跨帧保存 */
+	const FClothSimSnapshot* SimSnapshot = nullptr;
+
+	/** 当前姿势到参考姿势的骨骼映射，没有表面查找表或姿势不可用时为空，只在本帧解析期间有效 */
+	const FClothBindPoseMapping* BindPose = nullptr;
+
+	/** 最近一次统计的组件内存，内存预算检查分批刷新 */
+	int64 MemoryBytes = 0;
+};
+
+/**
+ * 一次待处理的冲击
+ */
+struct FClothBreakImpact
+{
+	/** 运行时状态索引 */
+	int32 StateIndex = INDEX_NONE;
+
+	/** 世界空间冲击位置 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 世界空间的布料表面法线，未知时为零向量，规划碎片时由包围盒中心指向冲击点估计 */
+	FVector Normal = FVector::ZeroVector;
+
+	/** 断裂半径 */
+	float Radius = 0.0f;
+
+	/** 碰撞力 */
+	float Force = 0.0f;
+
+	/** 命中的骨骼索引，未知时为INDEX_NONE */
+	int32 HitBone = INDEX_NONE;
+
+	/** 碎片数量倍率 */
+	float FragmentMultiplier = 1.0f;
+
+	/** 随机种子，保证工作线程上的碎片规划可复现 */
+	int32 Seed = 0;
+};
+
+/**
+ * 冲击的解析结果
+ */
+struct FClothBreakResult
+{
+	/** 是否产生断裂 */
+	bool bBroken = false;
+
+	/** 命中的材质ID */
+	int32 MaterialID = INDEX_NONE;
+
+	/** 规划的碎片数量，碎片参数位于该冲击对应的碎片槽位中 */
+	int32 NumFragments = 0;
+};
+
+/**
+ * 断裂工作项类型，数值越小优先级越高
+ */
+enum class EClothBreakWorkType : uint8
+{
+	/** 布料本身的破洞，影响碰撞和可见外形，优先处理 */
+	Cut,
+	/** 断裂事件派发 */
+	Event,
+	/** 装饰性碎片，预算不足时顺延到之后的帧 */
+	Debris,
+
+	Count
+};
+
+/**
+ * 预热步骤类型
+ */
+enum class EClothBreakPrewarmStepType : uint8
+{
+	/** 构建一个尺寸档位的共享碎片网格及其碰撞 */
+	FragmentMesh,
+	/** 生成并立即销毁一个碎片，预热Actor生成和物理体创建 */
+	SpawnFragment,
+};
+
+/**
+ * 预热步骤
+ * 每一步只做一件有开销的事，在子系统Tick中按时间预算分帧执行
+ */
+struct FClothBreakPrewarmStep
+{
+	EClothBreakPrewarmStepType Type = EClothBreakPrewarmStepType::FragmentMesh;
+
+	/** 预热的骨骼网格体，提供材质 */
+	TWeakObjectPtr<USkeletalMesh> Mesh;
+
+	/** 碎片网格的形状 */
+	EClothFragmentShape Shape = EClothFragmentShape::Patch;
+
+	/** 碎片网格的尺寸档位 */
+	int32 SizeBucket = 0;
+
+	/** 生成的碎片是否模拟物理，与请求预热的运行时设置一致 */
+	bool bSimulatePhysics = true;
+};
+
+/**
+ * 可跨帧恢复的断裂工作项
+ */
+struct FClothBreakWorkItem
+{
+	/** 所属组件 */
+	TWeakObjectPtr<UClothBreakableComponent> Component;
+
+	/** 断裂位置，破洞工作项为组件空间，事件工作项为世界空间 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 断裂半径 */
+	float Radius = 0.0f;
+
+	/** 碰撞力 */
+	float Force = 0.0f;
+
+	/** 材质ID */
+	int32 MaterialID = INDEX_NONE;
+
+	/** 命中的骨骼索引，未知时为INDEX_NONE */
+	int32 HitBone = INDEX_NONE;
+
+	/** 碎片在碎片池中的起点 */
+	int32 FirstFragment = 0;
+
+	/** 碎片数量 */
+	int32 NumFragments = 0;
+
+	/** 下一个待生成的碎片，用于跨帧恢复 */
+	int32 NextFragment = 0;
+};
+
+/**
+ * 关卡流送移除时暂存的断裂状态
+ */
+struct FClothBreakStashedState
+{
+	/** SaveBreakState保存的数据 */
+	TArray<uint8> Data;
+
+	/** 暂存时间，用于丢弃最早的状态 */
+	double StashTime = 0.0;
+};
+
+/**
+ * 一次穿透扫描处理过的布料层
+ */
+struct FClothBreakPenetrationRecord
+{
+	/** 扫描时的帧号，超过几帧后记录失效，复用的子弹可以再次击穿同一件布料 */
+	uint64 FrameNumber = 0;
+
+	/** 已处理的布料层 */
+	TArray<TWeakObjectPtr<const UClothBreakableComponent>, TInlineAllocator<4>> Layers;
+};
+
+/**
+ * 冲击回放的统计数据，用于在相同负载下对比不同版本
+ */
+struct FClothBreakReplayStats
+{
+	/** 回放的帧数 */
+	int32 NumFrames = 0;
+
+	/** 回放的冲击数量 */
+	int32 NumImpacts = 0;
+
+	/** 找不到组件而跳过的冲击数量 */
+	int32 NumSkippedImpacts = 0;
+
+	/** 生成的碎片数量 */
+	int32 NumFragments = 0;
+
+	/** 子系统Tick的总耗时 (毫秒) */
+	double TotalTickMs = 0.0;
+
+	/** 子系统Tick的最大耗时 (毫秒) */
+	double MaxTickMs = 0.0;
+
+	/** 子系统Tick中的堆分配次数，需要以 -ClothBreakTrackAllocations 启动 */
+	int64 NumAllocations = 0;
+};
+
+/**
+ * 压力测试统计
+ */
+struct FClothBreakStressStats
+{
+	/** 压力测试的帧数 */
+	int32 NumFrames = 0;
+
+	/** 组件接受并排队的冲击数量 */
+	int32 NumQueuedImpacts = 0;
+
+	/** 解析后实际断裂的冲击数量 */
+	int32 NumImpacts = 0;
+
+	/** 被拒绝的冲击数量（低于阈值、组件未就绪或未命中可断裂区域） */
+	int32 NumRejectedImpacts = 0;
+
+	/** 已派发的断裂事件数量，工作项顺延时可能少于NumImpacts */
+	int32 NumBreaks = 0;
+
+	/** 生成的碎片数量 */
+	int32 NumFragments = 0;
+
+	/** 帧时间总和 (毫秒) */
+	double TotalFrameMs = 0.0;
+
+	/** 最大帧时间 (毫秒) */
+	double MaxFrameMs = 0.0;
+
+	/** 子系统Tick的总耗时 (毫秒)，包括没有冲击的帧 */
+	double TotalTickMs = 0.0;
+
+	/** 子系统Tick的最大耗时 (毫秒) */
+	double MaxTickMs = 0.0;
+};
+
+// 每帧一次的批量断裂通知，只包含组件仍然有效的记录，数组只在回调期间有效
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnClothBreaksBatched, TConstArrayView<FClothBreakRecord>);
+
+/**
+ * 布料断裂子系统
+ * 统一管理世界中所有布料断裂组件的运行时状态，每帧只有一次Tick：
+ * 先按角色分组并行解析排队的冲击，再在游戏线程统一生成碎片和派发事件。
+ * 没有排队的冲击时Tick几乎没有开销，开销与活跃断裂数量相关，与角色数量无关。
+ * 游戏线程的应用阶段受每帧时间预算限制：破洞优先，其次是事件，装饰性碎片最后，
+ * 预算用完后剩余的工作项顺延到之后的帧继续处理
+ */
+UCLASS()
+class CHAOSCLOTHBROKENEXT_API UClothBreakingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取指定世界的子系统 */
+	static UClothBreakingSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * 注册布料断裂组件
+	 * 组件尚未完成初始化时，子系统会在之后的Tick中重试
+	 * @param Component 组件
+	 */
+	void RegisterComponent(UClothBreakableComponent* Component);
+
+	/**
+	 * 注销布料断裂组件，同时丢弃其排队的冲击
+	 * @param Component 组件
+	 */
+	void UnregisterComponent(UClothBreakableComponent* Component);
+
+	/**
+	 * 暂存组件的断裂状态，用于关卡流送移除后再加载
+	 * @param Component 组件
+	 */
+	void StashBreakState(const UClothBreakableComponent* Component);
+
+	/**
+	 * 清除组件的撕裂状态，已断开的边恢复，正在扩展的撕裂停止
+	 * @param Component 组件
+	 */
+	void ResetTearState(const UClothBreakableComponent* Component);
+
+	/**
+	 * 恢复并移除组件暂存的断裂状态
+	 * @param Component 组件
+	 * @return 是否恢复了暂存的状态
+	 */
+	bool RestoreStashedBreakState(UClothBreakableComponent* Component);
+
+	/**
+	 * 同步组件的运行时设置
+	 * @param Component 组件
+	 */
+	void RefreshComponentSettings(UClothBreakableComponent* Component);
+
+	/**
+	 * 将冲击加入队列，在本帧子系统Tick中统一处理
+	 * @param Component 组件
+	 * @param Location 世界空间冲击位置
+	 * @param Radius 断裂半径
+	 * @param Force 碰撞力
+	 * @param FragmentMultiplier 碎片数量倍率
+	 * @param Normal 世界空间的布料表面法线，碎片在与其垂直的平面内展开，未知时传零向量
+	 * @param HitBone 命中的骨骼索引，用于把命中点映射回参考姿势，未知时传INDEX_NONE
+	 * @return 是否成功加入队列
+	 */
+	bool QueueImpact(UClothBreakableComponent* Component, const FVector& Location, float Radius, float Force,
+		float FragmentMultiplier = 1.0f, const FVector& Normal = FVector::ZeroVector, int32 HitBone = INDEX_NONE);
+
+	/**
+	 * 登记有新损伤的组件，本帧Tick结束时统一放松布料约束
+	 * @param Component 组件
+	 */
+	void QueueDamageLoosening(UClothBreakableComponent* Component);
+
+	/**
+	 * 沿弹道做一次多重扫描，找出入口层之后的所有布料层并一起加入队列
+	 * 剩余能量按每层的PenetrationEnergyRetention衰减，低于某层的断裂阈值时子弹停在该层
+	 * @param EntryComponent 子弹首先击中的组件
+	 * @param HitResult 入口碰撞结果
+	 * @param Params 入口处的冲击参数
+	 * @return 加入队列的层数
+	 */
+	int32 QueuePenetratingImpact(UClothBreakableComponent* EntryComponent, const FHitResult& HitResult, const FBulletImpactParams& Params);
+
+	/**
+	 * 检查组件是否已被该子弹最近一次的穿透扫描处理过
+	 * 内层的碰撞回调据此跳过，避免同一发子弹重复断裂，扫描几帧之后记录失效
+	 * @param Component 组件
+	 * @param Projectile 子弹
+	 * @return 是否已处理
+	 */
+	bool WasPenetratedBy(const UClothBreakableComponent* Component, const AActor* Projectile) const;
+
+	/**
+	 * 每帧一次的批量断裂通知
+	 * 本帧所有断裂的记录在子系统Tick结束时以连续数组一次派发，适合音效等需要聚合或剔除的系统
+	 */
+	FOnClothBreaksBatched& OnBreaksBatched() { return BreaksBatchedDelegate; }
+
+	/**
+	 * 加入本帧的批量断裂通知
+	 * @param Record 断裂记录
+	 */
+	void AddBreakRecord(const FClothBreakRecord& Record);
+
+	/** 开始录制进入断裂流程的所有冲击 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Replay")
+	void StartImpactRecording();
+
+	/**
+	 * 停止录制并保存
+	 * @param Filename 文件路径，为空时使用默认路径
+	 * @return 是否成功保存
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Replay")
+	bool StopImpactRecording(const FString& Filename);
+
+	/**
+	 * 回放录制的冲击
+	 * @param Filename 文件路径，为空时使用默认路径
+	 * @param bMaxSpeed 为true时每帧回放录制中的一帧，否则按录制时的时间回放
+	 * @return 是否成功开始回放
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Replay")
+	bool StartImpactReplay(const FString& Filename, bool bMaxSpeed);
+
+	/** 是否正在录制 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Replay")
+	bool IsRecordingImpacts() const { return Recording.IsValid(); }
+
+	/** 是否正在回放 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Replay")
+	bool IsReplayingImpacts() const { return Replay.IsValid(); }
+
+	/**
+	 * 开始压力测试
+	 * 按给定速率向所有已注册组件轮流发出随机的SimulateBulletImpact，结束时输出吞吐量和帧时间统计
+	 * @param ImpactsPerSecond 每秒的冲击数量
+	 * @param DurationSeconds 持续时间（秒）
+	 * @return 是否成功开始
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Performance")
+	bool StartStressTest(float ImpactsPerSecond, float DurationSeconds);
+
+	/** 是否正在压力测试 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Performance")
+	bool IsStressTesting() const { return StressImpactsPerSecond > 0.0f; }
+
+	/**
+	 * 预热骨骼网格体的断裂资源，减轻本局第一次断裂的卡顿
+	 * 通过软引用在后台加载网格体，加载完成后请求表面查找表，
+	 * 并在之后的帧中按时间预算创建共享碎片材质、碎片网格及碰撞，以及生成一个用后即毁的碎片。
+	 * 只覆盖共享资源：每个组件的破洞遮罩材质实例仍在该组件第一次断裂时创建，第一次断裂仍比之后的断裂略慢
+	 * @param Meshes 要预热的骨骼网格体
+	 * @param Settings 决定碎片尺寸范围的设置，为空时使用默认设置
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Performance")
+	void PrewarmMeshes(const TArray<TSoftObjectPtr<USkeletalMesh>>& Meshes, const UClothBreakableSettings* Settings);
+
+	/**
+	 * 预热组件当前的骨骼网格体，以及其设置资产中列出的网格体
+	 * ClothBreak.AutoPrewarm开启时组件初始化后自动调用
+	 * @param Component 组件
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Performance")
+	void PrewarmComponent(UClothBreakableComponent* Component);
+
+	/** 是否还有尚未完成的预热 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Performance")
+	bool IsPrewarming() const { return NumPendingPrewarmLoads > 0 || PrewarmStepHead < PrewarmSteps.Num(); }
+
+	/**
+	 * 检查位置是否在可断裂区域内
+	 * 优先按模拟快照中最近的布料粒子确定材质，不在布料附近时把位置映射回参考姿势，
+	 * 按渲染LOD的表面查找最近顶点所在的材质，两者都找不到时拒绝，只读取传入的数据，可在工作线程调用
+	 * @param Settings 运行时设置
+	 * @param SimSnapshot 本帧的布料模拟位置，可为空
+	 * @param SurfaceTable 当前渲染LOD的表面查找表，为空且没有命中模拟粒子时只在未限定可断裂材质时通过
+	 * @param BindPose 当前姿势到参考姿势的骨骼映射，为空时直接按组件空间位置查找
+	 * @param LocalLocation 组件空间位置
+	 * @param OutMaterialID 输出的材质ID，无法确定时为INDEX_NONE
+	 * @param OutSurfaceLocation 输出的组件空间表面位置，命中布料时为最近的模拟粒子，否则为LocalLocation
+	 * @param HitBone 命中的骨骼索引，映射回参考姿势时优先使用，未知时为INDEX_NONE
+	 * @return 是否在可断裂区域内
+	 */
+	static bool IsLocationInBreakableRegion(const FClothBreakableRuntimeSettings& Settings, const FClothSimSnapshot* SimSnapshot,
+		const FClothSurfaceUVTable* SurfaceTable, const FClothBindPoseMapping* BindPose, const FVector3f& LocalLocation,
+		int32& OutMaterialID, FVector3f& OutSurfaceLocation, int32 HitBone = INDEX_NONE);
+
+	/** 已注册的组件数量 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Debug")
+	int32 GetNumRegisteredComponents() const { return States.Num(); }
+
+	/**
+	 * 统计插件的内存占用
+	 * 按网格体统计共享的表面查找表和撕裂边图，按组件统计各自持有的对象、快照和存活碎片，
+	 * 再加上碎片共享资源和子系统自身的队列。遍历所有组件，只用于ClothBreak.MemReport等按需的报告，
+	 * 只读取CPU端数据，-nullrhi下同样可用
+	 * @param Ar 输出明细的设备，为空时只计算合计
+	 * @return 估算的总字节数
+	 */
+	int64 ReportMemory(FOutputDevice* Ar = nullptr);
+
+	/** 当前排队的冲击数量 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Debug")
+	int32 GetNumPendingImpacts() const { return PendingImpacts.Num(); }
+
+	/** 当前尚未完成的工作项数量 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Debug")
+	int32 GetNumPendingWorkItems() const;
+
+	/**
+	 * 设置每帧布料断裂的时间预算，优先于画质档位的预算
+	 * 只有控制台变量ClothBreak.FrameBudgetMs不小于0时优先使用控制台变量
+	 * @param BudgetMs 毫秒，0表示不限制，小于0时恢复为画质档位的预算
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking|Performance")
+	void SetFrameBudgetMs(float BudgetMs) { FrameBudgetMs = BudgetMs; }
+
+	/** 获取当前生效的每帧布料断裂时间预算（毫秒），0表示不限制 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Performance")
+	float GetFrameBudgetMs() const;
+
+protected:
+	/** 共享设置资产被修改时，重建引用该资产的组件的运行时设置 */
+	void HandleSettingsChanged(const UClothBreakableSettings* Settings);
+
+	/** 使用指定的随机种子将冲击加入队列 */
+	bool QueueImpactWithSeed(UClothBreakableComponent* Component, const FVector& Location, float Radius, float Force,
+		float FragmentMultiplier, int32 Seed, const FVector& Normal = FVector::ZeroVector, int32 HitBone = INDEX_NONE);
+
+	/** 录制一次已解析的冲击 */
+	void RecordImpact(const FClothBreakImpact& Impact, const FClothBreakResult& Result);
+
+	/** 将到期的录制冲击加入队列 */
+	void FeedReplayImpacts();
+
+	/** 按速率发出本帧的压力测试冲击 */
+	void FeedStressImpacts(float DeltaTime);
+
+	/** 结束压力测试并输出统计 */
+	void FinishStressTest();
+
+	/** 结束回放并输出统计 */
+	void FinishImpactReplay();
+
+	/**
+	 * 在破洞处开始撕裂
+	 * 只在被击中的布料资产上扩展，该布料的材质不可断裂、边图尚未构建完成或撕裂总数达到上限时不开始
+	 * @param Component 组件
+	 * @param Location 世界空间破洞位置
+	 * @param Radius 破洞半径
+	 * @param MaterialID 材质ID
+	 */
+	void StartTear(UClothBreakableComponent* Component, const FVector& Location, float Radius, int32 MaterialID);
+
+	/**
+	 * 分批并行推进撕裂，每批之后在游戏线程把新断开的边合并到各撕裂的破洞记录
+	 * 超过截止时间后剩余的组件留到下一帧，下一帧从未处理的组件开始
+	 * @param DeadlineSeconds 截止时间，每帧至少推进一批
+	 */
+	void AdvanceTears(double DeadlineSeconds);
+
+	/** 把本帧所有组件新增的损伤应用到布料模拟，每个组件一次 */
+	void FlushDamageLoosening();
+
+	/**
+	 * 获取组件在被击中的布料资产上的撕裂状态，首次调用时创建
+	 * @param State 组件的运行时状态
+	 * @param MaterialID 被击中的材质ID，小于0时使用第一个可断裂的布料资产
+	 * @return 撕裂状态，没有可断裂的布料资产或边图尚未构建完成时返回空
+	 */
+	FClothTearState* GetOrCreateTearState(FClothBreakableRuntimeState& State, int32 MaterialID);
+
+	/**
+	 * 在后台构建布料资产某个LOD的边图，已构建或正在构建时直接返回
+	 * 物理网格在游戏线程拷贝，工作线程不访问UObject
+	 * @param ClothingAsset 布料资产
+	 * @param ClothLOD 布料LOD
+	 */
+	void RequestTearGraph(const UClothingAssetCommon* ClothingAsset, int32 ClothLOD);
+
+	/** 在组件本帧的模拟位置中查找布料资产，需要时读取，只能在游戏线程调用，结果只在当帧有效 */
+	static const FClothSimSnapshotSection* FindClothSimData(UClothBreakableComponent* Component, int32 ClothingAssetIndex);
+
+	/** 重试尚未完成初始化的组件 */
+	void InitializePendingComponents();
+
+	/** 在游戏线程更新本帧有冲击的组件的LOD、表面查找表和变换，并读取这些组件的布料模拟位置 */
+	void PrepareStatesForResolve(TConstArrayView<FClothBreakImpact> Impacts);
+
+	/** 并行解析排队的冲击 */
+	void ResolveImpacts(TConstArrayView<FClothBreakImpact> Impacts, TArrayView<FClothBreakResult> OutResults,
+		TArrayView<FClothFragmentSpawnParams> OutFragments) const;
+
+	/** 将解析结果拆分为工作项 */
+	void EnqueueResults(TConstArrayView<FClothBreakImpact> Impacts, TConstArrayView<FClothBreakResult> Results,
+		TConstArrayView<FClothFragmentSpawnParams> Fragments);
+
+	/**
+	 * 在预算内按优先级处理工作项
+	 * @param DeadlineSeconds 截止时间（FPlatformTime::Seconds）
+	 */
+	void ProcessWorkItems(double DeadlineSeconds);
+
+	/**
+	 * 执行工作项的一个步骤
+	 * @return 工作项是否已完成
+	 */
+	bool ExecuteWorkStep(EClothBreakWorkType Type, FClothBreakWorkItem& Item);
+
+	/** 移除队列头部已完成的工作项和不再引用的碎片参数，持续超出预算时队列不会无限增长 */
+	void CompactWorkQueues();
+
+	/** 派发本帧的批量断裂通知 */
+	void FlushBreakRecords();
+
+	/**
+	 * 检查内存是否超出ClothBreak.MemoryBudgetMB，超出时输出一次警告
+	 * 每次只重新统计MemoryCheckComponentsPerPass个组件，其余组件沿用上次的统计
+	 */
+	void CheckMemoryBudget();
+
+	/**
+	 * 统计共享的表面查找表和撕裂边图
+	 * @param Ar 输出明细的设备，可为空
+	 * @return 字节数
+	 */
+	int64 GetSharedMemoryBytes(FOutputDevice* Ar) const;
+
+	/**
+	 * 统计一个组件的内存，并更新状态中缓存的统计
+	 * @param State 组件的运行时状态
+	 * @param OutStats 输出的明细
+	 */
+	static void MeasureComponentMemory(FClothBreakableRuntimeState& State, FClothBreakableMemoryStats& OutStats);
+
+	/** 统计子系统自身的队列和帧内分配器 */
+	int64 GetSubsystemMemoryBytes() const;
+
+	/** 组件初始化完成后的处理 */
+	void HandleComponentInitialized(UClothBreakableComponent* Component);
+
+	/**
+	 * 将已加载的骨骼网格体加入预热，每个网格体只预热一次
+	 * @param Mesh 骨骼网格体
+	 * @param Settings 运行时设置，决定碎片尺寸范围
+	 */
+	void PrewarmMesh(USkeletalMesh* Mesh, const FClothBreakableRuntimeSettings& Settings);
+
+	/** 执行预热步骤直到超出截止时间，每帧至少执行一步 */
+	void ProcessPrewarmSteps(double DeadlineSeconds);
+
+private:
+	/** 所有组件的运行时状态，与组件的RuntimeStateIndex一一对应 */
+	TArray<FClothBreakableRuntimeState> States;
+
+	/** 本帧排队的冲击 */
+	TArray<FClothBreakImpact> PendingImpacts;
+
+	/** 尚未完成初始化的组件 */
+	TArray<TWeakObjectPtr<UClothBreakableComponent>> UninitializedComponents;
+
+	/** 子弹穿透扫描已处理的布料层，子弹销毁或记录失效后在Tick中清理 */
+	TMap<TWeakObjectPtr<const AActor>, FClothBreakPenetrationRecord> PenetratedLayers;
+
+	/** 各类型的工作项队列 */
+	TArray<FClothBreakWorkItem> WorkQueues[(int32)EClothBreakWorkType::Count];
+
+	/** 各队列中下一个待处理工作项的位置 */
+	int32 WorkQueueHeads[(int32)EClothBreakWorkType::Count] = {};
+
+	/** 本帧的断裂记录，Tick结束时批量派发 */
+	TArray<FClothBreakRecord> BreakRecords;
+
+	/** 批量断裂通知 */
+	FOnClothBreaksBatched BreaksBatchedDelegate;
+
+	/** 尚未生成的碎片，位置和旋转在组件空间，生成时按组件当前的变换转换到世界空间 */
+	TArray<FClothFragmentSpawnParams> FragmentPool;
+
+	/** 关卡流送移除的组件的断裂状态，按组件路径索引，数量超出上限时丢弃最早暂存的状态 */
+	TMap<FString, FClothBreakStashedState> StashedBreakStates;
+
+	/** 正在录制的冲击，未录制时为空 */
+	TUniquePtr<FClothBreakImpactRecording> Recording;
+
+	/** 录制中组件到组件表索引的映射 */
+	TMap<TObjectKey<UClothBreakableComponent>, uint16> RecordingComponentIndices;
+
+	/** 录制开始的帧序号 */
+	uint64 RecordingStartFrame = 0;
+
+	/** 录制开始的时间 */
+	double RecordingStartTime = 0.0;
+
+	/** 正在回放的录制，未回放时为空 */
+	TUniquePtr<FClothBreakImpactRecording> Replay;
+
+	/** 回放中组件表对应的组件 */
+	TArray<TWeakObjectPtr<UClothBreakableComponent>> ReplayComponents;
+
+	/** 下一个待回放的冲击 */
+	int32 ReplayCursor = 0;
+
+	/** 回放开始的时间 */
+	double ReplayStartTime = 0.0;
+
+	/** 是否以最大速度回放 */
+	bool bReplayMaxSpeed = false;
+
+	/** 回放统计 */
+	FClothBreakReplayStats ReplayStats;
+
+	/** 各布料资产各LOD共享的边图，预热或第一次用到时在后台构建，构建中或构建失败时为空 */
+	TMap<TPair<TObjectKey<UClothingAssetBase>, int32>, TSharedPtr<const FClothTearGraph>> TearGraphs;
+
+	/** 有正在扩展的撕裂的组件 */
+	TSet<TWeakObjectPtr<UClothBreakableComponent>> TearingComponents;
+
+	/** 所有组件正在扩展的撕裂总数 */
+	int32 NumActiveTears = 0;
+
+	/** 下一帧推进撕裂的起始组件，预算不足时轮流推进 */
+	int32 TearCursor = 0;
+
+	/** 本帧有新损伤的组件 */
+	TSet<TWeakObjectPtr<UClothBreakableComponent>> LooseningComponents;
+
+	/** 显式设置的每帧时间预算（毫秒），0表示不限制，小于0表示未设置，使用画质档位的预算 */
+	float FrameBudgetMs = -1.0f;
+
+	/** 设置资产修改委托句柄 */
+	FDelegateHandle SettingsChangedHandle;
+
+	/** 压力测试的冲击速率，0表示未在压力测试 */
+	float StressImpactsPerSecond = 0.0f;
+
+	/** 压力测试剩余的时间 */
+	float StressRemainingSeconds = 0.0f;
+
+	/** 尚未发出的冲击数量的小数部分 */
+	float StressImpactAccumulator = 0.0f;
+
+	/** 下一个接收冲击的组件 */
+	int32 StressCursor = 0;
+
+	/** 压力测试开始的时间 (FPlatformTime::Seconds) */
+	double StressStartSeconds = 0.0;
+
+	/** 压力测试统计 */
+	FClothBreakStressStats StressStats;
+
+	/** 距上次检查内存预算的时间 */
+	float MemoryCheckElapsed = 0.0f;
+
+	/** 上次检查时是否超出内存预算，用于只在越过预算时警告一次 */
+	bool bOverMemoryBudget = false;
+
+	/** 所有组件缓存的内存统计之和 */
+	int64 TrackedComponentBytes = 0;
+
+	/** 下一次预算检查开始统计的组件 */
+	int32 MemoryCheckCursor = 0;
+
+	/** 待执行的预热步骤 */
+	TArray<FClothBreakPrewarmStep> PrewarmSteps;
+
+	/** 下一个待执行的预热步骤 */
+	int32 PrewarmStepHead = 0;
+
+	/** 已预热的骨骼网格体 */
+	TSet<TObjectKey<USkeletalMesh>> PrewarmedMeshes;
+
+	/** 已请求加载的软引用，避免重复请求 */
+	TSet<FSoftObjectPath> RequestedPrewarmPaths;
+
+	/** 预热加载的句柄，持有加载的网格体直到世界结束 */
+	TArray<TSharedPtr<FStreamableHandle>> PrewarmLoadHandles;
+
+	/** 预热加载的表面查找表，持有引用使之后的组件直接命中 */
+	TArray<TSharedPtr<const FClothSurfaceUVTable>> PrewarmedTables;
+
+	/** 尚未完成的后台加载数量 */
+	int32 NumPendingPrewarmLoads = 0;
+
+	/** 是否已安排模拟物理的碎片生成预热 */
+	bool bPhysicsSpawnPrewarmQueued = false;
+
+	/** 是否已安排不模拟物理的碎片生成预热 */
+	bool bStaticSpawnPrewarmQueued = false;
+
+	/** 用于预热碎片生成的生成器 */
+	UPROPERTY()
+	TObjectPtr<UClothFragmentGenerator> PrewarmGenerator;
+};
@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FClothSimSnapshot;
+class USkeletalMeshComponent;
+
+/**
+ * 一个布料资产的损伤
+ */
+struct FClothDamageLooseningSection
+{
+	/** 骨骼网格体上的布料资产索引 */
+	int32 ClothingAssetIndex = INDEX_NONE;
+
+	/** 记录损伤时该布料资产的模拟粒子数量 */
+	int32 NumParticles = 0;
+
+	/** 落在破洞和撕裂上的粒子数量，重叠的破洞会重复计入，不超过NumParticles */
+	int32 NumDamagedParticles = 0;
+
+	/** 损伤变化后尚未应用到布料模拟 */
+	bool bDirty = false;
+
+	/** 损伤粒子的比例 */
+	float GetDamagedFraction() const
+	{
+		return NumParticles > 0 ? (float)NumDamagedParticles / NumParticles : 0.0f;
+	}
+};
+
+/**
+ * 单个组件受损后的布料松弛
+ * 布料模拟交互器只能整体调整一个布料资产的约束，不能让破洞附近的粒子单独松开。
+ * 这里按破洞和撕裂覆盖的粒子比例整体放松该布料资产的动画驱动和拴系刚度：
+ * 披风上的一个破洞会让整件披风变松，破损处不会单独下垂，也不修改网格拓扑
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothDamageLooseningState
+{
+	/** 各布料资产的损伤 */
+	TArray<FClothDamageLooseningSection, TInlineAllocator<2>> Sections;
+
+	/** 是否有尚未应用的损伤 */
+	bool HasPendingUpdate() const
+	{
+		return Sections.ContainsByPredicate([](const FClothDamageLooseningSection& Section) { return Section.bDirty; });
+	}
+
+	/** 损伤状态占用的内存 */
+	SIZE_T GetAllocatedSize() const { return Sections.GetAllocatedSize(); }
+
+	/**
+	 * 把破洞半径内的模拟粒子计入损伤
+	 * 通过快照的空间哈希只检查破洞附近的粒子，布料切换模拟LOD后粒子数量变化，该布料资产的损伤重新开始
+	 * @param Snapshot 模拟快照
+	 * @param ComponentLocation 组件空间的破洞中心
+	 * @param Radius 破洞半径
+	 * @return 新计入的粒子数量
+	 */
+	int32 AddHoleDamage(const FClothSimSnapshot& Snapshot, const FVector3f& ComponentLocation, float Radius);
+
+	/**
+	 * 把撕裂新断开的粒子计入损伤
+	 * @param ClothingAssetIndex 布料资产索引
+	 * @param NumParticles 该布料资产当前的模拟粒子数量
+	 * @param NumTornParticles 新断开的粒子数量
+	 * @return 新计入的粒子数量
+	 */
+	int32 AddTearDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumTornParticles);
+
+	/**
+	 * 把损伤比例应用到布料模拟，每个布料资产一次交互器调用
+	 * 动画驱动和拴系刚度按 1 - 损伤比例 * Looseness 缩放，拴系刚度不低于配置的一半，基准值来自布料资产的配置
+	 * @param SkeletalMeshComponent 骨骼网格体组件
+	 * @param Looseness 松弛倍率，0到1
+	 * @return 是否应用到了布料模拟
+	 */
+	bool ApplyPendingUpdate(USkeletalMeshComponent& SkeletalMeshComponent, float Looseness);
+
+	/**
+	 * 写入损伤，用于保存断裂状态
+	 * 每个布料资产写入资产索引、粒子数量和损伤粒子数量
+	 * @param Ar 写入的存档
+	 */
+	void Save(FArchive& Ar) const;
+
+	/**
+	 * 读取Save写入的损伤，有损伤的布料资产标记为待应用
+	 * @param Ar 读取的存档
+	 * @return 数据完整返回true，失败时状态为空
+	 */
+	bool Load(FArchive& Ar);
+
+	/**
+	 * 清除损伤，并把布料约束恢复为资产配置
+	 * @param SkeletalMeshComponent 骨骼网格体组件，为空时只清除数据
+	 */
+	void Reset(USkeletalMeshComponent* SkeletalMeshComponent);
+
+private:
+	/**
+	 * 增加一个布料资产的损伤粒子数量
+	 * @return 实际增加的数量，达到粒子总数后不再增加
+	 */
+	int32 AddDamage(int32 ClothingAssetIndex, int32 NumParticles, int32 NumDamagedParticles);
+};
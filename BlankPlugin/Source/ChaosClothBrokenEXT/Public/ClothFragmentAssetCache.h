@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "ClothFragmentAssetCache.generated.h"
+
+class UStaticMesh;
+
+/**
+ * 碎片自定义图元数据槽位
+ * 碎片直接使用源材质，单个碎片的差异（色调、淡出、灼烧）通过自定义图元数据传入材质
+ */
+namespace ClothFragmentPrimitiveData
+{
+	/** 色调（占用3个槽位：R、G、B） */
+	constexpr int32 Tint = 0;
+	/** 淡出系数，1为完全可见 */
+	constexpr int32 Fade = 3;
+	/** 灼烧程度，0为未灼烧 */
+	constexpr int32 Burn = 4;
+}
+
+/**
+ * 碎片形状类别
+ * 与量化后的尺寸一起决定共享的碎片网格
+ */
+UENUM(BlueprintType)
+enum class EClothFragmentShape : uint8
+{
+	/** 近似方形的薄布片 */
+	Patch,
+	/** 细长的布条 */
+	Strip,
+
+	Count UMETA(Hidden)
+};
+
+/**
+ * 碎片共享资源缓存
+ * 按形状类别和量化尺寸缓存碎片网格（含渲染数据和简单凸包碰撞），
+ * 所有碎片引用缓存中的网格，内存和构建开销只与不同形状的数量相关，与碎片数量无关
+ */
+UCLASS()
+class CHAOSCLOTHBROKENEXT_API UClothFragmentAssetCache : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取全局缓存实例 */
+	static UClothFragmentAssetCache* Get();
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * 获取指定形状和尺寸的共享碎片网格
+	 * @param Shape 形状类别
+	 * @param Size 期望的碎片尺寸
+	 * @param OutQuantizedSize 输出的量化后尺寸（网格的实际尺寸）
+	 * @return 共享的碎片网格，失败时返回nullptr
+	 */
+	UStaticMesh* GetFragmentMesh(EClothFragmentShape Shape, float Size, float& OutQuantizedSize);
+
+	/** 将尺寸量化为尺寸档位 */
+	static int32 QuantizeSize(float Size);
+
+	/** 获取尺寸档位对应的尺寸 */
+	static float GetBucketSize(int32 SizeBucket);
+
+	/** 当前缓存的网格数量 */
+	UFUNCTION(BlueprintPure, Category = "Cloth Breaking|Debug")
+	int32 GetNumCachedMeshes() const { return FragmentMeshes.Num(); }
+
+	/** 缓存的网格占用的内存 */
+	int64 GetMemorySize() const;
+
+protected:
+	/** 构建一个碎片网格 */
+	UStaticMesh* BuildFragmentMesh(EClothFragmentShape Shape, float Size);
+
+private:
+	/** 生成缓存键 */
+	static uint32 MakeShapeKey(EClothFragmentShape Shape, int32 SizeBucket)
+	{
+		return (static_cast<uint32>(Shape) << 16) | static_cast<uint32>(SizeBucket);
+	}
+
+	// 最小尺寸档位对应的尺寸
+	static constexpr float MinBucketSize = 0.5f;
+
+	// 相邻尺寸档位之间的比例
+	static constexpr float BucketRatio = 1.25f;
+
+	// 尺寸档位数量上限
+	static constexpr int32 MaxSizeBuckets = 32;
+
+	/** 已缓存的碎片网格 */
+	UPROPERTY()
+	TMap<uint32, TObjectPtr<UStaticMesh>> FragmentMeshes;
+};
@@ -6,6 +6,8 @@
 #include "UObject/NoExportTypes.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/StaticMeshActor.h"
+#include "ClothFragmentAssetCache.h"
+#include "ClothFragmentStrategies.h"
 #include "ClothFragmentGenerator.generated.h"
 
 /**
@@ -29,29 +31,119 @@ public:
 	 * @param FragmentCount 生成的碎片数量
 	 * @param MinSize 最小碎片尺寸
 	 * @param MaxSize 最大碎片尺寸
+	 * @param Strategy 碎片生成策略
+	 * @param bSimulatePhysics 碎片是否模拟物理
+	 * @param ImpactNormal 世界空间的布料表面法线，碎片在与其垂直的平面内展开，为零时由包围盒中心指向碰撞位置估计
+	 * @param FragmentMass 碎片物理质量 (千克)
+	 * @param FragmentLifetime 碎片存在的时间 (秒)
 	 * @return 是否成功生成碎片
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
 	bool GenerateFragmentsFromCloth(USkeletalMeshComponent* SkeletalMeshComponent,
 		const FVector& ImpactLocation, float ImpactRadius, int32 MaterialID,
-		int32 FragmentCount, float MinSize, float MaxSize);
+		int32 FragmentCount, float MinSize, float MaxSize,
+		EClothFragmentStrategy Strategy = EClothFragmentStrategy::SphereDebris, bool bSimulatePhysics = true,
+		FVector ImpactNormal = FVector::ZeroVector, float FragmentMass = 1.0f, float FragmentLifetime = 5.0f);
+
+	/** 单次断裂生成的碎片数量的硬上限，决定规划缓冲区的大小，画质档位可进一步降低 */
+	static constexpr int32 MaxFragmentsPerBreak = 20;
+
+	/** 没有断裂设置时碎片的物理质量 (千克)，与UClothBreakableSettings的默认值一致 */
+	static constexpr float DefaultFragmentMass = 1.0f;
+
+	/** 没有断裂设置时碎片存在的时间 (秒)，与UClothBreakableSettings的默认值一致 */
+	static constexpr float DefaultFragmentLifetime = 5.0f;
+
+	/**
+	 * 规划碎片的位置、大小和形状
+	 * 只读取参数和随机流，可在工作线程调用
+	 * @param Strategy 碎片生成策略
+	 * @param RandomStream 随机流
+	 * @param ImpactLocation 碰撞位置
+	 * @param ImpactNormal 世界空间的单位表面法线
+	 * @param ImpactRadius 影响半径
+	 * @param FragmentCount 期望的碎片数量
+	 * @param MinSize 最小碎片尺寸
+	 * @param MaxSize 最大碎片尺寸
+	 * @param OutSpawnParams 输出的碎片参数槽位
+	 * @return 实际规划的碎片数量
+	 */
+	static int32 PlanFragments(EClothFragmentStrategy Strategy, FRandomStream& RandomStream, const FVector& ImpactLocation,
+		const FVector& ImpactNormal, float ImpactRadius, int32 FragmentCount, float MinSize, float MaxSize,
+		TArrayView<FClothFragmentSpawnParams> OutSpawnParams);
+
+	/**
+	 * 得到用于规划碎片的表面法线
+	 * @param Normal 已知的表面法线，可以为零向量
+	 * @param ImpactLocation 世界空间碰撞位置
+	 * @param BoundsOrigin 布料所在组件的世界包围盒中心
+	 * @return 单位法线，Normal为零时取包围盒中心指向碰撞位置的方向，两者重合时为世界向上
+	 */
+	static FVector ResolveImpactNormal(const FVector& Normal, const FVector& ImpactLocation, const FVector& BoundsOrigin);
+
+	/**
+	 * 获取碎片使用的材质
+	 * @param SkeletalMeshComponent 目标骨骼网格体组件
+	 * @param MaterialID 材质ID，无效时使用第一个材质
+	 * @return 材质
+	 */
+	static UMaterialInterface* ResolveFragmentMaterial(USkeletalMeshComponent* SkeletalMeshComponent, int32 MaterialID);
+
+	/**
+	 * 按规划结果生成碎片
+	 * @param SpawnParams 碎片参数
+	 * @param Material 材质
+	 * @param bSimulatePhysics 碎片是否模拟物理，关闭时碎片不参与碰撞
+	 * @param bHidden 碎片是否隐藏，用于预热
+	 * @param FragmentMass 碎片物理质量 (千克)，只在模拟物理时使用
+	 * @param FragmentLifetime 碎片存在的时间 (秒)
+	 * @return 成功生成的碎片数量
+	 */
+	int32 SpawnFragments(TConstArrayView<FClothFragmentSpawnParams> SpawnParams, UMaterialInterface* Material, bool bSimulatePhysics = true,
+		bool bHidden = false, float FragmentMass = DefaultFragmentMass, float FragmentLifetime = DefaultFragmentLifetime);
+
+	/** 立即销毁所有存活的碎片 */
+	void DestroyAllFragments();
+
+	/** 存活的碎片数量 */
+	int32 GetNumLiveFragments() const;
+
+	/** 存活碎片的Actor和组件占用的内存 */
+	int64 GetFragmentMemorySize() const;
 
 protected:
 	/**
 	 * 创建简单的碎片Actor
-	 * @param WorldLocation 世界位置
-	 * @param Size 碎片大小
+	 * @param SpawnParams 碎片参数
 	 * @param Material 材质
+	 * @param bSimulatePhysics 碎片是否模拟物理
+	 * @param bHidden 碎片是否隐藏
+	 * @param FragmentMass 碎片物理质量 (千克)
+	 * @param FragmentLifetime 碎片存在的时间 (秒)
 	 * @return 创建的Actor
 	 */
-	AActor* CreateSimpleFragment(const FVector& WorldLocation, float Size, UMaterialInterface* Material);
+	AActor* CreateSimpleFragment(const FClothFragmentSpawnParams& SpawnParams, UMaterialInterface* Material, bool bSimulatePhysics, bool bHidden,
+		float FragmentMass, float FragmentLifetime);
+
+	/**
+	 * 设置碎片的外观差异
+	 * 通过自定义图元数据写入，材质中按ClothFragmentPrimitiveData的槽位读取
+	 * @param FragmentComponent 碎片组件
+	 * @param Tint 色调
+	 * @param Fade 淡出系数
+	 * @param Burn 灼烧程度
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cloth Breaking")
+	static void ApplyFragmentVariation(UPrimitiveComponent* FragmentComponent,
+		const FLinearColor& Tint, float Fade, float Burn);
 
 	/**
 	 * 为碎片设置物理属性
 	 * @param FragmentComponent 碎片组件
+	 * @param FragmentMass 碎片物理质量 (千克)
 	 * @return 是否成功设置
 	 */
-	bool SetupFragmentPhysics(UPrimitiveComponent* FragmentComponent);
+	bool SetupFragmentPhysics(UPrimitiveComponent* FragmentComponent, float FragmentMass);
 
 	/**
 	 * 清理旧的碎片
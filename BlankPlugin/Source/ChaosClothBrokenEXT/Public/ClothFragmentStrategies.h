@@ -0,0 +1,262 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClothFragmentAssetCache.h"
+#include "ClothFragmentStrategies.generated.h"
+
+/**
+ * 碎片生成策略
+ */
+UENUM(BlueprintType)
+enum class EClothFragmentStrategy : uint8
+{
+	/** 在冲击球内随机散布的碎片 */
+	SphereDebris,
+	/** 运行时按黄金角螺旋排列的单元，碎片分布均匀，不使用预切割数据；保留原枚举名以兼容已保存的资产 */
+	BakedCells UMETA(DisplayName = "Spiral Cells"),
+	/** 冲击点附近的局部Voronoi单元，碎片大小随单元间距变化 */
+	LocalVoronoi,
+	/** 沿撕裂方向排列的条状碎片 */
+	StripTear,
+
+	Count UMETA(Hidden)
+};
+
+/**
+ * 单个碎片的生成参数
+ */
+struct FClothFragmentSpawnParams
+{
+	/** 世界位置，在子系统的碎片池中排队时为组件空间 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 世界旋转，在子系统的碎片池中排队时为组件空间 */
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** 碎片大小 */
+	float Size = 0.0f;
+
+	/** 明暗系数 */
+	float Brightness = 1.0f;
+
+	/** 碎片形状类别 */
+	EClothFragmentShape Shape = EClothFragmentShape::Patch;
+};
+
+/**
+ * 一次断裂的碎片规划输入
+ */
+struct FClothFragmentPlanContext
+{
+	/** 碰撞位置 */
+	FVector ImpactLocation = FVector::ZeroVector;
+
+	/** 布料表面法线，碎片在与其垂直的平面内展开 */
+	FVector ImpactNormal = FVector::UpVector;
+
+	/** 影响半径 */
+	float ImpactRadius = 0.0f;
+
+	/** 最小碎片尺寸 */
+	float MinSize = 1.0f;
+
+	/** 最大碎片尺寸 */
+	float MaxSize = 1.0f;
+};
+
+/**
+ * 碎片生成策略的实现
+ * 每个策略是一个普通类型：构造时完成整次断裂的预计算，Plan逐个输出碎片。
+ * PlanFragmentsWithStrategy按类型实例化，逐碎片的循环中没有虚函数调用，也不再判断策略类型
+ */
+namespace ClothFragmentStrategies
+{
+	/** 碎片平面的切线基 */
+	struct FPlaneBasis
+	{
+		FVector TangentX;
+		FVector TangentY;
+
+		explicit FPlaneBasis(const FVector& Normal)
+		{
+			Normal.FindBestAxisVectors(TangentX, TangentY);
+		}
+
+		FVector ToWorld(const FVector2D& Point) const
+		{
+			return TangentX * Point.X + TangentY * Point.Y;
+		}
+	};
+
+	/** 在冲击球内随机散布 */
+	struct FSphereDebris
+	{
+		FSphereDebris(FRandomStream& InRandomStream, const FClothFragmentPlanContext& InContext, int32 FragmentCount)
+			: RandomStream(InRandomStream)
+			, Context(InContext)
+		{
+		}
+
+		FORCEINLINE void Plan(int32 Index, FClothFragmentSpawnParams& OutParams)
+		{
+			// 随机大小和形状
+			OutParams.Size = RandomStream.FRandRange(Context.MinSize, Context.MaxSize);
+			OutParams.Shape = RandomStream.FRand() < 0.7f ? EClothFragmentShape::Patch : EClothFragmentShape::Strip;
+
+			// 随机位置 (在碰撞半径内) 和朝向
+			OutParams.Location = Context.ImpactLocation + RandomStream.VRand() * RandomStream.FRandRange(0.0f, Context.ImpactRadius * 0.8f);
+			OutParams.Rotation = FRotator(RandomStream.FRandRange(-180.0f, 180.0f), RandomStream.FRandRange(-180.0f, 180.0f), 0.0f);
+
+			// 轻微的明暗变化，避免碎片看起来完全一致
+			OutParams.Brightness = RandomStream.FRandRange(0.85f, 1.0f);
+		}
+
+		FRandomStream& RandomStream;
+		const FClothFragmentPlanContext& Context;
+	};
+
+	/** 运行时按黄金角螺旋生成的单元布局，只加少量抖动 */
+	struct FSpiralCells
+	{
+		FSpiralCells(FRandomStream& InRandomStream, const FClothFragmentPlanContext& InContext, int32 FragmentCount)
+			: RandomStream(InRandomStream)
+			, Context(InContext)
+			, Basis(InContext.ImpactNormal)
+			, Rotation(FRotationMatrix::MakeFromZ(InContext.ImpactNormal).Rotator())
+			, InvCount(1.0f / FMath::Max(FragmentCount, 1))
+			, CellSize(FMath::Clamp(InContext.ImpactRadius * FMath::InvSqrt((float)FMath::Max(FragmentCount, 1)), InContext.MinSize, InContext.MaxSize))
+		{
+		}
+
+		FORCEINLINE void Plan(int32 Index, FClothFragmentSpawnParams& OutParams)
+		{
+			static constexpr float GoldenAngle = 2.39996323f;
+
+			// 面积均匀的螺旋分布
+			const float Radius = Context.ImpactRadius * 0.8f * FMath::Sqrt((Index + 0.5f) * InvCount);
+			float Sin, Cos;
+			FMath::SinCos(&Sin, &Cos, Index * GoldenAngle);
+			const FVector2D Jitter(RandomStream.FRandRange(-0.1f, 0.1f), RandomStream.FRandRange(-0.1f, 0.1f));
+
+			OutParams.Location = Context.ImpactLocation + Basis.ToWorld(FVector2D(Cos, Sin) * Radius + Jitter * CellSize);
+			OutParams.Rotation = Rotation;
+			OutParams.Size = CellSize;
+			OutParams.Shape = EClothFragmentShape::Patch;
+			OutParams.Brightness = RandomStream.FRandRange(0.9f, 1.0f);
+		}
+
+		FRandomStream& RandomStream;
+		const FClothFragmentPlanContext& Context;
+		const FPlaneBasis Basis;
+		const FRotator Rotation;
+		const float InvCount;
+		const float CellSize;
+	};
+
+	/** 冲击点附近的局部Voronoi单元，碎片位于单元种子处，大小取最近邻距离 */
+	struct FLocalVoronoi
+	{
+		FLocalVoronoi(FRandomStream& InRandomStream, const FClothFragmentPlanContext& InContext, int32 FragmentCount)
+			: RandomStream(InRandomStream)
+			, Context(InContext)
+			, Basis(InContext.ImpactNormal)
+			, BaseRotation(FRotationMatrix::MakeFromZ(InContext.ImpactNormal).Rotator())
+		{
+			// 种子越靠近冲击点越密，碎片越碎
+			Seeds.SetNumUninitialized(FragmentCount);
+			for (FVector2D& Seed : Seeds)
+			{
+				const float Radius = Context.ImpactRadius * 0.8f * FMath::Square(RandomStream.FRand());
+				const float Angle = RandomStream.FRandRange(0.0f, UE_TWO_PI);
+				Seed = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Radius;
+			}
+		}
+
+		FORCEINLINE void Plan(int32 Index, FClothFragmentSpawnParams& OutParams)
+		{
+			const FVector2D& Seed = Seeds[Index];
+			float NearestDistanceSquared = FMath::Square(Context.MaxSize * 2.0f);
+			for (int32 Other = 0; Other < Seeds.Num(); ++Other)
+			{
+				const float DistanceSquared = Other != Index ? FVector2D::DistSquared(Seed, Seeds[Other]) : UE_BIG_NUMBER;
+				NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+			}
+
+			OutParams.Location = Context.ImpactLocation + Basis.ToWorld(Seed);
+			OutParams.Rotation = BaseRotation + FRotator(0.0f, 0.0f, RandomStream.FRandRange(-180.0f, 180.0f));
+			OutParams.Size = FMath::Clamp(FMath::Sqrt(NearestDistanceSquared), Context.MinSize, Context.MaxSize);
+			OutParams.Shape = EClothFragmentShape::Patch;
+			OutParams.Brightness = RandomStream.FRandRange(0.85f, 1.0f);
+		}
+
+		FRandomStream& RandomStream;
+		const FClothFragmentPlanContext& Context;
+		const FPlaneBasis Basis;
+		const FRotator BaseRotation;
+		TArray<FVector2D, TInlineAllocator<32>> Seeds;
+	};
+
+	/** 沿一条随机撕裂方向排列的条状碎片 */
+	struct FStripTear
+	{
+		FStripTear(FRandomStream& InRandomStream, const FClothFragmentPlanContext& InContext, int32 FragmentCount)
+			: RandomStream(InRandomStream)
+			, Context(InContext)
+		{
+			const FPlaneBasis Basis(InContext.ImpactNormal);
+			const float Angle = RandomStream.FRandRange(0.0f, UE_PI);
+			Direction = Basis.ToWorld(FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)));
+			Rotation = FRotationMatrix::MakeFromXZ(Direction, InContext.ImpactNormal).Rotator();
+			Spacing = InContext.ImpactRadius * 1.6f / FMath::Max(FragmentCount, 1);
+			FirstOffset = -0.5f * Spacing * (FragmentCount - 1);
+		}
+
+		FORCEINLINE void Plan(int32 Index, FClothFragmentSpawnParams& OutParams)
+		{
+			OutParams.Location = Context.ImpactLocation + Direction * (FirstOffset + Index * Spacing + RandomStream.FRandRange(-0.2f, 0.2f) * Spacing);
+			OutParams.Rotation = Rotation;
+			OutParams.Size = RandomStream.FRandRange(Context.MinSize, Context.MaxSize);
+			OutParams.Shape = EClothFragmentShape::Strip;
+			OutParams.Brightness = RandomStream.FRandRange(0.85f, 1.0f);
+		}
+
+		FRandomStream& RandomStream;
+		const FClothFragmentPlanContext& Context;
+		FVector Direction;
+		FRotator Rotation;
+		float Spacing;
+		float FirstOffset;
+	};
+
+	/**
+	 * 用指定策略规划碎片
+	 * @param RandomStream 随机流
+	 * @param Context 规划输入
+	 * @param FragmentCount 碎片数量，不超过输出槽位数量
+	 * @param OutSpawnParams 输出的碎片参数槽位
+	 */
+	template<typename TStrategy>
+	void PlanFragmentsWithStrategy(FRandomStream& RandomStream, const FClothFragmentPlanContext& Context, int32 FragmentCount,
+		TArrayView<FClothFragmentSpawnParams> OutSpawnParams)
+	{
+		TStrategy Strategy(RandomStream, Context, FragmentCount);
+		for (int32 Index = 0; Index < FragmentCount; ++Index)
+		{
+			Strategy.Plan(Index, OutSpawnParams[Index]);
+		}
+	}
+
+	/**
+	 * 按策略类型分派，每次断裂只判断一次策略
+	 */
+	CHAOSCLOTHBROKENEXT_API void PlanFragments(EClothFragmentStrategy Strategy, FRandomStream& RandomStream,
+		const FClothFragmentPlanContext& Context, int32 FragmentCount, TArrayView<FClothFragmentSpawnParams> OutSpawnParams);
+
+	/**
+	 * 在同一组输入上分别计时所有策略并输出结果
+	 * @param Iterations 每个策略的规划次数
+	 */
+	CHAOSCLOTHBROKENEXT_API void RunBenchmark(int32 Iterations);
+}
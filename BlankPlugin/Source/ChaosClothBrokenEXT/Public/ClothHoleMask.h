@@ -0,0 +1,221 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMesh;
+class USkeletalMeshComponent;
+class FSkeletalMeshRenderData;
+struct FClothBindPoseMapping;
+
+/**
+ * 骨骼网格体单个LOD的表面查找表
+ * 按空间网格索引参考姿势下的顶点，用于判断命中的材质区域，以及把破洞中心换算到材质UV空间。
+ * 动画姿势下的位置先通过骨骼和蒙皮权重映射回参考姿势（ToBindPose），索引本身不随动画重建。
+ * 同一网格体同一LOD的表由所有组件共享，最后一个引用释放后随之释放。
+ * 依次从网格体上烘焙的数据（UClothBreakRegionUserData）、编辑器的派生数据缓存加载，
+ * 都没有时才从渲染数据构建，此时需要保留CPU端数据（骨骼网格体的Allow CPU Access）
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothSurfaceUVTable
+{
+	/** 数据格式版本，格式或构建方式变化时递增，旧的烘焙数据和缓存随之失效 */
+	static constexpr uint32 DataVersion = 2;
+
+	/** 每个顶点记录的骨骼影响数量 */
+	static constexpr int32 MaxInfluences = 4;
+
+	/** 参考姿势下组件空间的顶点位置 */
+	TArray<FVector3f> Positions;
+
+	/** 第一套UV */
+	TArray<FVector2f> UVs;
+
+	/** 顶点所属的材质索引，已按该LOD的材质映射换算为组件的材质槽位 */
+	TArray<uint8> MaterialIndices;
+
+	/** 每个材质的平均UV密度 (UV单位/厘米) */
+	TArray<float> UVPerUnit;
+
+	/** 顶点蒙皮引用的骨骼（骨骼网格体的骨骼索引） */
+	TArray<int32> UsedBones;
+
+	/** 每个顶点MaxInfluences个骨骼影响，值为UsedBones中的序号，渲染数据没有蒙皮权重时为空 */
+	TArray<uint16> InfluenceBones;
+
+	/** 与InfluenceBones对应的权重，每个顶点的权重之和为255 */
+	TArray<uint8> InfluenceWeights;
+
+	/** 空间网格的单元大小 */
+	float CellSize = 10.0f;
+
+	/** 空间网格单元在SortedVertices中的起点和数量 */
+	TMap<FIntVector, TPair<int32, int32>> Cells;
+
+	/** 按单元排列的顶点索引 */
+	TArray<int32> SortedVertices;
+
+	/**
+	 * 查找最近的表面顶点
+	 * @param Position 组件空间位置
+	 * @param MaterialID 材质ID，小于0时不限制材质
+	 * @return 顶点索引，附近没有表面顶点时返回INDEX_NONE
+	 */
+	int32 FindNearestVertex(const FVector3f& Position, int32 MaterialID) const;
+
+	/**
+	 * 把动画姿势下的组件空间位置映射回参考姿势
+	 * 先用初始骨骼的逆变换得到估计位置，再按估计位置附近顶点的蒙皮权重混合各骨骼的逆变换，只读取传入的数据，可在工作线程调用。
+	 * 初始骨骼优先使用命中的骨骼，没有或该骨骼不影响表面顶点时使用关节最近的骨骼
+	 * @param Location 动画姿势下的组件空间位置
+	 * @param Mapping 当前姿势的骨骼映射
+	 * @param HitBone 命中的骨骼（骨骼网格体的骨骼索引），未知时为INDEX_NONE
+	 * @return 参考姿势下的组件空间位置，没有蒙皮数据时原样返回
+	 */
+	FVector3f ToBindPose(const FVector3f& Location, const FClothBindPoseMapping& Mapping, int32 HitBone = INDEX_NONE) const;
+
+	/** 顶点所在材质的UV密度，用于把半径换算到UV空间 */
+	float GetUVPerUnit(int32 Vertex) const
+	{
+		return UVPerUnit.IsValidIndex(MaterialIndices[Vertex]) ? UVPerUnit[MaterialIndices[Vertex]] : 0.0f;
+	}
+
+	/** 查找表占用的内存 */
+	SIZE_T GetAllocatedSize() const
+	{
+		return sizeof(*this) + Positions.GetAllocatedSize() + UVs.GetAllocatedSize() + MaterialIndices.GetAllocatedSize()
+			+ UVPerUnit.GetAllocatedSize() + UsedBones.GetAllocatedSize() + InfluenceBones.GetAllocatedSize() + InfluenceWeights.GetAllocatedSize()
+			+ Cells.GetAllocatedSize() + SortedVertices.GetAllocatedSize();
+	}
+
+	/**
+	 * 遍历所有已加载的查找表，用于内存统计
+	 * 只能在游戏线程调用
+	 * @param Visitor 回调，参数为网格体（可能已被回收）、LOD和查找表
+	 */
+	static void ForEachLoaded(TFunctionRef<void(const USkeletalMesh*, int32, const FClothSurfaceUVTable&)> Visitor);
+
+	/**
+	 * 查找已加载的查找表，不会触发构建
+	 * 只能在游戏线程调用
+	 * @param Mesh 骨骼网格体
+	 * @param LODIndex 渲染LOD
+	 * @return 查找表，尚未加载时返回空
+	 */
+	static TSharedPtr<const FClothSurfaceUVTable> Find(const USkeletalMesh* Mesh, int32 LODIndex);
+
+	/**
+	 * 获取骨骼网格体某个LOD的查找表，同一网格体的同一LOD只加载一次
+	 * 已加载时立即回调，否则在后台加载或构建，完成后在游戏线程回调。
+	 * 网格体上的烘焙数据与当前网格体不一致时跳过，构建失败后一段时间内直接回调空，之后重新尝试
+	 * 只能在游戏线程调用
+	 * @param Mesh 骨骼网格体
+	 * @param LODIndex 渲染LOD
+	 * @param OnComplete 完成回调，LOD不存在或渲染数据不可读时传入空
+	 */
+	static void GetAsync(const USkeletalMesh* Mesh, int32 LODIndex, TFunction<void(TSharedPtr<const FClothSurfaceUVTable>)> OnComplete);
+
+	/**
+	 * 从渲染数据构建，只读取渲染数据，可在工作线程调用
+	 * @param Mesh 骨骼网格体
+	 * @param LODIndex 渲染LOD
+	 * @return 查找表，LOD不存在或渲染数据不可读时返回空
+	 */
+	static TSharedPtr<FClothSurfaceUVTable> Build(const USkeletalMesh* Mesh, int32 LODIndex);
+
+	/**
+	 * 从指定的渲染数据构建，用于为其他平台烘焙，可在工作线程调用
+	 * @param Mesh 骨骼网格体，提供LOD的材质映射
+	 * @param RenderData 渲染数据
+	 * @param LODIndex 渲染LOD
+	 * @return 查找表，LOD不存在或渲染数据不可读时返回空
+	 */
+	static TSharedPtr<FClothSurfaceUVTable> Build(const USkeletalMesh* Mesh, const FSkeletalMeshRenderData& RenderData, int32 LODIndex);
+
+	/**
+	 * 丢弃网格体已登记的查找表和失败记录，之后的请求重新加载
+	 * 已持有查找表的组件不受影响，只能在游戏线程调用
+	 * @param Mesh 骨骼网格体
+	 */
+	static void Invalidate(const USkeletalMesh* Mesh);
+
+#if WITH_EDITOR
+	/** 派生数据缓存的键，需要在游戏线程获取 */
+	static FString GetCacheKey(const USkeletalMesh* Mesh, int32 LODIndex);
+
+	/**
+	 * 通过派生数据缓存获取，缓存未命中时构建并写入缓存，可在工作线程调用
+	 * @param Mesh 骨骼网格体
+	 * @param LODIndex 渲染LOD
+	 * @param CacheKey GetCacheKey返回的键
+	 * @return 查找表，构建失败时返回空
+	 */
+	static TSharedPtr<FClothSurfaceUVTable> BuildCached(const USkeletalMesh* Mesh, int32 LODIndex, const FString& CacheKey);
+#endif
+
+	/**
+	 * 序列化为字节数组
+	 * @param OutData 输出的数据，带有格式版本
+	 */
+	void SaveToBytes(TArray<uint8>& OutData) const;
+
+	/**
+	 * 从字节数组加载
+	 * @param Data SaveToBytes保存的数据
+	 * @return 查找表，版本不匹配或数据损坏时返回空
+	 */
+	static TSharedPtr<FClothSurfaceUVTable> LoadFromBytes(const TArray<uint8>& Data);
+
+private:
+	/** 单元坐标 */
+	FIntVector GetCell(const FVector3f& Position) const;
+
+	/** 序列化除版本外的所有数据 */
+	void Serialize(FArchive& Ar);
+};
+
+/**
+ * 当前动画姿势到参考姿势的骨骼映射
+ * 与表面查找表的UsedBones一一对应，在游戏线程按当前姿势更新，只有骨骼数量级的开销
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothBindPoseMapping
+{
+	/** 当前姿势下骨骼的组件空间位置，没有命中骨骼时用于查找关节最近的骨骼 */
+	TArray<FVector3f> BonePositions;
+
+	/** 当前姿势到参考姿势的变换，即蒙皮矩阵的逆 */
+	TArray<FMatrix44f> ToBindPose;
+
+	/**
+	 * 按骨骼网格体组件的当前姿势更新
+	 * 跟随主姿势组件（LeaderPoseComponent）的组件没有自己的姿势，按骨骼映射读取主组件的姿势，与渲染时一致。
+	 * 只能在游戏线程调用，数组在多次更新之间复用
+	 * @param Table 表面查找表
+	 * @param Component 骨骼网格体组件
+	 * @return 是否可用，姿势尚未计算或用到的骨骼在主组件中不存在时返回false
+	 */
+	bool Update(const FClothSurfaceUVTable& Table, const USkeletalMeshComponent& Component);
+
+	/** 占用的内存 */
+	SIZE_T GetAllocatedSize() const { return BonePositions.GetAllocatedSize() + ToBindPose.GetAllocatedSize(); }
+
+	/** 是否与查找表匹配 */
+	bool IsValidFor(const FClothSurfaceUVTable& Table) const
+	{
+		return ToBindPose.Num() > 0 && ToBindPose.Num() == Table.UsedBones.Num();
+	}
+};
+
+/**
+ * 破洞遮罩的材质参数约定
+ * 布料材质读取 ClothHole0 ~ ClothHole{MaxHoles-1} 向量参数：(U, V, UV半径, 0)，
+ * 半径为0的槽位未使用。在材质中按UV距离计算遮罩并接入Opacity Mask即可
+ */
+namespace ClothHoleMask
+{
+	/** 每个材质槽位的破洞数量，超出后覆盖最早的破洞 */
+	constexpr int32 MaxHoles = 8;
+
+	/** 第Index个破洞的材质参数名 */
+	CHAOSCLOTHBROKENEXT_API FName GetParameterName(int32 Index);
+}
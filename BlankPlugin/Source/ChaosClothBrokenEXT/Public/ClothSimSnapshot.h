@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * 一个布料资产的模拟位置快照
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothSimSnapshotSection
+{
+	/** 骨骼网格体上的布料资产索引 */
+	int32 ClothingAssetIndex = INDEX_NONE;
+
+	/** 布料所在的材质槽位，无法确定时为INDEX_NONE */
+	int32 MaterialID = INDEX_NONE;
+
+	/** 模拟空间到组件空间的变换 */
+	FTransform ComponentRelativeTransform;
+
+	/** 模拟空间的粒子位置 */
+	TArray<FVector3f> Positions;
+
+	/** 模拟空间的包围盒 */
+	FBox3f Bounds = FBox3f(ForceInit);
+
+	/** 空间哈希的单元大小 */
+	static constexpr float CellSize = 10.0f;
+
+	/** 各哈希桶在SortedParticles中的起点，长度为桶数加1 */
+	TArray<int32> BucketStarts;
+
+	/** 按哈希桶排列的粒子索引 */
+	TArray<int32> SortedParticles;
+
+	/** 按当前位置重建空间哈希，数组在多次重建之间复用 */
+	void BuildIndex();
+
+	/**
+	 * 遍历半径内的粒子
+	 * 只检查与球体相交的单元，相交的单元多于哈希桶时逐个检查所有粒子，只读取已有数据，可在工作线程调用
+	 * @param SimLocation 模拟空间位置
+	 * @param Radius 半径
+	 * @param Visitor 回调，参数为粒子索引和距离的平方
+	 */
+	void ForEachParticleInRadius(const FVector3f& SimLocation, float Radius, TFunctionRef<void(int32, float)> Visitor) const;
+};
+
+/**
+ * 所有布料资产当前的模拟位置
+ * 只在有冲击或正在撕裂的组件上按需读取，每帧最多读取一次，数组在多次读取之间复用。
+ * 读取时按位置建立空间哈希，半径查询只检查附近的粒子。
+ * 内容只在读取的当帧有效，不要跨帧保存指向其中数据的指针
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothSimSnapshot
+{
+	/** 读取时的帧号，0表示尚未读取 */
+	uint64 FrameNumber = 0;
+
+	/** 采集时的渲染LOD */
+	int32 LODIndex = INDEX_NONE;
+
+	/** 各布料资产的快照 */
+	TArray<FClothSimSnapshotSection> Sections;
+
+	/** 查找布料资产的快照，本帧没有模拟数据时返回空 */
+	const FClothSimSnapshotSection* FindSection(int32 ClothingAssetIndex) const;
+
+	/**
+	 * 查找距离最近的模拟粒子
+	 * @param ComponentLocation 组件空间位置
+	 * @param MaxDistance 最大距离
+	 * @param OutParticle 粒子索引
+	 * @return 粒子所在的快照，范围内没有粒子时返回空
+	 */
+	const FClothSimSnapshotSection* FindNearestParticle(const FVector3f& ComponentLocation, float MaxDistance, int32& OutParticle) const;
+
+	/**
+	 * 通过GetCurrentClothingData_GameThread读取骨骼网格体已取回的模拟位置，不等待布料模拟任务
+	 * 只能在游戏线程调用
+	 * @param SkeletalMeshComponent 骨骼网格体组件
+	 * @param RenderedLOD 当前渲染LOD，用于确定布料所在的材质槽位
+	 */
+	void Capture(const USkeletalMeshComponent& SkeletalMeshComponent, int32 RenderedLOD);
+
+	/** 释放读取的数据 */
+	void Reset();
+
+	/** 占用的内存 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** 更新布料资产到材质槽位的映射 */
+	void UpdateMaterialIDs(const USkeletalMeshComponent& SkeletalMeshComponent, int32 RenderedLOD);
+
+	/** 按布料资产索引的材质槽位 */
+	TArray<int32> AssetMaterialIDs;
+
+	/** AssetMaterialIDs对应的LOD */
+	int32 MaterialIDsLOD = INDEX_NONE;
+};
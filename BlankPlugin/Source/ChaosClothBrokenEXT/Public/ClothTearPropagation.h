@@ -0,0 +1,167 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FClothSimSnapshotSection;
+
+/**
+ * 布料物理网格的边图
+ * 只依赖布料资产，同一资产的所有实例共享一份
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothTearGraph
+{
+	/** 一条边 */
+	struct FEdge
+	{
+		int32 VertexA = INDEX_NONE;
+		int32 VertexB = INDEX_NONE;
+
+		/** 静止长度 */
+		float RestLength = 0.0f;
+	};
+
+	/** 所有边 */
+	TArray<FEdge> Edges;
+
+	/** 每个顶点的相邻边在VertexEdges中的起点，长度为顶点数+1 */
+	TArray<int32> VertexEdgeOffsets;
+
+	/** 按顶点排列的相邻边索引 */
+	TArray<int32> VertexEdges;
+
+	/** 边图占用的内存 */
+	SIZE_T GetAllocatedSize() const
+	{
+		return sizeof(*this) + Edges.GetAllocatedSize() + VertexEdgeOffsets.GetAllocatedSize() + VertexEdges.GetAllocatedSize();
+	}
+
+	/** 顶点数量 */
+	int32 GetNumVertices() const { return FMath::Max(VertexEdgeOffsets.Num() - 1, 0); }
+
+	/** 顶点的相邻边 */
+	TConstArrayView<int32> GetVertexEdges(int32 Vertex) const
+	{
+		return MakeArrayView(VertexEdges.GetData() + VertexEdgeOffsets[Vertex], VertexEdgeOffsets[Vertex + 1] - VertexEdgeOffsets[Vertex]);
+	}
+
+	/** 边的另一个顶点 */
+	int32 GetOtherVertex(int32 EdgeIndex, int32 Vertex) const
+	{
+		return Edges[EdgeIndex].VertexA == Vertex ? Edges[EdgeIndex].VertexB : Edges[EdgeIndex].VertexA;
+	}
+
+	/**
+	 * 从布料物理网格的拷贝构建边图，不访问UObject，可在工作线程调用
+	 * @param Vertices 物理网格的顶点
+	 * @param Indices 物理网格的三角形索引
+	 * @return 边图，物理网格为空时返回空
+	 */
+	static TSharedPtr<const FClothTearGraph> Build(TConstArrayView<FVector3f> Vertices, TConstArrayView<uint32> Indices);
+};
+
+/**
+ * 撕裂前沿上的一个顶点
+ */
+struct FClothTearFrontierVertex
+{
+	/** 物理网格顶点 */
+	int32 Vertex = INDEX_NONE;
+
+	/** 已检查但没有边断开的次数，达到上限后不再重试 */
+	int32 NumChecks = 0;
+};
+
+/**
+ * 一条正在扩展的撕裂
+ */
+struct FClothTear
+{
+	/** 撕裂前沿的顶点 */
+	TArray<FClothTearFrontierVertex, TInlineAllocator<16>> Frontier;
+
+	/** 该撕裂已断开的边数 */
+	int32 NumBrokenEdges = 0;
+
+	/** 起始破洞的材质ID */
+	int32 MaterialID = INDEX_NONE;
+
+	/** 组件上记录这条撕裂的破洞索引，第一条边断开时由游戏线程创建 */
+	int32 HoleIndex = INDEX_NONE;
+
+	/** 本次推进中新断开的边，由游戏线程合并到破洞记录后清空 */
+	TArray<int32, TInlineAllocator<8>> NewlyBrokenEdges;
+
+	/** 是否已结束，没有可以扩展的前沿或达到长度上限 */
+	bool bFinished = false;
+};
+
+/**
+ * 单个组件的撕裂状态
+ * 断开的边只属于本实例，边图在实例间共享
+ */
+struct CHAOSCLOTHBROKENEXT_API FClothTearState
+{
+	/** 布料资产在骨骼网格体布料资产列表中的索引，用于查找模拟数据 */
+	int32 ClothingAssetIndex = INDEX_NONE;
+
+	/** 边图对应的布料LOD，模拟切换到其他LOD后需要重新初始化 */
+	int32 LODIndex = INDEX_NONE;
+
+	/** 共享的边图 */
+	TSharedPtr<const FClothTearGraph> Graph;
+
+	/** 已断开的边 */
+	TBitArray<> BrokenEdges;
+
+	/** 正在扩展的撕裂，结束的撕裂在游戏线程取走新断开的边后移除 */
+	TArray<FClothTear> ActiveTears;
+
+	/** 初始化 */
+	void Initialize(TSharedPtr<const FClothTearGraph> InGraph, int32 InClothingAssetIndex, int32 InLODIndex = 0);
+
+	/** 撕裂状态占用的内存，不含共享的边图 */
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Bytes = sizeof(*this) + BrokenEdges.GetAllocatedSize() + ActiveTears.GetAllocatedSize();
+		for (const FClothTear& Tear : ActiveTears)
+		{
+			Bytes += Tear.Frontier.GetAllocatedSize() + Tear.NewlyBrokenEdges.GetAllocatedSize();
+		}
+		return Bytes;
+	}
+
+	/** 是否有正在扩展的撕裂 */
+	bool HasActiveTears() const { return ActiveTears.Num() > 0; }
+
+	/**
+	 * 移除已结束的撕裂
+	 * @return 移除的撕裂数量
+	 */
+	int32 RemoveFinishedTears();
+
+	/**
+	 * 在破洞处开始一条撕裂
+	 * 通过快照的空间哈希找出半径内的粒子，只访问它们的相邻边，开销与破洞大小有关而与布料大小无关。
+	 * 这些边立即断开，已由破洞本身覆盖，不计入新断开的边；半径外的端点成为撕裂前沿
+	 * @param SimData 本帧的模拟快照，粒子与边图的顶点一一对应
+	 * @param Center 模拟空间中的破洞中心
+	 * @param Radius 破洞半径
+	 * @param MaterialID 破洞的材质ID
+	 * @return 是否开始了一条新的撕裂
+	 */
+	bool StartTear(const FClothSimSnapshotSection& SimData, const FVector3f& Center, float Radius, int32 MaterialID);
+
+	/**
+	 * 推进所有撕裂
+	 * 每条撕裂最多处理MaxStepsPerTear个前沿顶点，应变超过阈值的边断开并推进前沿，记录在撕裂的NewlyBrokenEdges中。
+	 * 没有边断开的前沿顶点移到前沿末尾，之后布料被拉伸时仍可继续撕裂，检查次数有上限
+	 * 只修改本实例的数据，不同组件可以并行调用
+	 * @param Positions 模拟空间中的粒子位置
+	 * @param StrainThreshold 应变阈值，(当前长度 - 静止长度) / 静止长度
+	 * @param MaxStepsPerTear 每条撕裂每次推进的最大步数
+	 * @param MaxTearLength 每条撕裂最多断开的边数
+	 */
+	void AdvanceTears(TConstArrayView<FVector3f> Positions, float StrainThreshold, int32 MaxStepsPerTear, int32 MaxTearLength);
+};